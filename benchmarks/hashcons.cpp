@@ -0,0 +1,116 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../include/ConcurrentDag.hpp"
+
+
+// Chains of additions over a few leaves, the threads build overlapping parts of them.
+// Both tables get the same leaves first and the chains refer to the indices they
+// returned, so the two tables store the same records and do the same work.
+using Record = Math::Dag<double>::Record;
+
+struct RecordHash
+{
+    std::size_t operator()(const Record& record) const
+    {
+        return (static_cast<std::size_t>(record.type) * 0x9E3779B97F4A7C15ull ^ record.left) * 0x9E3779B97F4A7C15ull ^ record.right;
+    }
+};
+
+
+class LockedTable
+{
+public:
+    std::uint32_t insert(const Record& record)
+    {
+        std::lock_guard lock(this->mutex);
+        return this->index.emplace(record, static_cast<std::uint32_t>(this->index.size())).first->second;
+    }
+
+private:
+    std::mutex mutex;
+    std::unordered_map<Record, std::uint32_t, RecordHash> index;
+};
+
+
+class LockFreeTable
+{
+public:
+    explicit LockFreeTable(std::size_t capacity) : dag(capacity) {}
+
+    std::uint32_t insert(const Record& record)
+    {
+        return this->dag.binary(record.type, record.left, record.right);
+    }
+
+private:
+    Math::ConcurrentDag<double> dag;
+};
+
+
+constexpr std::uint32_t leaves = 64;
+constexpr std::uint32_t levels = 12;
+constexpr std::size_t operations = 1 << 21;
+
+
+template<typename Table>
+void work(Table& table, const std::vector<std::uint32_t>& leaf, std::size_t thread, std::size_t threads)
+{
+    // Each thread walks the same chains from different leaves, so most inserts find an existing record.
+    // A thread takes a contiguous block of chains, so its working set does not depend on the thread count.
+    const std::size_t chains = operations / levels;
+    for(std::size_t k = chains * thread / threads; k < chains * (thread + 1) / threads; k++)
+    {
+        std::uint32_t current = leaf[k % leaves];
+        for(std::uint32_t level = 0; level < levels; level++)
+        {
+            const std::uint32_t other = leaf[(k / leaves + level) % leaves];
+            current = table.insert({Math::TypeNode::Addition, current, other});
+        }
+    }
+}
+
+
+template<typename Table, typename... Arguments>
+double measure(std::size_t threads, Arguments... arguments)
+{
+    Table table(arguments...);
+    std::vector<std::uint32_t> leaf;
+    for(std::uint32_t i = 0; i < leaves; i++)
+    {
+        leaf.push_back(table.insert({Math::TypeNode::Variable, i, 0}));
+    }
+
+    std::vector<std::thread> pool;
+    auto start = std::chrono::steady_clock::now();
+    for(std::size_t t = 0; t < threads; t++)
+    {
+        pool.emplace_back([&table, &leaf, t, threads]() { work(table, leaf, t, threads); });
+    }
+    for(std::thread& thread : pool)
+    {
+        thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(operations) / elapsed.count() / 1e6;
+}
+
+
+int main()
+{
+    // Beyond the number of cores the threads only take turns, the figures say nothing about scaling
+    std::cout << "Cores: " << std::thread::hardware_concurrency() << "\n";
+    std::cout << std::left << std::setw(10) << "Threads" << std::setw(16) << "Mutex Mops/s" << "Lock-free Mops/s\n";
+    for(std::size_t threads = 1; threads <= 32; threads *= 2)
+    {
+        const double locked = measure<LockedTable>(threads);
+        const double lockFree = measure<LockFreeTable>(threads, std::size_t(1) << 22);
+        std::cout << std::left << std::setw(10) << threads << std::setw(16) << std::fixed << std::setprecision(2)
+            << locked << lockFree << "\n";
+    }
+}
@@ -0,0 +1,70 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "../include/Expression.hpp"
+#include "../include/SimplifyCache.hpp"
+
+
+using exd = Math::Expression<double>;
+
+constexpr int terms = 3000;
+constexpr int passes = 5;
+
+
+// Sum of terms too small for the cache, it should cost the same with and without it
+exd small()
+{
+    std::string text = "0";
+    for(int i = 1; i <= terms; i++)
+    {
+        text += " + sin(x" + std::to_string(i % 100) + " * " + std::to_string(i) + ") * exp(y" + std::to_string(i % 7) + ")";
+    }
+    return exd(text);
+}
+
+
+// Sum of larger terms that repeat, as the derivatives of a model share whole factors
+exd repeated()
+{
+    std::string text = "0";
+    for(int i = 1; i <= terms; i++)
+    {
+        const std::string x = "x" + std::to_string(i % 50);
+        const std::string y = "y" + std::to_string(i % 3);
+        text += " + (sin(" + x + " * 1 + 0) * cos(" + y + "^1) + exp(0 + " + x + ") * ln(1 * " + y + ")) / (1 + " + x + "^2 * 1)";
+    }
+    return exd(text);
+}
+
+
+double measure(const exd& expression, bool cached)
+{
+    auto& cache = Math::SimplifyCache<double>::global();
+    cache.clear();
+    cached ? cache.enable() : cache.disable();
+
+    auto start = std::chrono::steady_clock::now();
+    for(int k = 0; k < passes; k++)
+    {
+        exd result = expression.simplify();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+
+int main()
+{
+    std::cout << std::left << std::setw(12) << "Terms" << std::setw(16) << "Uncached ms" << std::setw(16) << "Cached ms" << "Hit rate\n";
+    for(auto [name, expression] : {std::pair{"small", small()}, std::pair{"repeated", repeated()}})
+    {
+        const double uncached = measure(expression, false);
+        const double cached = measure(expression, true);
+        const double hitRate = Math::SimplifyCache<double>::global().getStatistics().hitRate();
+        std::cout << std::left << std::setw(12) << name << std::setw(16) << std::fixed << std::setprecision(1)
+            << uncached << std::setw(16) << cached << std::setprecision(2) << hitRate << "\n";
+    }
+    Math::SimplifyCache<double>::global().disable();
+}
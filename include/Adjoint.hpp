@@ -0,0 +1,93 @@
+#ifndef ADJOINT_HPP
+#define ADJOINT_HPP
+
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Dag.hpp"
+#include "Evaluator.hpp"
+
+
+namespace Math
+{
+    // Reverse-mode automatic differentiation. The forward pass keeps the value
+    // of every instruction, the backward pass propagates adjoints from the
+    // output to the variables, so all partials cost one sweep over the program.
+    template<typename Type>
+    class Adjoint
+    {
+    public:
+        Adjoint(const Dag<Type>& dag, std::uint32_t output);
+
+        [[nodiscard]] const std::vector<std::string>& getVariables() const;
+
+        // The value followed by the partial derivative by every given variable
+        std::vector<Type> calculate(const std::vector<std::string>& variable, const std::vector<Type>& value) const;
+
+        // The value followed by the partial derivative by every variable slot
+        std::vector<Type> calculate(const std::vector<Type>& value) const;
+
+    private:
+        Evaluator<Type> evaluator;
+    };
+} // Math
+
+
+
+// Implementation
+namespace Math
+{
+    template<typename Type>
+    Adjoint<Type>::Adjoint(const Dag<Type>& dag, std::uint32_t output)
+        : evaluator(dag, {output})
+    {
+    }
+
+
+    template<typename Type>
+    const std::vector<std::string>& Adjoint<Type>::getVariables() const
+    {
+        return this->evaluator.getVariables();
+    }
+
+
+    template<typename Type>
+    std::vector<Type> Adjoint<Type>::calculate(const std::vector<std::string>& variable, const std::vector<Type>& value) const
+    {
+        std::vector<Type> gradient = this->calculate(this->evaluator.getSlots(variable, value));
+
+        const auto& variables = this->evaluator.getVariables();
+        std::vector<Type> result {gradient.front()};
+        for(const std::string& name : variable)
+        {
+            auto iter = std::find(variables.begin(), variables.end(), name);
+            result.push_back(iter == variables.end() ? Type{} : gradient[iter - variables.begin() + 1]);
+        }
+        return result;
+    }
+
+
+    template<typename Type>
+    std::vector<Type> Adjoint<Type>::calculate(const std::vector<Type>& value) const
+    {
+        std::vector<Type> tape = this->evaluator.forward(value);
+        std::vector<Type> adjoint(tape.size());
+
+        std::uint32_t output = this->evaluator.getOutputs().front();
+        adjoint[output] = getNumber<Type>(1.0);
+
+        std::vector<Type> result {tape[output]};
+        std::vector<Type> partial = this->evaluator.backward(tape, std::move(adjoint));
+        result.insert(result.end(), partial.begin(), partial.end());
+        return result;
+    }
+} // Math
+
+
+#endif // ADJOINT_HPP
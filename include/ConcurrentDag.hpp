@@ -0,0 +1,402 @@
+#ifndef CONCURRENT_DAG_HPP
+#define CONCURRENT_DAG_HPP
+
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Dag.hpp"
+#include "Tape.hpp"
+#include "VariableSet.hpp"
+#include "Nodes/Node.hpp"
+#include "Nodes/Number.hpp"
+#include "Nodes/Variable.hpp"
+
+
+namespace Math
+{
+    // Set of keys numbered by insertion, with open addressing and linear probing.
+    // A slot holds 0 or index + 1 and only ever changes from 0, so a lookup is a
+    // sequence of atomic loads and two threads inserting into one slot race by CAS.
+    // The loser returns the winner's index, the key it stored first stays unused.
+    template<typename Key, typename Hash, typename Equal>
+    class ConcurrentTable
+    {
+    public:
+        explicit ConcurrentTable(std::size_t capacity);
+
+        // Index of the key, inserted if absent
+        std::uint32_t insert(const Key& key);
+
+        const Key& operator[](std::uint32_t index) const;
+
+        // Keys stored so far, including unused ones
+        [[nodiscard]] std::size_t size() const;
+
+    private:
+        static constexpr std::uint32_t none = static_cast<std::uint32_t>(-1);
+
+        std::size_t capacity;
+        std::size_t mask;
+        std::unique_ptr<Key[]> keys;
+        std::unique_ptr<std::atomic<std::uint32_t>[]> slots;
+        std::atomic<std::uint32_t> count = 0;
+    };
+
+
+    // Hash-consed expression graph that many threads can extend at once. The same
+    // subexpression added by two threads gets one index. Records use the layout of Dag,
+    // a record's operands have smaller indices.
+    template<typename Type>
+    class ConcurrentDag
+    {
+    public:
+        using Record = typename Dag<Type>::Record;
+
+        // The tables do not grow, capacity bounds the records and the constants
+        explicit ConcurrentDag(std::size_t capacity);
+
+        std::uint32_t add(const std::unique_ptr<Node<Type>>& node, bool commutative = false);
+
+        std::uint32_t number(const Type& value);
+        std::uint32_t variable(const std::string& name);
+        std::uint32_t unary(TypeNode type, std::uint32_t argument);
+        std::uint32_t binary(TypeNode type, std::uint32_t left, std::uint32_t right);
+
+        [[nodiscard]] const Record& getRecord(std::uint32_t index) const;
+        [[nodiscard]] const Type& getConstant(const Record& record) const;
+
+        // The records reachable from index, shared ones stay shared
+        [[nodiscard]] Tape<Type> toTape(std::uint32_t index) const;
+        [[nodiscard]] std::unique_ptr<Node<Type>> toNode(std::uint32_t index) const;
+
+        [[nodiscard]] std::size_t size() const;
+
+    private:
+        struct RecordHash
+        {
+            std::size_t operator()(const Record& record) const;
+        };
+
+        // Numbers are told apart by their bytes, like the constant pool of Dag
+        struct ValueHash
+        {
+            std::size_t operator()(const Type& value) const;
+        };
+
+        struct ValueEqual
+        {
+            bool operator()(const Type& first, const Type& second) const;
+        };
+
+        static std::size_t arity(TypeNode type);
+
+        ConcurrentTable<Record, RecordHash, std::equal_to<Record>> records;
+        ConcurrentTable<Type, ValueHash, ValueEqual> constants;
+    };
+} // Math
+
+
+
+// Implementation
+namespace Math
+{
+    template<typename Key, typename Hash, typename Equal>
+    ConcurrentTable<Key, Hash, Equal>::ConcurrentTable(std::size_t capacity)
+        : capacity(std::max<std::size_t>(capacity, 1)),
+          mask(std::bit_ceil(2 * this->capacity) - 1),
+          keys(std::make_unique<Key[]>(this->capacity)),
+          slots(std::make_unique<std::atomic<std::uint32_t>[]>(this->mask + 1))
+    {
+        if(this->capacity >= none)
+        {
+            throw std::length_error("The capacity of the table is too large");
+        }
+        for(std::size_t i = 0; i <= this->mask; i++)
+        {
+            this->slots[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+
+    template<typename Key, typename Hash, typename Equal>
+    std::uint32_t ConcurrentTable<Key, Hash, Equal>::insert(const Key& key)
+    {
+        const std::size_t hash = Hash{}(key);
+        std::uint32_t own = none;
+        for(std::size_t probe = 0; probe <= this->mask; probe++)
+        {
+            std::atomic<std::uint32_t>& slot = this->slots[(hash + probe) & this->mask];
+            std::uint32_t current = slot.load(std::memory_order_acquire);
+            if(current == 0)
+            {
+                if(own == none)
+                {
+                    own = this->count.fetch_add(1, std::memory_order_relaxed);
+                    if(own >= this->capacity)
+                    {
+                        throw std::length_error("The table is full");
+                    }
+                    this->keys[own] = key;
+                }
+                // Release publishes the key together with the slot
+                if(slot.compare_exchange_strong(current, own + 1, std::memory_order_release, std::memory_order_acquire))
+                {
+                    return own;
+                }
+            }
+            if(Equal{}(this->keys[current - 1], key))
+            {
+                return current - 1;
+            }
+        }
+        throw std::length_error("The table is full");
+    }
+
+
+    template<typename Key, typename Hash, typename Equal>
+    const Key& ConcurrentTable<Key, Hash, Equal>::operator[](std::uint32_t index) const
+    {
+        return this->keys[index];
+    }
+
+
+    template<typename Key, typename Hash, typename Equal>
+    std::size_t ConcurrentTable<Key, Hash, Equal>::size() const
+    {
+        return std::min<std::size_t>(this->count.load(std::memory_order_relaxed), this->capacity);
+    }
+
+
+    template<typename Type>
+    std::size_t ConcurrentDag<Type>::RecordHash::operator()(const Record& record) const
+    {
+        std::uint64_t hash = static_cast<std::uint64_t>(record.type);
+        hash = hash * 0x9E3779B97F4A7C15ull ^ record.left;
+        hash = hash * 0x9E3779B97F4A7C15ull ^ record.right;
+        // The table probes by the low bits, mix the high ones in
+        return static_cast<std::size_t>(hash ^ (hash >> 29));
+    }
+
+
+    template<typename Type>
+    std::size_t ConcurrentDag<Type>::ValueHash::operator()(const Type& value) const
+    {
+        return std::hash<std::string_view>{}(std::string_view(reinterpret_cast<const char*>(&value), sizeof(Type)));
+    }
+
+
+    template<typename Type>
+    bool ConcurrentDag<Type>::ValueEqual::operator()(const Type& first, const Type& second) const
+    {
+        return std::memcmp(&first, &second, sizeof(Type)) == 0;
+    }
+
+
+    template<typename Type>
+    ConcurrentDag<Type>::ConcurrentDag(std::size_t capacity)
+        : records(capacity), constants(capacity)
+    {
+    }
+
+
+    template<typename Type>
+    std::uint32_t ConcurrentDag<Type>::add(const std::unique_ptr<Node<Type>>& node, bool commutative)
+    {
+        // Post-order with an explicit stack, as Dag::add
+        std::vector<std::pair<const Node<Type>*, std::size_t>> stack {{node.get(), 0}};
+        std::vector<std::uint32_t> operands;
+        while(true)
+        {
+            auto& [current, next] = stack.back();
+            if(next < current->countChildren())
+            {
+                const Node<Type>* child = current->getChild(next++).get();
+                stack.emplace_back(child, 0);
+                continue;
+            }
+
+            const TypeNode type = current->getType();
+            std::uint32_t index {};
+            switch(arity(type))
+            {
+                case 0:
+                    index = type == TypeNode::Number
+                        ? this->number(static_cast<const Number<Type>*>(current)->value)
+                        : this->records.insert({TypeNode::Variable, static_cast<std::uint32_t>(static_cast<const Variable<Type>*>(current)->id), 0});
+                    break;
+                case 1:
+                    index = this->unary(type, operands.back());
+                    operands.pop_back();
+                    break;
+                default:
+                {
+                    std::uint32_t left = operands[operands.size() - 2];
+                    std::uint32_t right = operands.back();
+                    operands.resize(operands.size() - 2);
+                    if(commutative && right < left && (type == TypeNode::Addition || type == TypeNode::Multiplication))
+                    {
+                        std::swap(left, right);
+                    }
+                    index = this->binary(type, left, right);
+                }
+            }
+
+            stack.pop_back();
+            if(stack.empty())
+            {
+                return index;
+            }
+            operands.push_back(index);
+        }
+    }
+
+
+    template<typename Type>
+    std::uint32_t ConcurrentDag<Type>::number(const Type& value)
+    {
+        return this->records.insert({TypeNode::Number, this->constants.insert(value), 0});
+    }
+
+
+    template<typename Type>
+    std::uint32_t ConcurrentDag<Type>::variable(const std::string& name)
+    {
+        return this->records.insert({TypeNode::Variable, static_cast<std::uint32_t>(internVariable(name)), 0});
+    }
+
+
+    template<typename Type>
+    std::uint32_t ConcurrentDag<Type>::unary(TypeNode type, std::uint32_t argument)
+    {
+        return this->records.insert({type, argument, 0});
+    }
+
+
+    template<typename Type>
+    std::uint32_t ConcurrentDag<Type>::binary(TypeNode type, std::uint32_t left, std::uint32_t right)
+    {
+        return this->records.insert({type, left, right});
+    }
+
+
+    template<typename Type>
+    const typename ConcurrentDag<Type>::Record& ConcurrentDag<Type>::getRecord(std::uint32_t index) const
+    {
+        return this->records[index];
+    }
+
+
+    template<typename Type>
+    const Type& ConcurrentDag<Type>::getConstant(const Record& record) const
+    {
+        return this->constants[record.left];
+    }
+
+
+    template<typename Type>
+    Tape<Type> ConcurrentDag<Type>::toTape(std::uint32_t index) const
+    {
+        // Reachable records in increasing order keep the operands first
+        std::vector<std::uint32_t> reachable {index};
+        std::unordered_map<std::uint32_t, std::uint32_t> position {{index, 0}};
+        for(std::size_t k = 0; k < reachable.size(); k++)
+        {
+            const Record& record = this->records[reachable[k]];
+            const std::uint32_t operands[] {record.left, record.right};
+            for(std::size_t i = 0; i < arity(record.type); i++)
+            {
+                if(position.emplace(operands[i], 0).second)
+                {
+                    reachable.push_back(operands[i]);
+                }
+            }
+        }
+        std::sort(reachable.begin(), reachable.end());
+
+        std::vector<typename Tape<Type>::Record> records;
+        std::vector<Type> constants;
+        std::vector<std::string> variables;
+        std::unordered_map<std::uint32_t, std::uint32_t> slots;
+        for(const std::uint32_t i : reachable)
+        {
+            Record record = this->records[i];
+            switch(arity(record.type))
+            {
+                case 0:
+                    if(record.type == TypeNode::Number)
+                    {
+                        constants.push_back(this->constants[record.left]);
+                        record.left = static_cast<std::uint32_t>(constants.size() - 1);
+                    }
+                    else
+                    {
+                        auto [iter, inserted] = slots.emplace(record.left, static_cast<std::uint32_t>(variables.size()));
+                        if(inserted)
+                        {
+                            variables.push_back(variableName(record.left));
+                        }
+                        record.left = iter->second;
+                    }
+                    break;
+                case 1:
+                    record.left = position[record.left];
+                    break;
+                default:
+                    record.left = position[record.left];
+                    record.right = position[record.right];
+            }
+            position[i] = static_cast<std::uint32_t>(records.size());
+            records.push_back({record.type, record.left, record.right});
+        }
+        return Tape<Type>(std::move(records), std::move(constants), std::move(variables));
+    }
+
+
+    template<typename Type>
+    std::unique_ptr<Node<Type>> ConcurrentDag<Type>::toNode(std::uint32_t index) const
+    {
+        return this->toTape(index).toNode();
+    }
+
+
+    template<typename Type>
+    std::size_t ConcurrentDag<Type>::size() const
+    {
+        return this->records.size();
+    }
+
+
+    template<typename Type>
+    std::size_t ConcurrentDag<Type>::arity(TypeNode type)
+    {
+        switch(type)
+        {
+            case TypeNode::Number:
+            case TypeNode::Variable:
+                return 0;
+            case TypeNode::Minus:
+            case TypeNode::Sin:
+            case TypeNode::Cos:
+            case TypeNode::Exp:
+            case TypeNode::Ln:
+                return 1;
+            default:
+                return 2;
+        }
+    }
+} // Math
+
+
+#endif // CONCURRENT_DAG_HPP
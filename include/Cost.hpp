@@ -0,0 +1,41 @@
+#ifndef COST_HPP
+#define COST_HPP
+
+
+#include <complex>
+
+
+namespace Math
+{
+    // Rough cost of one operation in additions, used to decide whether
+    // a rewrite of an evaluation plan pays off for the given Type
+    template<typename Type>
+    struct Cost
+    {
+        static constexpr double add = 1;
+        static constexpr double multiply = 1;
+        static constexpr double divide = 4;
+        static constexpr double power = 40;
+        static constexpr double exp = 20;
+        static constexpr double log = 20;
+        static constexpr double sin = 20;
+        static constexpr double cos = 20;
+    };
+
+
+    template<typename Type>
+    struct Cost<std::complex<Type>>
+    {
+        static constexpr double add = 2;
+        static constexpr double multiply = 6;
+        static constexpr double divide = 30;
+        static constexpr double power = 200;
+        static constexpr double exp = 60;
+        static constexpr double log = 60;
+        static constexpr double sin = 80;
+        static constexpr double cos = 80;
+    };
+} // Math
+
+
+#endif // COST_HPP
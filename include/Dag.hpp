@@ -0,0 +1,1169 @@
+#ifndef DAG_HPP
+#define DAG_HPP
+
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Cost.hpp"
+#include "Tape.hpp"
+#include "VariableSet.hpp"
+#include "Nodes/Node.hpp"
+#include "Nodes/Number.hpp"
+#include "Nodes/Variable.hpp"
+#include "Nodes/Minus.hpp"
+#include "Nodes/Addition.hpp"
+#include "Nodes/Subtraction.hpp"
+#include "Nodes/Sin.hpp"
+#include "Nodes/Cos.hpp"
+#include "Nodes/Exp.hpp"
+#include "Nodes/Ln.hpp"
+#include "Nodes/Multiplication.hpp"
+#include "Nodes/Division.hpp"
+#include "Nodes/Power.hpp"
+
+
+namespace Math
+{
+    // Hash-consed expression graph. Every distinct subexpression is stored once,
+    // children always precede their parents, so the records are in post-order.
+    template<typename Type>
+    class Dag
+    {
+    public:
+        // Number: left is an index into the constant pool
+        // Variable: left is the interned variable id
+        // Unary nodes: left is the argument
+        struct Record
+        {
+            TypeNode type;
+            std::uint32_t left;
+            std::uint32_t right;
+
+            bool operator==(const Record& other) const = default;
+        };
+
+        Dag() = default;
+
+        // With commutative set, the operands of + and * are ordered by index,
+        // so x * y and y * x share one record
+        std::uint32_t add(const std::unique_ptr<Node<Type>>& node, bool commutative = false);
+
+        std::uint32_t differentiate(std::uint32_t index, const std::string& variable);
+        std::uint32_t differentiate(std::uint32_t index, const std::string& variable, int number);
+
+        // Binds variables to numbers and folds every subexpression that becomes constant.
+        // Records not depending on the bindings are returned unchanged.
+        std::uint32_t specialize(std::uint32_t index, const std::map<std::string, Type>& bindings);
+
+        // Rewrites polynomials in one variable (sums of constant multiples of natural
+        // powers) into Horner form, so they are evaluated by multiplications and additions
+        std::uint32_t horner(std::uint32_t index);
+
+        // Strength reduction guarded by Cost<Type>: small integer powers become
+        // multiplications, division by a constant a multiplication by its reciprocal,
+        // exp(a) * exp(b) becomes exp(a + b) and a * x + b * x becomes (a + b) * x.
+        // An operand with other users stays, its cost counts only when it is the only one.
+        std::uint32_t reduce(std::uint32_t index);
+
+        // Evaluation plan for the compilers, the result is not meant to be printed
+        std::uint32_t optimize(std::uint32_t index);
+
+        [[nodiscard]] std::unique_ptr<Node<Type>> toNode(std::uint32_t index) const;
+
+        // The records reachable from index, shared ones stay shared
+        [[nodiscard]] Tape<Type> toTape(std::uint32_t index) const;
+
+        [[nodiscard]] std::size_t size() const;
+
+        [[nodiscard]] const Record& getRecord(std::uint32_t index) const;
+        [[nodiscard]] const Type& getConstant(const Record& record) const;
+        [[nodiscard]] const std::string& getVariable(const Record& record) const;
+        [[nodiscard]] VariableSet getVariables(std::uint32_t index) const;
+
+    private:
+        struct RecordHash
+        {
+            std::size_t operator()(const Record& record) const;
+        };
+
+        std::uint32_t insert(const Record& record);
+
+        std::uint32_t number(Type value);
+        std::uint32_t variable(const std::string& name);
+        std::uint32_t unary(TypeNode type, std::uint32_t argument);
+        std::uint32_t binary(TypeNode type, std::uint32_t left, std::uint32_t right);
+
+        bool isNumber(std::uint32_t index, double value) const;
+
+        static std::size_t arity(TypeNode type);
+
+        // Records reachable from index in increasing order, so operands come before their users.
+        // The memoized passes below run over it bottom-up and their recursion stays shallow.
+        std::vector<std::uint32_t> reachable(std::uint32_t index) const;
+
+        // variable is the interned id, so the global table is not locked once per record
+        std::uint32_t derive(std::uint32_t index, std::uint32_t variable);
+
+        std::uint32_t fold(TypeNode type, std::uint32_t left, std::uint32_t right);
+
+        // Coefficients by degree, variable is a record index or noRecord for a constant
+        struct Polynomial
+        {
+            std::uint32_t variable;
+            std::map<std::uint64_t, Type> terms;
+        };
+
+        static constexpr std::uint32_t noRecord = static_cast<std::uint32_t>(-1);
+
+        std::optional<Polynomial> polynomial(std::uint32_t index, std::unordered_map<std::uint32_t, std::optional<Polynomial>>& memory) const;
+        std::uint32_t horner(std::uint32_t index, std::unordered_map<std::uint32_t, std::optional<Polynomial>>& polynomials,
+            std::unordered_map<std::uint32_t, std::uint32_t>& memory);
+        std::uint32_t power(std::uint32_t base, std::uint64_t exponent);
+
+        std::uint32_t reduce(std::uint32_t index, const std::vector<std::uint32_t>& uses,
+            std::unordered_map<std::uint32_t, std::uint32_t>& memory);
+
+        std::uint32_t specialize(std::uint32_t index, const VariableSet& bound,
+            const std::unordered_map<std::size_t, Type>& values, std::unordered_map<std::uint32_t, std::uint32_t>& memory);
+
+        std::vector<Record> records;
+        std::vector<Type> constants;
+        // Bit id % 64 of the variables of every record, the exact sets are collected on demand
+        std::vector<std::uint64_t> summaries;
+
+        std::unordered_map<Record, std::uint32_t, RecordHash> unique;
+        std::unordered_map<std::string, std::uint32_t> constantIndex;
+        std::unordered_map<std::uint64_t, std::uint32_t> derivatives;
+    };
+} // Math
+
+
+
+// Implementation
+namespace Math
+{
+    template<typename Type>
+    std::size_t Dag<Type>::RecordHash::operator()(const Record& record) const
+    {
+        std::uint64_t hash = static_cast<std::uint64_t>(record.type);
+        hash = hash * 0x9E3779B97F4A7C15ull ^ record.left;
+        hash = hash * 0x9E3779B97F4A7C15ull ^ record.right;
+        return std::hash<std::uint64_t>{}(hash);
+    }
+
+
+    template<typename Type>
+    std::uint32_t Dag<Type>::insert(const Record& record)
+    {
+        auto iter = this->unique.find(record);
+        if(iter != this->unique.end())
+        {
+            return iter->second;
+        }
+        auto index = static_cast<std::uint32_t>(this->records.size());
+        this->records.push_back(record);
+        this->unique.emplace(record, index);
+
+        std::uint64_t summary = 0;
+        switch(record.type)
+        {
+            case TypeNode::Number:
+                break;
+            case TypeNode::Variable:
+                summary = VariableSet::bit(record.left);
+                break;
+            case TypeNode::Minus:
+            case TypeNode::Sin:
+            case TypeNode::Cos:
+            case TypeNode::Exp:
+            case TypeNode::Ln:
+                summary = this->summaries[record.left];
+                break;
+            default:
+                summary = this->summaries[record.left] | this->summaries[record.right];
+        }
+        this->summaries.push_back(summary);
+        return index;
+    }
+
+
+    template<typename Type>
+    std::uint32_t Dag<Type>::number(Type value)
+    {
+        std::string key(reinterpret_cast<const char*>(&value), sizeof(Type));
+        auto iter = this->constantIndex.find(key);
+        if(iter == this->constantIndex.end())
+        {
+            iter = this->constantIndex.emplace(key, static_cast<std::uint32_t>(this->constants.size())).first;
+            this->constants.push_back(value);
+        }
+        return this->insert({TypeNode::Number, iter->second, 0});
+    }
+
+
+    template<typename Type>
+    std::uint32_t Dag<Type>::variable(const std::string& name)
+    {
+        return this->insert({TypeNode::Variable, static_cast<std::uint32_t>(internVariable(name)), 0});
+    }
+
+
+    template<typename Type>
+    std::uint32_t Dag<Type>::unary(TypeNode type, std::uint32_t argument)
+    {
+        // -(-x) = x
+        if(type == TypeNode::Minus && this->records[argument].type == TypeNode::Minus)
+        {
+            return this->records[argument].left;
+        }
+        return this->insert({type, argument, 0});
+    }
+
+
+    template<typename Type>
+    std::uint32_t Dag<Type>::binary(TypeNode type, std::uint32_t left, std::uint32_t right)
+    {
+        switch(type)
+        {
+            case TypeNode::Addition:
+                // 0 + x = x
+                if(this->isNumber(left, 0.0))
+                {
+                    return right;
+                }
+                // x + 0 = x
+                if(this->isNumber(right, 0.0))
+                {
+                    return left;
+                }
+                break;
+            case TypeNode::Subtraction:
+                // x - 0 = x
+                if(this->isNumber(right, 0.0))
+                {
+                    return left;
+                }
+                // 0 - x = -x
+                if(this->isNumber(left, 0.0))
+                {
+                    return this->unary(TypeNode::Minus, right);
+                }
+                break;
+            case TypeNode::Multiplication:
+                // 0 * x = x * 0 = 0
+                if(this->isNumber(left, 0.0) || this->isNumber(right, 0.0))
+                {
+                    return this->number(Type{});
+                }
+                // 1 * x = x
+                if(this->isNumber(left, 1.0))
+                {
+                    return right;
+                }
+                // x * 1 = x
+                if(this->isNumber(right, 1.0))
+                {
+                    return left;
+                }
+                break;
+            case TypeNode::Division:
+                // 0 / x = 0
+                if(this->isNumber(left, 0.0))
+                {
+                    return left;
+                }
+                // x / 1 = x
+                if(this->isNumber(right, 1.0))
+                {
+                    return left;
+                }
+                break;
+            default: ;
+        }
+        return this->insert({type, left, right});
+    }
+
+
+    template<typename Type>
+    bool Dag<Type>::isNumber(std::uint32_t index, double value) const
+    {
+        const Record& record = this->records[index];
+        return record.type == TypeNode::Number && this->constants[record.left] == getNumber<Type>(value);
+    }
+
+
+    template<typename Type>
+    std::size_t Dag<Type>::arity(TypeNode type)
+    {
+        switch(type)
+        {
+            case TypeNode::Number:
+            case TypeNode::Variable:
+                return 0;
+            case TypeNode::Minus:
+            case TypeNode::Sin:
+            case TypeNode::Cos:
+            case TypeNode::Exp:
+            case TypeNode::Ln:
+                return 1;
+            default:
+                return 2;
+        }
+    }
+
+
+    template<typename Type>
+    std::vector<std::uint32_t> Dag<Type>::reachable(std::uint32_t index) const
+    {
+        std::vector<bool> seen(index + 1, false);
+        std::vector<std::uint32_t> stack {index};
+        std::vector<std::uint32_t> result;
+        seen[index] = true;
+        while(!stack.empty())
+        {
+            const std::uint32_t current = stack.back();
+            stack.pop_back();
+            result.push_back(current);
+
+            const Record& record = this->records[current];
+            const std::uint32_t operands[] {record.left, record.right};
+            for(std::size_t i = 0; i < arity(record.type); i++)
+            {
+                if(!seen[operands[i]])
+                {
+                    seen[operands[i]] = true;
+                    stack.push_back(operands[i]);
+                }
+            }
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+
+    template<typename Type>
+    std::uint32_t Dag<Type>::add(const std::unique_ptr<Node<Type>>& node, bool commutative)
+    {
+        // Post-order with an explicit stack, a node is added after its operands
+        std::vector<std::pair<Node<Type>*, std::size_t>> stack {{node.get(), 0}};
+        std::vector<std::uint32_t> operands;
+        while(true)
+        {
+            auto& [current, next] = stack.back();
+            if(next < current->countChildren())
+            {
+                Node<Type>* child = current->getChild(next++).get();
+                stack.emplace_back(child, 0);
+                continue;
+            }
+
+            const TypeNode type = current->getType();
+            std::uint32_t index {};
+            switch(arity(type))
+            {
+                case 0:
+                    index = type == TypeNode::Number
+                        ? this->number(static_cast<Number<Type>*>(current)->value)
+                        : this->variable(static_cast<Variable<Type>*>(current)->name);
+                    break;
+                case 1:
+                    index = this->insert({type, operands.back(), 0});
+                    operands.pop_back();
+                    break;
+                default:
+                {
+                    std::uint32_t left = operands[operands.size() - 2];
+                    std::uint32_t right = operands.back();
+                    operands.resize(operands.size() - 2);
+                    if(commutative && right < left && (type == TypeNode::Addition || type == TypeNode::Multiplication))
+                    {
+                        std::swap(left, right);
+                    }
+                    index = this->insert({type, left, right});
+                }
+            }
+
+            stack.pop_back();
+            if(stack.empty())
+            {
+                return index;
+            }
+            operands.push_back(index);
+        }
+    }
+
+
+    template<typename Type>
+    std::uint32_t Dag<Type>::differentiate(std::uint32_t index, const std::string& variable)
+    {
+        const auto variableId = static_cast<std::uint32_t>(internVariable(variable));
+        std::uint32_t derivative {};
+        for(const std::uint32_t i : this->reachable(index))
+        {
+            derivative = this->derive(i, variableId);
+        }
+        return derivative;
+    }
+
+
+    template<typename Type>
+    std::uint32_t Dag<Type>::derive(std::uint32_t index, std::uint32_t variable)
+    {
+        std::uint64_t key = static_cast<std::uint64_t>(index) << 32 | variable;
+        auto iter = this->derivatives.find(key);
+        if(iter != this->derivatives.end())
+        {
+            return iter->second;
+        }
+
+        Record record = this->records[index];
+        std::uint32_t derivative {};
+
+        // c' = 0, a set bit may still stand for another variable
+        const std::uint32_t zero = this->number(Type{});
+        if(!(this->summaries[index] & VariableSet::bit(variable)))
+        {
+            this->derivatives.emplace(key, zero);
+            return zero;
+        }
+
+        // Operands first, when none depends on the variable neither does the record
+        std::uint32_t left = zero;
+        std::uint32_t right = zero;
+        if(arity(record.type) >= 1)
+        {
+            left = this->derive(record.left, variable);
+        }
+        if(arity(record.type) == 2)
+        {
+            right = this->derive(record.right, variable);
+        }
+        if(arity(record.type) > 0 && left == zero && right == zero)
+        {
+            this->derivatives.emplace(key, zero);
+            return zero;
+        }
+
+        switch(record.type)
+        {
+            case TypeNode::Number:
+                derivative = zero;
+                break;
+            case TypeNode::Variable:
+                derivative = record.left == variable ? this->number(getNumber<Type>(1.0)) : zero;
+                break;
+            case TypeNode::Minus:
+                derivative = this->unary(TypeNode::Minus, left);
+                break;
+            case TypeNode::Addition:
+            case TypeNode::Subtraction:
+                derivative = this->binary(record.type, left, right);
+                break;
+            // (u * v)' = u' * v + u * v'
+            case TypeNode::Multiplication:
+                derivative = this->binary(TypeNode::Addition,
+                    this->binary(TypeNode::Multiplication, left, record.right),
+                    this->binary(TypeNode::Multiplication, record.left, right)
+                );
+                break;
+            // (u / v)' = (u' * v - u * v') / v^2
+            case TypeNode::Division:
+                derivative = this->binary(TypeNode::Division,
+                    this->binary(TypeNode::Subtraction,
+                        this->binary(TypeNode::Multiplication, left, record.right),
+                        this->binary(TypeNode::Multiplication, record.left, right)
+                    ),
+                    this->binary(TypeNode::Power, record.right, this->number(getNumber<Type>(2.0)))
+                );
+                break;
+            // (u^v)' = v * u' * u^(v - 1) when v' = 0, which stays defined at u = 0
+            // (u^v)' = (v * u' / u + v' * ln(u)) * u^v otherwise
+            case TypeNode::Power:
+                if(right == zero)
+                {
+                    derivative = this->binary(TypeNode::Multiplication,
+                        this->binary(TypeNode::Multiplication, record.right, left),
+                        this->binary(TypeNode::Power,
+                            record.left,
+                            this->fold(TypeNode::Subtraction, record.right, this->number(getNumber<Type>(1.0)))
+                        )
+                    );
+                    break;
+                }
+                derivative = this->binary(TypeNode::Multiplication,
+                    this->binary(TypeNode::Addition,
+                        this->binary(TypeNode::Division,
+                            this->binary(TypeNode::Multiplication, record.right, left),
+                            record.left
+                        ),
+                        this->binary(TypeNode::Multiplication, right, this->unary(TypeNode::Ln, record.left))
+                    ),
+                    index
+                );
+                break;
+            // sin(u)' = cos(u) * u'
+            case TypeNode::Sin:
+                derivative = this->binary(TypeNode::Multiplication, this->unary(TypeNode::Cos, record.left), left);
+                break;
+            // cos(u)' = -sin(u) * u'
+            case TypeNode::Cos:
+                derivative = this->binary(TypeNode::Multiplication,
+                    this->unary(TypeNode::Minus, this->unary(TypeNode::Sin, record.left)),
+                    left
+                );
+                break;
+            // exp(u)' = exp(u) * u'
+            case TypeNode::Exp:
+                derivative = this->binary(TypeNode::Multiplication, index, left);
+                break;
+            // ln(u)' = 1 / u * u'
+            case TypeNode::Ln:
+                derivative = this->binary(TypeNode::Multiplication,
+                    this->binary(TypeNode::Division, this->number(getNumber<Type>(1.0)), record.left),
+                    left
+                );
+                break;
+        }
+
+        this->derivatives.emplace(key, derivative);
+        return derivative;
+    }
+
+
+    template<typename Type>
+    std::uint32_t Dag<Type>::differentiate(std::uint32_t index, const std::string& variable, int number)
+    {
+        for(int i = 0; i < number; i++)
+        {
+            index = this->differentiate(index, variable);
+        }
+        return index;
+    }
+
+
+    template<typename Type>
+    std::uint32_t Dag<Type>::specialize(std::uint32_t index, const std::map<std::string, Type>& bindings)
+    {
+        VariableSet bound;
+        std::unordered_map<std::size_t, Type> values;
+        for(const auto& [name, value] : bindings)
+        {
+            std::size_t id = internVariable(name);
+            bound.insert(id);
+            values.emplace(id, value);
+        }
+        std::unordered_map<std::uint32_t, std::uint32_t> memory;
+        std::uint32_t result {};
+        for(const std::uint32_t i : this->reachable(index))
+        {
+            result = this->specialize(i, bound, values, memory);
+        }
+        return result;
+    }
+
+
+    template<typename Type>
+    std::uint32_t Dag<Type>::specialize(std::uint32_t index, const VariableSet& bound,
+        const std::unordered_map<std::size_t, Type>& values, std::unordered_map<std::uint32_t, std::uint32_t>& memory)
+    {
+        if(!(this->summaries[index] & bound.getSummary()))
+        {
+            return index;
+        }
+        auto iter = memory.find(index);
+        if(iter != memory.end())
+        {
+            return iter->second;
+        }
+
+        Record record = this->records[index];
+        std::uint32_t result {};
+        switch(record.type)
+        {
+            case TypeNode::Number:
+                result = index;
+                break;
+            case TypeNode::Variable:
+            {
+                auto value = values.find(record.left);
+                result = value == values.end() ? index : this->number(value->second);
+                break;
+            }
+            case TypeNode::Minus:
+            case TypeNode::Sin:
+            case TypeNode::Cos:
+            case TypeNode::Exp:
+            case TypeNode::Ln:
+                result = this->fold(record.type, this->specialize(record.left, bound, values, memory), 0);
+                break;
+            default:
+            {
+                std::uint32_t left = this->specialize(record.left, bound, values, memory);
+                std::uint32_t right = this->specialize(record.right, bound, values, memory);
+                result = this->fold(record.type, left, right);
+            }
+        }
+        memory.emplace(index, result);
+        return result;
+    }
+
+
+    template<typename Type>
+    std::uint32_t Dag<Type>::fold(TypeNode type, std::uint32_t left, std::uint32_t right)
+    {
+        const bool isUnary = type == TypeNode::Minus || type == TypeNode::Sin || type == TypeNode::Cos
+            || type == TypeNode::Exp || type == TypeNode::Ln;
+        if(this->records[left].type != TypeNode::Number || (!isUnary && this->records[right].type != TypeNode::Number))
+        {
+            return isUnary ? this->unary(type, left) : this->binary(type, left, right);
+        }
+
+        // Singular operations stay symbolic, they throw when evaluated
+        const Type& u = this->constants[this->records[left].left];
+        const Type& v = isUnary ? u : this->constants[this->records[right].left];
+        switch(type)
+        {
+            case TypeNode::Minus:
+                return this->number(-u);
+            case TypeNode::Sin:
+                return this->number(std::sin(u));
+            case TypeNode::Cos:
+                return this->number(std::cos(u));
+            case TypeNode::Exp:
+                return this->number(std::exp(u));
+            case TypeNode::Ln:
+                return u == Type{} ? this->insert({type, left, 0}) : this->number(std::log(u));
+            case TypeNode::Addition:
+                return this->number(u + v);
+            case TypeNode::Subtraction:
+                return this->number(u - v);
+            case TypeNode::Multiplication:
+                return this->number(u * v);
+            case TypeNode::Division:
+                return v == Type{} ? this->insert({type, left, right}) : this->number(u / v);
+            case TypeNode::Power:
+                return this->number(std::pow(u, v));
+            default:
+                throw std::invalid_argument("Unknown node type");
+        }
+    }
+
+
+    template<typename Type>
+    std::uint32_t Dag<Type>::horner(std::uint32_t index)
+    {
+        std::unordered_map<std::uint32_t, std::optional<Polynomial>> polynomials;
+        std::unordered_map<std::uint32_t, std::uint32_t> memory;
+        std::uint32_t result {};
+        for(const std::uint32_t i : this->reachable(index))
+        {
+            result = this->horner(i, polynomials, memory);
+        }
+        return result;
+    }
+
+
+    template<typename Type>
+    std::uint32_t Dag<Type>::horner(std::uint32_t index, std::unordered_map<std::uint32_t, std::optional<Polynomial>>& polynomials,
+        std::unordered_map<std::uint32_t, std::uint32_t>& memory)
+    {
+        auto iter = memory.find(index);
+        if(iter != memory.end())
+        {
+            return iter->second;
+        }
+
+        Record record = this->records[index];
+        std::uint32_t result = index;
+        auto polynomial = this->polynomial(index, polynomials);
+        if(record.type == TypeNode::Number || record.type == TypeNode::Variable)
+        {
+            result = index;
+        }
+        // c_n x^n + ... + c_0 = (...(c_n x^(n - k) + c_k)...) x^j, missing powers are skipped
+        else if(polynomial && polynomial->variable != noRecord && polynomial->terms.size() >= 2
+            && polynomial->terms.rbegin()->first >= 2)
+        {
+            auto term = polynomial->terms.rbegin();
+            std::uint64_t degree = term->first;
+            result = this->number(term->second);
+            for(++term; term != polynomial->terms.rend(); ++term)
+            {
+                result = this->binary(TypeNode::Addition,
+                    this->binary(TypeNode::Multiplication, result, this->power(polynomial->variable, degree - term->first)),
+                    this->number(term->second)
+                );
+                degree = term->first;
+            }
+            if(degree > 0)
+            {
+                result = this->binary(TypeNode::Multiplication, result, this->power(polynomial->variable, degree));
+            }
+        }
+        else
+        {
+            switch(record.type)
+            {
+                case TypeNode::Minus:
+                case TypeNode::Sin:
+                case TypeNode::Cos:
+                case TypeNode::Exp:
+                case TypeNode::Ln:
+                    result = this->unary(record.type, this->horner(record.left, polynomials, memory));
+                    break;
+                default:
+                {
+                    std::uint32_t left = this->horner(record.left, polynomials, memory);
+                    std::uint32_t right = this->horner(record.right, polynomials, memory);
+                    result = this->insert({record.type, left, right});
+                }
+            }
+        }
+        memory.emplace(index, result);
+        return result;
+    }
+
+
+    template<typename Type>
+    std::optional<typename Dag<Type>::Polynomial> Dag<Type>::polynomial(std::uint32_t index,
+        std::unordered_map<std::uint32_t, std::optional<Polynomial>>& memory) const
+    {
+        auto iter = memory.find(index);
+        if(iter != memory.end())
+        {
+            return iter->second;
+        }
+
+        const Record& record = this->records[index];
+        std::optional<Polynomial> result;
+        auto isConstant = [](const Polynomial& polynomial)
+        {
+            return polynomial.variable == noRecord;
+        };
+        auto scale = [](Polynomial polynomial, const Type& factor)
+        {
+            for(auto& [degree, coefficient] : polynomial.terms)
+            {
+                coefficient *= factor;
+            }
+            return polynomial;
+        };
+        auto constant = [](const Polynomial& polynomial)
+        {
+            return polynomial.terms.empty() ? Type{} : polynomial.terms.begin()->second;
+        };
+
+        switch(record.type)
+        {
+            case TypeNode::Number:
+                result = Polynomial {noRecord, {{0, this->constants[record.left]}}};
+                break;
+            case TypeNode::Variable:
+                result = Polynomial {index, {{1, getNumber<Type>(1.0)}}};
+                break;
+            case TypeNode::Minus:
+            {
+                auto argument = this->polynomial(record.left, memory);
+                if(argument)
+                {
+                    result = scale(*argument, getNumber<Type>(-1.0));
+                }
+                break;
+            }
+            case TypeNode::Addition:
+            case TypeNode::Subtraction:
+            {
+                auto left = this->polynomial(record.left, memory);
+                auto right = this->polynomial(record.right, memory);
+                if(!left || !right || (!isConstant(*left) && !isConstant(*right) && left->variable != right->variable))
+                {
+                    break;
+                }
+                result = *left;
+                result->variable = isConstant(*left) ? right->variable : left->variable;
+                for(const auto& [degree, coefficient] : right->terms)
+                {
+                    Type& term = result->terms[degree];
+                    term = record.type == TypeNode::Addition ? term + coefficient : term - coefficient;
+                }
+                break;
+            }
+            // Only products of monomials or with a constant, expanding sums is not worth it
+            case TypeNode::Multiplication:
+            {
+                auto left = this->polynomial(record.left, memory);
+                auto right = this->polynomial(record.right, memory);
+                if(!left || !right)
+                {
+                    break;
+                }
+                if(isConstant(*left))
+                {
+                    result = scale(*right, constant(*left));
+                }
+                else if(isConstant(*right))
+                {
+                    result = scale(*left, constant(*right));
+                }
+                else if(left->variable == right->variable && left->terms.size() == 1 && right->terms.size() == 1)
+                {
+                    const auto& [first, a] = *left->terms.begin();
+                    const auto& [second, b] = *right->terms.begin();
+                    result = Polynomial {left->variable, {{first + second, a * b}}};
+                }
+                break;
+            }
+            case TypeNode::Power:
+            {
+                auto base = this->polynomial(record.left, memory);
+                const Record& exponent = this->records[record.right];
+                if(!base || base->terms.size() != 1 || exponent.type != TypeNode::Number)
+                {
+                    break;
+                }
+                const Type& value = this->constants[exponent.left];
+                if(std::imag(value) != 0 || std::real(value) < 0 || std::real(value) > 64
+                    || std::floor(std::real(value)) != std::real(value))
+                {
+                    break;
+                }
+                auto n = static_cast<std::uint64_t>(std::real(value));
+                const auto& [degree, coefficient] = *base->terms.begin();
+                result = Polynomial {base->variable, {{degree * n, std::pow(coefficient, value)}}};
+                break;
+            }
+            default:
+                break;
+        }
+
+        memory.emplace(index, result);
+        return result;
+    }
+
+
+    // x^n by repeated squaring, the intermediate powers are shared records
+    template<typename Type>
+    std::uint32_t Dag<Type>::power(std::uint32_t base, std::uint64_t exponent)
+    {
+        if(exponent == 1)
+        {
+            return base;
+        }
+        std::uint32_t half = this->power(base, exponent / 2);
+        std::uint32_t square = this->binary(TypeNode::Multiplication, half, half);
+        return exponent % 2 == 0 ? square : this->binary(TypeNode::Multiplication, square, base);
+    }
+
+
+    template<typename Type>
+    std::uint32_t Dag<Type>::reduce(std::uint32_t index)
+    {
+        const std::vector<std::uint32_t> order = this->reachable(index);
+        std::vector<std::uint32_t> uses(this->records.size(), 0);
+        for(const std::uint32_t i : order)
+        {
+            const Record& record = this->records[i];
+            const std::uint32_t operands[] {record.left, record.right};
+            for(std::size_t k = 0; k < arity(record.type); k++)
+            {
+                uses[operands[k]]++;
+            }
+        }
+
+        std::unordered_map<std::uint32_t, std::uint32_t> memory;
+        std::uint32_t result {};
+        for(const std::uint32_t i : order)
+        {
+            result = this->reduce(i, uses, memory);
+        }
+        return result;
+    }
+
+
+    template<typename Type>
+    std::uint32_t Dag<Type>::optimize(std::uint32_t index)
+    {
+        return this->reduce(this->horner(index));
+    }
+
+
+    template<typename Type>
+    std::uint32_t Dag<Type>::reduce(std::uint32_t index, const std::vector<std::uint32_t>& uses,
+        std::unordered_map<std::uint32_t, std::uint32_t>& memory)
+    {
+        auto iter = memory.find(index);
+        if(iter != memory.end())
+        {
+            return iter->second;
+        }
+
+        using Cost = Math::Cost<Type>;
+        Record record = this->records[index];
+        std::uint32_t result {};
+        switch(record.type)
+        {
+            case TypeNode::Number:
+            case TypeNode::Variable:
+                result = index;
+                break;
+            case TypeNode::Minus:
+            case TypeNode::Sin:
+            case TypeNode::Cos:
+            case TypeNode::Exp:
+            case TypeNode::Ln:
+                result = this->unary(record.type, this->reduce(record.left, uses, memory));
+                break;
+            default:
+            {
+                std::uint32_t left = this->reduce(record.left, uses, memory);
+                std::uint32_t right = this->reduce(record.right, uses, memory);
+                const Record first = this->records[left];
+                const Record second = this->records[right];
+                result = noRecord;
+
+                // Operands used only here disappear with the rewrite
+                const double unshared = (uses[record.left] == 1) + (uses[record.right] == 1);
+
+                // x^n = x * ... * x, x^-n = 1 / (x * ... * x) while x is not 0, as 0^-n is not a division by zero
+                if(record.type == TypeNode::Power && second.type == TypeNode::Number)
+                {
+                    const Type value = this->constants[second.left];
+                    const double exponent = std::real(value);
+                    const bool nonzero = first.type == TypeNode::Exp
+                        || (first.type == TypeNode::Number && this->constants[first.left] != Type{});
+                    if(std::imag(value) == 0 && std::floor(exponent) == exponent && std::abs(exponent) <= 64
+                        && (exponent >= 0 || nonzero))
+                    {
+                        auto n = static_cast<std::uint64_t>(std::abs(exponent));
+                        double multiplications = n == 0 ? 0 : std::bit_width(n) + std::popcount(n) - 2;
+                        double cost = multiplications * Cost::multiply + (exponent < 0 ? Cost::divide : 0);
+                        if(n == 0)
+                        {
+                            result = this->number(getNumber<Type>(1.0));
+                        }
+                        else if(cost < Cost::power)
+                        {
+                            result = this->power(left, n);
+                            if(exponent < 0)
+                            {
+                                result = this->binary(TypeNode::Division, this->number(getNumber<Type>(1.0)), result);
+                            }
+                        }
+                    }
+                }
+                // x / c = x * (1 / c)
+                else if(record.type == TypeNode::Division && second.type == TypeNode::Number
+                    && this->constants[second.left] != Type{} && Cost::multiply < Cost::divide)
+                {
+                    result = this->binary(TypeNode::Multiplication, left, this->number(getNumber<Type>(1.0) / this->constants[second.left]));
+                }
+                // exp(a) * exp(b) = exp(a + b)
+                else if(record.type == TypeNode::Multiplication && first.type == TypeNode::Exp && second.type == TypeNode::Exp
+                    && Cost::add + Cost::exp < Cost::multiply + unshared * Cost::exp)
+                {
+                    result = this->unary(TypeNode::Exp, this->binary(TypeNode::Addition, first.left, second.left));
+                }
+                // a * x + b * x = (a + b) * x
+                else if((record.type == TypeNode::Addition || record.type == TypeNode::Subtraction)
+                    && first.type == TypeNode::Multiplication && second.type == TypeNode::Multiplication
+                    && Cost::add + Cost::multiply < Cost::add + unshared * Cost::multiply)
+                {
+                    const std::uint32_t a[2] = {first.left, first.right};
+                    const std::uint32_t b[2] = {second.left, second.right};
+                    for(int i = 0; i < 2 && result == noRecord; i++)
+                    {
+                        for(int j = 0; j < 2 && result == noRecord; j++)
+                        {
+                            if(a[i] == b[j])
+                            {
+                                result = this->binary(TypeNode::Multiplication,
+                                    this->binary(record.type, a[1 - i], b[1 - j]),
+                                    a[i]
+                                );
+                            }
+                        }
+                    }
+                }
+
+                if(result == noRecord)
+                {
+                    result = this->insert({record.type, left, right});
+                }
+            }
+        }
+        memory.emplace(index, result);
+        return result;
+    }
+
+
+    template<typename Type>
+    std::unique_ptr<Node<Type>> Dag<Type>::toNode(std::uint32_t index) const
+    {
+        // Shared records are expanded into copies, operands are built first
+        std::vector<std::pair<std::uint32_t, std::size_t>> stack {{index, 0}};
+        std::vector<std::unique_ptr<Node<Type>>> operands;
+        while(true)
+        {
+            auto& [current, next] = stack.back();
+            const Record& record = this->records[current];
+            if(next < arity(record.type))
+            {
+                const std::uint32_t operand = next++ == 0 ? record.left : record.right;
+                stack.emplace_back(operand, 0);
+                continue;
+            }
+
+            std::unique_ptr<Node<Type>> node;
+            auto* last = operands.data() + operands.size();
+            switch(record.type)
+            {
+                case TypeNode::Number:
+                    node = std::make_unique<Number<Type>>(this->constants[record.left]);
+                    break;
+                case TypeNode::Variable:
+                    node = std::make_unique<Variable<Type>>(variableName(record.left));
+                    break;
+                case TypeNode::Minus:
+                    node = std::make_unique<Minus<Type>>(std::move(last[-1]));
+                    break;
+                case TypeNode::Sin:
+                    node = std::make_unique<Sin<Type>>(std::move(last[-1]));
+                    break;
+                case TypeNode::Cos:
+                    node = std::make_unique<Cos<Type>>(std::move(last[-1]));
+                    break;
+                case TypeNode::Exp:
+                    node = std::make_unique<Exp<Type>>(std::move(last[-1]));
+                    break;
+                case TypeNode::Ln:
+                    node = std::make_unique<Ln<Type>>(std::move(last[-1]));
+                    break;
+                case TypeNode::Addition:
+                    node = std::make_unique<Addition<Type>>(std::move(last[-2]), std::move(last[-1]));
+                    break;
+                case TypeNode::Subtraction:
+                    node = std::make_unique<Subtraction<Type>>(std::move(last[-2]), std::move(last[-1]));
+                    break;
+                case TypeNode::Multiplication:
+                    node = std::make_unique<Multiplication<Type>>(std::move(last[-2]), std::move(last[-1]));
+                    break;
+                case TypeNode::Division:
+                    node = std::make_unique<Division<Type>>(std::move(last[-2]), std::move(last[-1]));
+                    break;
+                case TypeNode::Power:
+                    node = std::make_unique<Power<Type>>(std::move(last[-2]), std::move(last[-1]));
+                    break;
+            }
+            operands.resize(operands.size() - arity(record.type));
+
+            stack.pop_back();
+            if(stack.empty())
+            {
+                return node;
+            }
+            operands.push_back(std::move(node));
+        }
+    }
+
+
+    template<typename Type>
+    Tape<Type> Dag<Type>::toTape(std::uint32_t index) const
+    {
+        // Reachable records come in increasing order, so the operands stay first
+        const std::vector<std::uint32_t> order = this->reachable(index);
+        std::unordered_map<std::uint32_t, std::uint32_t> position;
+        std::unordered_map<std::uint32_t, std::uint32_t> slots;
+        std::vector<typename Tape<Type>::Record> records;
+        std::vector<Type> constants;
+        std::vector<std::string> variables;
+        for(const std::uint32_t i : order)
+        {
+            Record record = this->records[i];
+            switch(arity(record.type))
+            {
+                case 0:
+                    if(record.type == TypeNode::Number)
+                    {
+                        constants.push_back(this->constants[record.left]);
+                        record.left = static_cast<std::uint32_t>(constants.size() - 1);
+                    }
+                    else
+                    {
+                        auto [iter, inserted] = slots.emplace(record.left, static_cast<std::uint32_t>(variables.size()));
+                        if(inserted)
+                        {
+                            variables.push_back(variableName(record.left));
+                        }
+                        record.left = iter->second;
+                    }
+                    break;
+                case 1:
+                    record.left = position[record.left];
+                    break;
+                default:
+                    record.left = position[record.left];
+                    record.right = position[record.right];
+            }
+            position.emplace(i, static_cast<std::uint32_t>(records.size()));
+            records.push_back({record.type, record.left, record.right});
+        }
+        return Tape<Type>(std::move(records), std::move(constants), std::move(variables));
+    }
+
+
+    template<typename Type>
+    std::size_t Dag<Type>::size() const
+    {
+        return this->records.size();
+    }
+
+
+    template<typename Type>
+    const typename Dag<Type>::Record& Dag<Type>::getRecord(std::uint32_t index) const
+    {
+        return this->records[index];
+    }
+
+
+    template<typename Type>
+    const Type& Dag<Type>::getConstant(const Record& record) const
+    {
+        return this->constants[record.left];
+    }
+
+
+    template<typename Type>
+    const std::string& Dag<Type>::getVariable(const Record& record) const
+    {
+        return variableName(record.left);
+    }
+
+
+    template<typename Type>
+    VariableSet Dag<Type>::getVariables(std::uint32_t index) const
+    {
+        VariableSet variables;
+        for(const std::uint32_t i : this->reachable(index))
+        {
+            if(this->records[i].type == TypeNode::Variable)
+            {
+                variables.insert(this->records[i].left);
+            }
+        }
+        return variables;
+    }
+} // Math
+
+
+#endif // DAG_HPP
@@ -0,0 +1,203 @@
+#ifndef DISK_CACHE_HPP
+#define DISK_CACHE_HPP
+
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include "Expression.hpp"
+#include "Tape.hpp"
+
+
+namespace Math
+{
+    // Results of simplify and differentiate kept in a directory between runs. A file is
+    // named by the hash of the operation and of the input tape, and holds both next to
+    // the result tape, so a hash collision is detected and only costs a recomputation.
+    // Files are written under a temporary name and renamed, which is atomic, so several
+    // processes may fill the same directory and a reader never sees a partial file.
+    template<typename Type>
+    class DiskCache
+    {
+    public:
+        // Part of every key, raise it when a change to the rules changes the results
+        static constexpr int version = 1;
+
+        explicit DiskCache(const std::filesystem::path& directory);
+
+        Expression<Type> simplify(const Expression<Type>& expression);
+        Expression<Type> differentiate(const Expression<Type>& expression, const std::string& variable="x", int number=1);
+
+        [[nodiscard]] std::size_t getHits() const;
+        [[nodiscard]] std::size_t getMisses() const;
+
+    private:
+        template<typename Compute>
+        Expression<Type> lookup(const std::string& operation, const Expression<Type>& expression, Compute compute);
+
+        // FNV-1a
+        static std::uint64_t digest(const std::string& bytes);
+
+        static std::string read(const std::filesystem::path& path);
+        void write(const std::filesystem::path& path, const std::string& bytes) const;
+
+        std::filesystem::path directory;
+
+        std::atomic<std::size_t> hits = 0;
+        std::atomic<std::size_t> misses = 0;
+    };
+} // Math
+
+
+
+// Implementation
+namespace Math
+{
+    template<typename Type>
+    DiskCache<Type>::DiskCache(const std::filesystem::path& directory)
+        : directory(directory)
+    {
+        std::filesystem::create_directories(directory);
+    }
+
+
+    template<typename Type>
+    Expression<Type> DiskCache<Type>::simplify(const Expression<Type>& expression)
+    {
+        return this->lookup("simplify", expression, [&expression]() {
+            return expression.simplify();
+        });
+    }
+
+
+    template<typename Type>
+    Expression<Type> DiskCache<Type>::differentiate(const Expression<Type>& expression, const std::string& variable, int number)
+    {
+        const std::string operation = "differentiate " + variable + " " + std::to_string(number);
+        return this->lookup(operation, expression, [&]() {
+            return expression.differentiate(variable, number);
+        });
+    }
+
+
+    template<typename Type>
+    std::size_t DiskCache<Type>::getHits() const
+    {
+        return this->hits;
+    }
+
+
+    template<typename Type>
+    std::size_t DiskCache<Type>::getMisses() const
+    {
+        return this->misses;
+    }
+
+
+    template<typename Type>
+    template<typename Compute>
+    Expression<Type> DiskCache<Type>::lookup(const std::string& operation, const Expression<Type>& expression, Compute compute)
+    {
+        // The type is part of the key, double and std::complex<float> have the same size
+        std::string key = "v" + std::to_string(version) + " " + operation
+            + (std::is_floating_point_v<Type> ? " real " : " complex ") + std::to_string(sizeof(Type));
+        key.push_back('\0');
+        key += expression.tape().serialize();
+
+        std::ostringstream name;
+        name << std::hex << digest(key) << ".tape";
+        const std::filesystem::path path = this->directory / name.str();
+
+        // Layout: the length of the key, the key and the result tape
+        const std::string bytes = read(path);
+        const std::uint64_t length = key.size();
+        std::uint64_t stored = 0;
+        if(bytes.size() > sizeof(length) + length)
+        {
+            std::memcpy(&stored, bytes.data(), sizeof(stored));
+        }
+        if(stored == length && bytes.compare(sizeof(length), length, key) == 0)
+        {
+            // Any failure to decode a damaged entry is a miss
+            try
+            {
+                Expression<Type> result(Tape<Type>::deserialize(bytes.substr(sizeof(length) + length)));
+                this->hits++;
+                return result;
+            }
+            catch(const std::exception&) {}
+        }
+
+        this->misses++;
+        Expression<Type> result = compute();
+        std::string entry(reinterpret_cast<const char*>(&length), sizeof(length));
+        entry += key;
+        entry += result.tape().serialize();
+        this->write(path, entry);
+        return result;
+    }
+
+
+    template<typename Type>
+    std::uint64_t DiskCache<Type>::digest(const std::string& bytes)
+    {
+        std::uint64_t hash = 0xCBF29CE484222325ull;
+        for(const char c : bytes)
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 0x100000001B3ull;
+        }
+        return hash;
+    }
+
+
+    template<typename Type>
+    std::string DiskCache<Type>::read(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if(!file)
+        {
+            return {};
+        }
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+
+    // The cache is only an accelerator, a failed write leaves the entry missing
+    template<typename Type>
+    void DiskCache<Type>::write(const std::filesystem::path& path, const std::string& bytes) const
+    {
+        std::random_device random;
+        std::filesystem::path temporary = path;
+        temporary += "." + std::to_string(random()) + std::to_string(random()) + ".tmp";
+
+        std::error_code error;
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            if(!file.write(bytes.data(), static_cast<std::streamsize>(bytes.size())) || !file.flush())
+            {
+                file.close();
+                std::filesystem::remove(temporary, error);
+                return;
+            }
+        }
+        std::filesystem::rename(temporary, path, error);
+        if(error)
+        {
+            std::filesystem::remove(temporary, error);
+        }
+    }
+} // Math
+
+
+#endif // DISK_CACHE_HPP
@@ -0,0 +1,208 @@
+#ifndef DUAL_HPP
+#define DUAL_HPP
+
+
+#include <cmath>
+#include <complex>
+
+
+namespace Math
+{
+    // value + derivative * e, where e^2 = 0
+    // Evaluating a program over dual numbers gives a directional derivative in one sweep
+    template<typename Type>
+    struct Dual
+    {
+        Type value {};
+        Type derivative {};
+
+        Dual() = default;
+        Dual(const Type& value, const Type& derivative = Type{});
+
+        bool operator==(const Dual& other) const;
+        bool operator!=(const Dual& other) const;
+
+        Dual& operator+=(const Dual& other);
+        Dual& operator-=(const Dual& other);
+        Dual& operator*=(const Dual& other);
+        Dual& operator/=(const Dual& other);
+    };
+
+
+    template<typename Type>
+    bool isZero(const Dual<Type>& x);
+
+    template<typename Type>
+    Dual<Type> operator-(const Dual<Type>& x);
+
+    template<typename Type>
+    Dual<Type> operator+(const Dual<Type>& x, const Dual<Type>& y);
+    template<typename Type>
+    Dual<Type> operator-(const Dual<Type>& x, const Dual<Type>& y);
+    template<typename Type>
+    Dual<Type> operator*(const Dual<Type>& x, const Dual<Type>& y);
+    template<typename Type>
+    Dual<Type> operator/(const Dual<Type>& x, const Dual<Type>& y);
+
+    template<typename Type>
+    Dual<Type> pow(const Dual<Type>& x, const Dual<Type>& y);
+    template<typename Type>
+    Dual<Type> sin(const Dual<Type>& x);
+    template<typename Type>
+    Dual<Type> cos(const Dual<Type>& x);
+    template<typename Type>
+    Dual<Type> exp(const Dual<Type>& x);
+    template<typename Type>
+    Dual<Type> log(const Dual<Type>& x);
+} // Math
+
+
+
+// Implementation
+namespace Math
+{
+    template<typename Type>
+    Dual<Type>::Dual(const Type& value, const Type& derivative) : value(value), derivative(derivative) {}
+
+
+    template<typename Type>
+    bool Dual<Type>::operator==(const Dual& other) const
+    {
+        return this->value == other.value && this->derivative == other.derivative;
+    }
+
+
+    template<typename Type>
+    bool Dual<Type>::operator!=(const Dual& other) const
+    {
+        return !(*this == other);
+    }
+
+
+    template<typename Type>
+    Dual<Type>& Dual<Type>::operator+=(const Dual& other)
+    {
+        this->value += other.value;
+        this->derivative += other.derivative;
+        return *this;
+    }
+
+
+    template<typename Type>
+    Dual<Type>& Dual<Type>::operator-=(const Dual& other)
+    {
+        this->value -= other.value;
+        this->derivative -= other.derivative;
+        return *this;
+    }
+
+
+    template<typename Type>
+    Dual<Type>& Dual<Type>::operator*=(const Dual& other)
+    {
+        return *this = *this * other;
+    }
+
+
+    template<typename Type>
+    Dual<Type>& Dual<Type>::operator/=(const Dual& other)
+    {
+        return *this = *this / other;
+    }
+
+
+    // Division and logarithm are singular only where the value vanishes
+    template<typename Type>
+    bool isZero(const Dual<Type>& x)
+    {
+        return x.value == Type{};
+    }
+
+
+    template<typename Type>
+    Dual<Type> operator-(const Dual<Type>& x)
+    {
+        return Dual<Type>(-x.value, -x.derivative);
+    }
+
+
+    template<typename Type>
+    Dual<Type> operator+(const Dual<Type>& x, const Dual<Type>& y)
+    {
+        return Dual<Type>(x.value + y.value, x.derivative + y.derivative);
+    }
+
+
+    template<typename Type>
+    Dual<Type> operator-(const Dual<Type>& x, const Dual<Type>& y)
+    {
+        return Dual<Type>(x.value - y.value, x.derivative - y.derivative);
+    }
+
+
+    // (uv)' = u'v + uv'
+    template<typename Type>
+    Dual<Type> operator*(const Dual<Type>& x, const Dual<Type>& y)
+    {
+        return Dual<Type>(x.value * y.value, x.derivative * y.value + x.value * y.derivative);
+    }
+
+
+    // (u/v)' = (u' - (u/v)v') / v
+    template<typename Type>
+    Dual<Type> operator/(const Dual<Type>& x, const Dual<Type>& y)
+    {
+        Type value = x.value / y.value;
+        return Dual<Type>(value, (x.derivative - value * y.derivative) / y.value);
+    }
+
+
+    // (u^v)' = v u^(v-1) u' + ln(u) u^v v'
+    template<typename Type>
+    Dual<Type> pow(const Dual<Type>& x, const Dual<Type>& y)
+    {
+        Type value = std::pow(x.value, y.value);
+        Type derivative {};
+        if(x.derivative != Type{})
+        {
+            derivative += y.value * std::pow(x.value, y.value - Type(1)) * x.derivative;
+        }
+        if(y.derivative != Type{})
+        {
+            derivative += std::log(x.value) * value * y.derivative;
+        }
+        return Dual<Type>(value, derivative);
+    }
+
+
+    template<typename Type>
+    Dual<Type> sin(const Dual<Type>& x)
+    {
+        return Dual<Type>(std::sin(x.value), std::cos(x.value) * x.derivative);
+    }
+
+
+    template<typename Type>
+    Dual<Type> cos(const Dual<Type>& x)
+    {
+        return Dual<Type>(std::cos(x.value), -std::sin(x.value) * x.derivative);
+    }
+
+
+    template<typename Type>
+    Dual<Type> exp(const Dual<Type>& x)
+    {
+        Type value = std::exp(x.value);
+        return Dual<Type>(value, value * x.derivative);
+    }
+
+
+    template<typename Type>
+    Dual<Type> log(const Dual<Type>& x)
+    {
+        return Dual<Type>(std::log(x.value), x.derivative / x.value);
+    }
+} // Math
+
+
+#endif // DUAL_HPP
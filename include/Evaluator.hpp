@@ -0,0 +1,859 @@
+#ifndef EVALUATOR_HPP
+#define EVALUATOR_HPP
+
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "Dag.hpp"
+#include "Kernels.hpp"
+
+
+namespace Math
+{
+    template<typename Value>
+    bool isZero(const Value& value)
+    {
+        return value == Value{};
+    }
+
+
+    template<typename Type>
+    struct RealType
+    {
+        using type = Type;
+    };
+
+
+    template<typename Type>
+    struct RealType<std::complex<Type>>
+    {
+        using type = Type;
+    };
+
+
+    // Straight-line program compiled from the outputs of a Dag.
+    // Every shared subexpression is evaluated once per call.
+    template<typename Type>
+    class Evaluator
+    {
+    public:
+        // Number: left is an index into the constant pool
+        // Variable: left is an index into the variable slots
+        // Other nodes: left and right are registers of earlier instructions
+        // Sin and Cos: right is the register of the partner over the same argument, or 0,
+        // the earlier of the two computes both values with one sincos
+        struct Instruction
+        {
+            TypeNode type;
+            std::uint32_t left;
+            std::uint32_t right;
+        };
+
+        Evaluator(const Dag<Type>& dag, const std::vector<std::uint32_t>& outputs);
+
+        [[nodiscard]] const std::vector<std::string>& getVariables() const;
+
+        [[nodiscard]] std::size_t size() const;
+
+        [[nodiscard]] const std::vector<Instruction>& getProgram() const;
+        [[nodiscard]] const std::vector<Type>& getConstants() const;
+        [[nodiscard]] const std::vector<std::uint32_t>& getOutputs() const;
+
+        std::vector<Type> getSlots(const std::vector<std::string>& variable, const std::vector<Type>& value) const;
+
+        std::vector<Type> calculate(const std::vector<std::string>& variable, const std::vector<Type>& value) const;
+        std::vector<Type> calculate(const std::vector<Type>& value) const;
+
+        // For complex Type: the registers that stay real while the given variables are real
+        // are calculated in the real type. A complex value of such a variable falls back to
+        // complex arithmetic for that call.
+        void setReal(const std::vector<std::string>& variables);
+        [[nodiscard]] std::size_t countReal() const;
+
+        // Many points at once: value[slot][point], the result is result[output][point].
+        // Points are run in blocks, every instruction is a loop over the block.
+        std::vector<std::vector<Type>> calculateBatch(const std::vector<std::vector<Type>>& value) const;
+
+        // Batch for complex Type over split real and imaginary arrays: value[slot], the result
+        // is result[output]. The complex kernels work on plain arrays of the real type.
+        std::vector<SplitComplex<typename RealType<Type>::type>> calculateSplit(const std::vector<SplitComplex<typename RealType<Type>::type>>& value) const;
+
+        // Values of all registers, in program order
+        // Value may be any number-like type constructible from Type, e.g. Dual<Type>
+        template<typename Value = Type>
+        std::vector<Value> forward(const std::vector<Value>& value) const;
+
+        // Value of the instruction i, its operands are taken from registers
+        template<typename Value = Type>
+        Value execute(std::size_t i, const std::vector<Value>& registers, const std::vector<Value>& value) const;
+
+        // Adjoints of the variable slots, given the registers from forward
+        // and the seeded adjoints of the registers
+        template<typename Value = Type>
+        std::vector<Value> backward(const std::vector<Value>& tape, std::vector<Value> adjoint) const;
+
+    private:
+        static constexpr std::size_t block = 64;
+
+        template<typename Value>
+        static Value apply(TypeNode type, const Value& left, const Value& right);
+
+        std::vector<Type> calculateMixed(const std::vector<Type>& value) const;
+
+        std::vector<char> real;
+        std::vector<char> realSlots;
+
+        std::vector<Instruction> program;
+        std::vector<Type> constants;
+        std::vector<std::string> variables;
+        std::vector<std::uint32_t> outputs;
+    };
+} // Math
+
+
+
+// Implementation
+namespace Math
+{
+    template<typename Type>
+    Evaluator<Type>::Evaluator(const Dag<Type>& dag, const std::vector<std::uint32_t>& outputs)
+    {
+        std::vector<bool> used(dag.size(), false);
+        for(const std::uint32_t output : outputs)
+        {
+            used[output] = true;
+        }
+        for(std::size_t i = dag.size(); i-- > 0;)
+        {
+            if(!used[i])
+            {
+                continue;
+            }
+            const auto& record = dag.getRecord(i);
+            switch(record.type)
+            {
+                case TypeNode::Number:
+                case TypeNode::Variable:
+                    break;
+                case TypeNode::Minus:
+                case TypeNode::Sin:
+                case TypeNode::Cos:
+                case TypeNode::Exp:
+                case TypeNode::Ln:
+                    used[record.left] = true;
+                    break;
+                default:
+                    used[record.left] = true;
+                    used[record.right] = true;
+            }
+        }
+
+        std::vector<std::uint32_t> registers(dag.size());
+        std::unordered_map<std::uint32_t, std::uint32_t> slots;
+        for(std::uint32_t i = 0; i < dag.size(); i++)
+        {
+            if(!used[i])
+            {
+                continue;
+            }
+            const auto& record = dag.getRecord(i);
+            Instruction instruction {record.type, 0, 0};
+            switch(record.type)
+            {
+                case TypeNode::Number:
+                    instruction.left = this->constants.size();
+                    this->constants.push_back(dag.getConstant(record));
+                    break;
+                case TypeNode::Variable:
+                {
+                    // Slots by interned id, a search by name would be quadratic
+                    auto [iter, inserted] = slots.emplace(record.left, static_cast<std::uint32_t>(this->variables.size()));
+                    instruction.left = iter->second;
+                    if(inserted)
+                    {
+                        this->variables.push_back(dag.getVariable(record));
+                    }
+                    break;
+                }
+                case TypeNode::Minus:
+                case TypeNode::Sin:
+                case TypeNode::Cos:
+                case TypeNode::Exp:
+                case TypeNode::Ln:
+                    instruction.left = registers[record.left];
+                    break;
+                default:
+                    instruction.left = registers[record.left];
+                    instruction.right = registers[record.right];
+            }
+            registers[i] = this->program.size();
+            this->program.push_back(instruction);
+        }
+
+        for(const std::uint32_t output : outputs)
+        {
+            this->outputs.push_back(registers[output]);
+        }
+
+        std::unordered_map<std::uint32_t, std::uint32_t> sines;
+        for(std::uint32_t i = 0; i < this->program.size(); i++)
+        {
+            if(this->program[i].type == TypeNode::Sin)
+            {
+                sines.emplace(this->program[i].left, i);
+            }
+        }
+        for(std::uint32_t i = 0; i < this->program.size(); i++)
+        {
+            auto iter = sines.find(this->program[i].left);
+            if(this->program[i].type == TypeNode::Cos && iter != sines.end())
+            {
+                this->program[i].right = iter->second;
+                this->program[iter->second].right = i;
+            }
+        }
+    }
+
+
+    template<typename Type>
+    const std::vector<std::string>& Evaluator<Type>::getVariables() const
+    {
+        return this->variables;
+    }
+
+
+    template<typename Type>
+    std::size_t Evaluator<Type>::size() const
+    {
+        return this->program.size();
+    }
+
+
+    template<typename Type>
+    const std::vector<typename Evaluator<Type>::Instruction>& Evaluator<Type>::getProgram() const
+    {
+        return this->program;
+    }
+
+
+    template<typename Type>
+    const std::vector<Type>& Evaluator<Type>::getConstants() const
+    {
+        return this->constants;
+    }
+
+
+    template<typename Type>
+    const std::vector<std::uint32_t>& Evaluator<Type>::getOutputs() const
+    {
+        return this->outputs;
+    }
+
+
+    template<typename Type>
+    std::vector<Type> Evaluator<Type>::getSlots(const std::vector<std::string>& variable, const std::vector<Type>& value) const
+    {
+        std::vector<Type> slots;
+        slots.reserve(this->variables.size());
+        for(const std::string& name : this->variables)
+        {
+            auto iter = std::find(variable.begin(), variable.end(), name);
+            if(iter == variable.end())
+            {
+                throw std::invalid_argument("The variable \"" + name + "\" has no value");
+            }
+            slots.push_back(value[iter - variable.begin()]);
+        }
+        return slots;
+    }
+
+
+    template<typename Type>
+    std::vector<Type> Evaluator<Type>::calculate(const std::vector<std::string>& variable, const std::vector<Type>& value) const
+    {
+        return this->calculate(this->getSlots(variable, value));
+    }
+
+
+    template<typename Type>
+    std::vector<Type> Evaluator<Type>::calculate(const std::vector<Type>& value) const
+    {
+        if(!this->real.empty())
+        {
+            bool real = true;
+            for(std::size_t slot = 0; slot < value.size(); slot++)
+            {
+                real = real && (!this->realSlots[slot] || std::imag(value[slot]) == 0);
+            }
+            if(real)
+            {
+                return this->calculateMixed(value);
+            }
+        }
+
+        std::vector<Type> registers = this->forward(value);
+
+        std::vector<Type> result;
+        result.reserve(this->outputs.size());
+        for(const std::uint32_t output : this->outputs)
+        {
+            result.push_back(registers[output]);
+        }
+        return result;
+    }
+
+
+    template<typename Type>
+    void Evaluator<Type>::setReal(const std::vector<std::string>& variables)
+    {
+        if constexpr(std::is_same_v<Type, typename RealType<Type>::type>)
+        {
+            return;
+        }
+
+        this->realSlots.assign(this->variables.size(), false);
+        for(std::size_t slot = 0; slot < this->variables.size(); slot++)
+        {
+            this->realSlots[slot] = std::find(variables.begin(), variables.end(), this->variables[slot]) != variables.end();
+        }
+
+        // ln and powers with other than integer exponents may leave the reals
+        this->real.assign(this->program.size(), false);
+        for(std::size_t i = 0; i < this->program.size(); i++)
+        {
+            const Instruction& instruction = this->program[i];
+            switch(instruction.type)
+            {
+                case TypeNode::Number:
+                    this->real[i] = std::imag(this->constants[instruction.left]) == 0;
+                    break;
+                case TypeNode::Variable:
+                    this->real[i] = this->realSlots[instruction.left];
+                    break;
+                case TypeNode::Minus:
+                case TypeNode::Sin:
+                case TypeNode::Cos:
+                case TypeNode::Exp:
+                    this->real[i] = this->real[instruction.left];
+                    break;
+                case TypeNode::Ln:
+                    break;
+                case TypeNode::Power:
+                {
+                    const Instruction& exponent = this->program[instruction.right];
+                    if(this->real[instruction.left] && exponent.type == TypeNode::Number)
+                    {
+                        const Type& value = this->constants[exponent.left];
+                        this->real[i] = std::imag(value) == 0 && std::floor(std::real(value)) == std::real(value);
+                    }
+                    break;
+                }
+                default:
+                    this->real[i] = this->real[instruction.left] && this->real[instruction.right];
+            }
+        }
+    }
+
+
+    template<typename Type>
+    std::size_t Evaluator<Type>::countReal() const
+    {
+        return std::count(this->real.begin(), this->real.end(), true);
+    }
+
+
+    // Real registers keep a zero imaginary part, so they are read back without promotion
+    template<typename Type>
+    std::vector<Type> Evaluator<Type>::calculateMixed(const std::vector<Type>& value) const
+    {
+        using Real = typename RealType<Type>::type;
+
+        std::vector<Type> registers(this->program.size());
+        for(std::size_t i = 0; i < this->program.size(); i++)
+        {
+            const Instruction& instruction = this->program[i];
+            const Type& left = registers[instruction.left];
+            const Type& right = registers[instruction.right];
+            switch(instruction.type)
+            {
+                case TypeNode::Number:
+                    registers[i] = this->constants[instruction.left];
+                    break;
+                case TypeNode::Variable:
+                    registers[i] = value[instruction.left];
+                    break;
+                case TypeNode::Sin:
+                case TypeNode::Cos:
+                    if(instruction.right != 0)
+                    {
+                        if(instruction.right > i)
+                        {
+                            Type& sine = registers[instruction.type == TypeNode::Sin ? i : instruction.right];
+                            Type& cosine = registers[instruction.type == TypeNode::Sin ? instruction.right : i];
+                            if(this->real[i])
+                            {
+                                Real s, c;
+                                sincos(std::real(left), s, c);
+                                sine = s;
+                                cosine = c;
+                            }
+                            else
+                            {
+                                sincos(left, sine, cosine);
+                            }
+                        }
+                        break;
+                    }
+                    [[fallthrough]];
+                default:
+                    if(this->real[i])
+                    {
+                        registers[i] = apply(instruction.type, std::real(left), std::real(right));
+                    }
+                    else
+                    {
+                        registers[i] = apply(instruction.type, left, right);
+                    }
+            }
+        }
+
+        std::vector<Type> result;
+        result.reserve(this->outputs.size());
+        for(const std::uint32_t output : this->outputs)
+        {
+            result.push_back(registers[output]);
+        }
+        return result;
+    }
+
+
+    template<typename Type>
+    std::vector<std::vector<Type>> Evaluator<Type>::calculateBatch(const std::vector<std::vector<Type>>& value) const
+    {
+        const std::size_t points = value.empty() ? 0 : value.front().size();
+        for(const auto& slot : value)
+        {
+            if(slot.size() != points)
+            {
+                throw std::invalid_argument("All the variables need the same number of values");
+            }
+        }
+
+        std::vector<std::vector<Type>> result(this->outputs.size(), std::vector<Type>(points));
+        std::vector<Type> registers(this->program.size() * block);
+        for(std::size_t first = 0; first < points; first += block)
+        {
+            const std::size_t count = std::min(block, points - first);
+            for(std::size_t i = 0; i < this->program.size(); i++)
+            {
+                const Instruction& instruction = this->program[i];
+                const Type* left = registers.data() + instruction.left * block;
+                const Type* right = registers.data() + instruction.right * block;
+                Type* target = registers.data() + i * block;
+                switch(instruction.type)
+                {
+                    case TypeNode::Number:
+                        std::fill(target, target + count, this->constants[instruction.left]);
+                        break;
+                    case TypeNode::Variable:
+                        std::copy(value[instruction.left].begin() + first, value[instruction.left].begin() + first + count, target);
+                        break;
+                    case TypeNode::Minus:
+                        for(std::size_t k = 0; k < count; k++)
+                        {
+                            target[k] = -left[k];
+                        }
+                        break;
+                    case TypeNode::Addition:
+                        for(std::size_t k = 0; k < count; k++)
+                        {
+                            target[k] = left[k] + right[k];
+                        }
+                        break;
+                    case TypeNode::Subtraction:
+                        for(std::size_t k = 0; k < count; k++)
+                        {
+                            target[k] = left[k] - right[k];
+                        }
+                        break;
+                    case TypeNode::Multiplication:
+                        for(std::size_t k = 0; k < count; k++)
+                        {
+                            target[k] = left[k] * right[k];
+                        }
+                        break;
+                    case TypeNode::Division:
+                        if(std::any_of(right, right + count, [](const Type& x) { return x == Type{}; }))
+                        {
+                            throw std::invalid_argument("Division by zero");
+                        }
+                        for(std::size_t k = 0; k < count; k++)
+                        {
+                            target[k] = left[k] / right[k];
+                        }
+                        break;
+                    case TypeNode::Power:
+                        for(std::size_t k = 0; k < count; k++)
+                        {
+                            target[k] = std::pow(left[k], right[k]);
+                        }
+                        break;
+                    case TypeNode::Sin:
+                        if(instruction.right > i)
+                        {
+                            sincos(left, target, registers.data() + instruction.right * block, count);
+                        }
+                        else if(instruction.right == 0)
+                        {
+                            for(std::size_t k = 0; k < count; k++)
+                            {
+                                target[k] = std::sin(left[k]);
+                            }
+                        }
+                        break;
+                    case TypeNode::Cos:
+                        if(instruction.right > i)
+                        {
+                            sincos(left, registers.data() + instruction.right * block, target, count);
+                        }
+                        else if(instruction.right == 0)
+                        {
+                            for(std::size_t k = 0; k < count; k++)
+                            {
+                                target[k] = std::cos(left[k]);
+                            }
+                        }
+                        break;
+                    case TypeNode::Exp:
+                        for(std::size_t k = 0; k < count; k++)
+                        {
+                            target[k] = std::exp(left[k]);
+                        }
+                        break;
+                    case TypeNode::Ln:
+                        if(std::any_of(left, left + count, [](const Type& x) { return x == Type{}; }))
+                        {
+                            throw std::invalid_argument("Logarithm from zero");
+                        }
+                        for(std::size_t k = 0; k < count; k++)
+                        {
+                            target[k] = std::log(left[k]);
+                        }
+                        break;
+                }
+            }
+            for(std::size_t j = 0; j < this->outputs.size(); j++)
+            {
+                const Type* output = registers.data() + this->outputs[j] * block;
+                std::copy(output, output + count, result[j].begin() + first);
+            }
+        }
+        return result;
+    }
+
+
+    template<typename Type>
+    std::vector<SplitComplex<typename RealType<Type>::type>> Evaluator<Type>::calculateSplit(const std::vector<SplitComplex<typename RealType<Type>::type>>& value) const
+    {
+        using Real = typename RealType<Type>::type;
+        static_assert(!std::is_same_v<Type, Real>, "The split layout requires a complex Type");
+
+        const std::size_t points = value.empty() ? 0 : value.front().real.size();
+        for(const auto& slot : value)
+        {
+            if(slot.real.size() != points || slot.imag.size() != points)
+            {
+                throw std::invalid_argument("All the variables need the same number of values");
+            }
+        }
+
+        std::vector<SplitComplex<Real>> result(this->outputs.size(), {std::vector<Real>(points), std::vector<Real>(points)});
+        std::vector<Real> re(this->program.size() * block);
+        std::vector<Real> im(this->program.size() * block);
+        std::vector<Real> scratch(2 * block);
+        for(std::size_t first = 0; first < points; first += block)
+        {
+            const std::size_t count = std::min(block, points - first);
+            for(std::size_t i = 0; i < this->program.size(); i++)
+            {
+                const Instruction& instruction = this->program[i];
+                const Real* a = re.data() + instruction.left * block;
+                const Real* b = im.data() + instruction.left * block;
+                const Real* c = re.data() + instruction.right * block;
+                const Real* d = im.data() + instruction.right * block;
+                Real* u = re.data() + i * block;
+                Real* v = im.data() + i * block;
+                switch(instruction.type)
+                {
+                    case TypeNode::Number:
+                        std::fill(u, u + count, this->constants[instruction.left].real());
+                        std::fill(v, v + count, this->constants[instruction.left].imag());
+                        break;
+                    case TypeNode::Variable:
+                        std::copy(value[instruction.left].real.begin() + first, value[instruction.left].real.begin() + first + count, u);
+                        std::copy(value[instruction.left].imag.begin() + first, value[instruction.left].imag.begin() + first + count, v);
+                        break;
+                    case TypeNode::Minus:
+                        for(std::size_t k = 0; k < count; k++)
+                        {
+                            u[k] = -a[k];
+                            v[k] = -b[k];
+                        }
+                        break;
+                    case TypeNode::Addition:
+                        for(std::size_t k = 0; k < count; k++)
+                        {
+                            u[k] = a[k] + c[k];
+                            v[k] = b[k] + d[k];
+                        }
+                        break;
+                    case TypeNode::Subtraction:
+                        for(std::size_t k = 0; k < count; k++)
+                        {
+                            u[k] = a[k] - c[k];
+                            v[k] = b[k] - d[k];
+                        }
+                        break;
+                    case TypeNode::Multiplication:
+                        complexMultiply(a, b, c, d, u, v, count);
+                        break;
+                    case TypeNode::Division:
+                        for(std::size_t k = 0; k < count; k++)
+                        {
+                            if(c[k] == 0 && d[k] == 0)
+                            {
+                                throw std::invalid_argument("Division by zero");
+                            }
+                        }
+                        complexDivide(a, b, c, d, u, v, count);
+                        break;
+                    case TypeNode::Power:
+                        for(std::size_t k = 0; k < count; k++)
+                        {
+                            Type power = std::pow(Type(a[k], b[k]), Type(c[k], d[k]));
+                            u[k] = power.real();
+                            v[k] = power.imag();
+                        }
+                        break;
+                    case TypeNode::Sin:
+                        if(instruction.right > i)
+                        {
+                            complexSinCos(a, b, u, v, re.data() + instruction.right * block, im.data() + instruction.right * block, count);
+                        }
+                        else if(instruction.right == 0)
+                        {
+                            complexSinCos(a, b, u, v, scratch.data(), scratch.data() + block, count);
+                        }
+                        break;
+                    case TypeNode::Cos:
+                        if(instruction.right > i)
+                        {
+                            complexSinCos(a, b, re.data() + instruction.right * block, im.data() + instruction.right * block, u, v, count);
+                        }
+                        else if(instruction.right == 0)
+                        {
+                            complexSinCos(a, b, scratch.data(), scratch.data() + block, u, v, count);
+                        }
+                        break;
+                    case TypeNode::Exp:
+                        complexExp(a, b, u, v, count);
+                        break;
+                    case TypeNode::Ln:
+                        for(std::size_t k = 0; k < count; k++)
+                        {
+                            if(a[k] == 0 && b[k] == 0)
+                            {
+                                throw std::invalid_argument("Logarithm from zero");
+                            }
+                        }
+                        complexLog(a, b, u, v, count);
+                        break;
+                }
+            }
+            for(std::size_t j = 0; j < this->outputs.size(); j++)
+            {
+                const std::size_t output = this->outputs[j] * block;
+                std::copy(re.begin() + output, re.begin() + output + count, result[j].real.begin() + first);
+                std::copy(im.begin() + output, im.begin() + output + count, result[j].imag.begin() + first);
+            }
+        }
+        return result;
+    }
+
+
+    template<typename Type>
+    template<typename Value>
+    std::vector<Value> Evaluator<Type>::forward(const std::vector<Value>& value) const
+    {
+        std::vector<Value> registers(this->program.size());
+        for(std::size_t i = 0; i < this->program.size(); i++)
+        {
+            const Instruction& instruction = this->program[i];
+            if((instruction.type == TypeNode::Sin || instruction.type == TypeNode::Cos) && instruction.right != 0)
+            {
+                if(instruction.right > i)
+                {
+                    Value& sine = registers[instruction.type == TypeNode::Sin ? i : instruction.right];
+                    Value& cosine = registers[instruction.type == TypeNode::Sin ? instruction.right : i];
+                    sincos(registers[instruction.left], sine, cosine);
+                }
+                continue;
+            }
+            registers[i] = this->execute(i, registers, value);
+        }
+        return registers;
+    }
+
+
+    template<typename Type>
+    template<typename Value>
+    Value Evaluator<Type>::execute(std::size_t i, const std::vector<Value>& registers, const std::vector<Value>& value) const
+    {
+        const Instruction& instruction = this->program[i];
+        switch(instruction.type)
+        {
+            case TypeNode::Number:
+                return Value(this->constants[instruction.left]);
+            case TypeNode::Variable:
+                return value[instruction.left];
+            default:
+                return apply(instruction.type, registers[instruction.left], registers[instruction.right]);
+        }
+    }
+
+
+    template<typename Type>
+    template<typename Value>
+    Value Evaluator<Type>::apply(TypeNode type, const Value& left, const Value& right)
+    {
+        using std::pow;
+        using std::sin;
+        using std::cos;
+        using std::exp;
+        using std::log;
+
+        switch(type)
+        {
+            case TypeNode::Minus:
+                return -left;
+            case TypeNode::Addition:
+                return left + right;
+            case TypeNode::Subtraction:
+                return left - right;
+            case TypeNode::Multiplication:
+                return left * right;
+            case TypeNode::Division:
+                if(isZero(right))
+                {
+                    throw std::invalid_argument("Division by zero");
+                }
+                return left / right;
+            case TypeNode::Power:
+                return pow(left, right);
+            case TypeNode::Sin:
+                return sin(left);
+            case TypeNode::Cos:
+                return cos(left);
+            case TypeNode::Exp:
+                return exp(left);
+            case TypeNode::Ln:
+                if(isZero(left))
+                {
+                    throw std::invalid_argument("Logarithm from zero");
+                }
+                return log(left);
+            default:
+                throw std::invalid_argument("Unknown node type");
+        }
+    }
+
+
+    template<typename Type>
+    template<typename Value>
+    std::vector<Value> Evaluator<Type>::backward(const std::vector<Value>& tape, std::vector<Value> adjoint) const
+    {
+        using std::pow;
+        using std::sin;
+        using std::cos;
+        using std::log;
+
+        std::vector<Value> result(this->variables.size());
+        for(std::size_t i = this->program.size(); i-- > 0;)
+        {
+            const Value bar = adjoint[i];
+            if(bar == Value{})
+            {
+                continue;
+            }
+
+            const Instruction& instruction = this->program[i];
+            const std::uint32_t left = instruction.left;
+            const std::uint32_t right = instruction.right;
+            switch(instruction.type)
+            {
+                case TypeNode::Number:
+                    break;
+                case TypeNode::Variable:
+                    result[left] += bar;
+                    break;
+                case TypeNode::Minus:
+                    adjoint[left] -= bar;
+                    break;
+                case TypeNode::Addition:
+                    adjoint[left] += bar;
+                    adjoint[right] += bar;
+                    break;
+                case TypeNode::Subtraction:
+                    adjoint[left] += bar;
+                    adjoint[right] -= bar;
+                    break;
+                // (u * v)' = u' * v + u * v'
+                case TypeNode::Multiplication:
+                    adjoint[left] += bar * tape[right];
+                    adjoint[right] += bar * tape[left];
+                    break;
+                // (u / v)' = u' / v - v' * (u / v) / v
+                case TypeNode::Division:
+                    adjoint[left] += bar / tape[right];
+                    adjoint[right] -= bar * tape[i] / tape[right];
+                    break;
+                // (u^v)' = v * u^(v - 1) * u' + ln(u) * u^v * v'
+                case TypeNode::Power:
+                    adjoint[left] += bar * tape[right] * pow(tape[left], tape[right] - Value(getNumber<Type>(1.0)));
+                    if(!isZero(tape[i]) && this->program[right].type != TypeNode::Number)
+                    {
+                        adjoint[right] += bar * log(tape[left]) * tape[i];
+                    }
+                    break;
+                // sin(u)' = cos(u) * u'
+                case TypeNode::Sin:
+                    adjoint[left] += bar * cos(tape[left]);
+                    break;
+                // cos(u)' = -sin(u) * u'
+                case TypeNode::Cos:
+                    adjoint[left] -= bar * sin(tape[left]);
+                    break;
+                // exp(u)' = exp(u) * u'
+                case TypeNode::Exp:
+                    adjoint[left] += bar * tape[i];
+                    break;
+                // ln(u)' = u' / u
+                case TypeNode::Ln:
+                    adjoint[left] += bar / tape[left];
+                    break;
+            }
+        }
+        return result;
+    }
+} // Math
+
+
+#endif // EVALUATOR_HPP
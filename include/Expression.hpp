@@ -2,11 +2,24 @@
 #define EXPRESSION_HPP
 
 
+#include <iterator>
 #include <utility>
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
+#include <vector>
 
 #include "Parser.hpp"
+#include "Dag.hpp"
+#include "Evaluator.hpp"
+#include "Adjoint.hpp"
+#include "Dual.hpp"
+#include "Taylor.hpp"
+#include "Incremental.hpp"
+#include "Tape.hpp"
+#include "SimplifyCache.hpp"
+#include "TaskPool.hpp"
 #include "Nodes/Node.hpp"
 #include "Nodes/Number.hpp"
 #include "Nodes/Minus.hpp"
@@ -27,24 +40,46 @@ namespace Math
     class Expression;
 
     template<typename Type>
-    Expression<Type> pow(const Expression<Type>& first, const Expression<Type>& second);
+    class System;
 
+    // The arguments are taken by value, a temporary is moved into the result instead of copied
     template<typename Type>
-    Expression<Type> sin(const Expression<Type>& expression);
+    Expression<Type> pow(Expression<Type> first, Expression<Type> second);
+
+    template<typename Type>
+    Expression<Type> sin(Expression<Type> expression);
+
+
+    template<typename Type>
+    Expression<Type> cos(Expression<Type> expression);
 
 
     template<typename Type>
-    Expression<Type> cos(const Expression<Type>& expression);
+    Expression<Type> exp(Expression<Type> expression);
 
 
     template<typename Type>
-    Expression<Type> exp(const Expression<Type>& expression);
+    Expression<Type> ln(Expression<Type> expression);
 
 
+    // Balanced trees of depth log(n) instead of the left-deep chain of a loop with operator+,
+    // an empty range gives 0 for the sum and 1 for the product
     template<typename Type>
-    Expression<Type> ln(const Expression<Type>& expression);
+    Expression<Type> sum(std::vector<Expression<Type>> terms);
+
+    template<typename Iterator>
+    auto sum(Iterator begin, Iterator end);
+
+
+    template<typename Type>
+    Expression<Type> product(std::vector<Expression<Type>> factors);
+
+    template<typename Iterator>
+    auto product(Iterator begin, Iterator end);
     
 
+    // The const members only read the tree, so one expression can be used
+    // by several threads at once without a copy per thread
     template<typename Type>
     class Expression
     {
@@ -53,35 +88,83 @@ namespace Math
         explicit Expression(Type number);
         explicit Expression(const std::string& expression);
         explicit Expression(const std::unique_ptr<Node<Type>>& node);
+        explicit Expression(std::unique_ptr<Node<Type>>&& node);
+        explicit Expression(const Tape<Type>& tape);
 
         ~Expression() = default;
-        Expression(Expression& expression);
+        Expression(const Expression& expression);
         Expression(Expression&& expression) noexcept = default;
         Expression& operator=(const Expression& expression);
         Expression& operator=(Expression&& expression) noexcept = default;
 
-        Expression operator-();
-        Expression operator+(const Expression& other);
-        Expression operator-(const Expression& other);
-        Expression operator*(const Expression& other);
-        Expression operator/(const Expression& other);
-        Expression operator^(const Expression& other);
-
-        friend Expression pow<>(const Expression& first, const Expression& second);
-        friend Expression sin<>(const Expression& expression);
-        friend Expression cos<>(const Expression& expression);
-        friend Expression exp<>(const Expression& expression);
-        friend Expression ln<>(const Expression& expression);
+        // An rvalue operand gives its tree to the result, so e = std::move(e) + term
+        // and e += term do not copy e and a sum of n terms is built in O(n)
+        Expression operator-() const&;
+        Expression operator-() &&;
+        Expression operator+(Expression other) const&;
+        Expression operator+(Expression other) &&;
+        Expression operator-(Expression other) const&;
+        Expression operator-(Expression other) &&;
+        Expression operator*(Expression other) const&;
+        Expression operator*(Expression other) &&;
+        Expression operator/(Expression other) const&;
+        Expression operator/(Expression other) &&;
+        Expression operator^(Expression other) const&;
+        Expression operator^(Expression other) &&;
+
+        Expression& operator+=(Expression other);
+        Expression& operator-=(Expression other);
+        Expression& operator*=(Expression other);
+        Expression& operator/=(Expression other);
+
+        friend Expression pow<>(Expression first, Expression second);
+        friend Expression sin<>(Expression expression);
+        friend Expression cos<>(Expression expression);
+        friend Expression exp<>(Expression expression);
+        friend Expression ln<>(Expression expression);
+        friend class System<Type>;
 
         [[nodiscard]] std::string toString() const;
 
-        Expression substitute(const std::string& variable, const Expression& expression);
+        [[nodiscard]] std::set<std::string> freeVariables() const;
+
+        Expression substitute(const std::string& variable, const Expression& expression) const;
+        Expression substitute(const std::map<std::string, Expression>& substitutions) const;
+
+        Type calculate(const std::vector<std::string>& variable, const std::vector<Type>& value) const;
+
+        // All orders are taken in one Dag, the result is expanded once and every shared
+        // subexpression of it simplified once
+        Expression differentiate(const std::string& variable="x", int number=1) const;
+
+        // Same derivative without expanding it, subexpressions shared between the orders stay shared
+        [[nodiscard]] Tape<Type> derivative(const std::string& variable="x", int number=1) const;
 
-        Type calculate(const std::vector<std::string>& variable, const std::vector<Type>& value);
+        // Binds the given variables and folds what becomes constant, the rest is kept as is
+        Expression specialize(const std::map<std::string, Type>& bindings) const;
+        Evaluator<Type> compileSpecialized(const std::map<std::string, Type>& bindings) const;
 
-        Expression differentiate(const std::string& variable="x", int number=1);
+        std::vector<Expression> gradient(const std::vector<std::string>& variables) const;
 
-        Expression simplify();
+        Evaluator<Type> compileGradient(const std::vector<std::string>& variables) const;
+
+        Adjoint<Type> adjoint() const;
+
+        Taylor<Type> taylor() const;
+
+        Incremental<Type> incremental() const;
+
+        // Flat post-order copy of the tree
+        [[nodiscard]] Tape<Type> tape() const;
+
+        // One program for all the expressions, shared subexpressions are evaluated once
+        static Evaluator<Type> compile(const std::vector<Expression>& expressions);
+
+        // Uses SimplifyCache<Type>::global() while it is enabled
+        Expression simplify() const;
+
+        // Same result, large independent subtrees are simplified on the threads of pool
+        Expression simplify(TaskPool& pool) const;
 
     private:
         std::unique_ptr<Node<Type>> root;
@@ -94,7 +177,7 @@ namespace Math
 namespace Math
 {
     template<typename Type>
-    Expression<Type>::Expression(Expression &expression)
+    Expression<Type>::Expression(const Expression& expression)
     {
         this->root = expression.root->makeCopy();
     }
@@ -107,6 +190,20 @@ namespace Math
     }
 
 
+    template<typename Type>
+    Expression<Type>::Expression(std::unique_ptr<Node<Type>>&& node)
+    {
+        this->root = std::move(node);
+    }
+
+
+    template<typename Type>
+    Expression<Type>::Expression(const Tape<Type>& tape)
+    {
+        this->root = tape.toNode();
+    }
+
+
     template<typename Type>
     Expression<Type>& Expression<Type>::operator=(const Expression &expression)
     {
@@ -130,7 +227,7 @@ namespace Math
 
 
     template<typename Type>
-    Expression<Type> Expression<Type>::operator-()
+    Expression<Type> Expression<Type>::operator-() const&
     {
         Expression newExpression;
         newExpression.root = std::make_unique<Minus<Type>>(this->root);
@@ -139,95 +236,242 @@ namespace Math
 
 
     template<typename Type>
-    Expression<Type> Expression<Type>::operator+(const Expression &other)
+    Expression<Type> Expression<Type>::operator-() &&
+    {
+        Expression newExpression;
+        newExpression.root = std::make_unique<Minus<Type>>(std::move(this->root));
+        return newExpression;
+    }
+
+
+    template<typename Type>
+    Expression<Type> Expression<Type>::operator+(Expression other) const&
+    {
+        Expression newExpression;
+        newExpression.root = std::make_unique<Addition<Type>>(this->root->makeCopy(), std::move(other.root));
+        return newExpression;
+    }
+
+
+    template<typename Type>
+    Expression<Type> Expression<Type>::operator+(Expression other) &&
+    {
+        Expression newExpression;
+        newExpression.root = std::make_unique<Addition<Type>>(std::move(this->root), std::move(other.root));
+        return newExpression;
+    }
+
+
+    template<typename Type>
+    Expression<Type> Expression<Type>::operator-(Expression other) const&
     {
         Expression newExpression;
-        newExpression.root = std::make_unique<Addition<Type>>(this->root, other.root);
+        newExpression.root = std::make_unique<Subtraction<Type>>(this->root->makeCopy(), std::move(other.root));
         return newExpression;
     }
 
 
     template<typename Type>
-    Expression<Type> Expression<Type>::operator-(const Expression &other)
+    Expression<Type> Expression<Type>::operator-(Expression other) &&
     {
         Expression newExpression;
-        newExpression.root = std::make_unique<Subtraction<Type>>(this->root, other.root);
+        newExpression.root = std::make_unique<Subtraction<Type>>(std::move(this->root), std::move(other.root));
         return newExpression;
     }
 
 
     template<typename Type>
-    Expression<Type> Expression<Type>::operator*(const Expression &other)
+    Expression<Type> Expression<Type>::operator*(Expression other) const&
     {
         Expression newExpression;
-        newExpression.root = std::make_unique<Multiplication<Type>>(this->root, other.root);
+        newExpression.root = std::make_unique<Multiplication<Type>>(this->root->makeCopy(), std::move(other.root));
         return newExpression;
     }
 
 
     template<typename Type>
-    Expression<Type> Expression<Type>::operator/(const Expression &other)
+    Expression<Type> Expression<Type>::operator*(Expression other) &&
     {
         Expression newExpression;
-        newExpression.root = std::make_unique<Division<Type>>(this->root, other.root);
+        newExpression.root = std::make_unique<Multiplication<Type>>(std::move(this->root), std::move(other.root));
         return newExpression;
     }
 
 
     template<typename Type>
-    Expression<Type> Expression<Type>::operator^(const Expression &other)
+    Expression<Type> Expression<Type>::operator/(Expression other) const&
     {
         Expression newExpression;
-        newExpression.root = std::make_unique<Power<Type>>(this->root, other.root);
+        newExpression.root = std::make_unique<Division<Type>>(this->root->makeCopy(), std::move(other.root));
         return newExpression;
     }
 
 
     template<typename Type>
-    Expression<Type> pow(const Expression<Type>& first, const Expression<Type>& second)
+    Expression<Type> Expression<Type>::operator/(Expression other) &&
+    {
+        Expression newExpression;
+        newExpression.root = std::make_unique<Division<Type>>(std::move(this->root), std::move(other.root));
+        return newExpression;
+    }
+
+
+    template<typename Type>
+    Expression<Type> Expression<Type>::operator^(Expression other) const&
+    {
+        Expression newExpression;
+        newExpression.root = std::make_unique<Power<Type>>(this->root->makeCopy(), std::move(other.root));
+        return newExpression;
+    }
+
+
+    template<typename Type>
+    Expression<Type> Expression<Type>::operator^(Expression other) &&
+    {
+        Expression newExpression;
+        newExpression.root = std::make_unique<Power<Type>>(std::move(this->root), std::move(other.root));
+        return newExpression;
+    }
+
+
+    template<typename Type>
+    Expression<Type>& Expression<Type>::operator+=(Expression other)
+    {
+        this->root = std::make_unique<Addition<Type>>(std::move(this->root), std::move(other.root));
+        return *this;
+    }
+
+
+    template<typename Type>
+    Expression<Type>& Expression<Type>::operator-=(Expression other)
+    {
+        this->root = std::make_unique<Subtraction<Type>>(std::move(this->root), std::move(other.root));
+        return *this;
+    }
+
+
+    template<typename Type>
+    Expression<Type>& Expression<Type>::operator*=(Expression other)
+    {
+        this->root = std::make_unique<Multiplication<Type>>(std::move(this->root), std::move(other.root));
+        return *this;
+    }
+
+
+    template<typename Type>
+    Expression<Type>& Expression<Type>::operator/=(Expression other)
+    {
+        this->root = std::make_unique<Division<Type>>(std::move(this->root), std::move(other.root));
+        return *this;
+    }
+
+
+    template<typename Type>
+    Expression<Type> pow(Expression<Type> first, Expression<Type> second)
     {
         Expression<Type> newExpression;
-        newExpression.root = std::make_unique<Power<Type>>(first.root, second.root);
+        newExpression.root = std::make_unique<Power<Type>>(std::move(first.root), std::move(second.root));
         return newExpression;
     }
 
 
     template<typename Type>
-    Expression<Type> sin(const Expression<Type>& expression)
+    Expression<Type> sin(Expression<Type> expression)
     {
         Expression<Type> newExpression;
-        newExpression.root = std::make_unique<Sin<Type>>(expression.root);
+        newExpression.root = std::make_unique<Sin<Type>>(std::move(expression.root));
         return newExpression;
     }
 
 
     template<typename Type>
-    Expression<Type> cos(const Expression<Type>& expression)
+    Expression<Type> cos(Expression<Type> expression)
     {
         Expression<Type> newExpression;
-        newExpression.root = std::make_unique<Cos<Type>>(expression.root);
+        newExpression.root = std::make_unique<Cos<Type>>(std::move(expression.root));
         return newExpression;
     }
 
 
     template<typename Type>
-    Expression<Type> exp(const Expression<Type>& expression)
+    Expression<Type> exp(Expression<Type> expression)
     {
         Expression<Type> newExpression;
-        newExpression.root = std::make_unique<Exp<Type>>(expression.root);
+        newExpression.root = std::make_unique<Exp<Type>>(std::move(expression.root));
         return newExpression;
     }
 
 
     template<typename Type>
-    Expression<Type> ln(const Expression<Type>& expression)
+    Expression<Type> ln(Expression<Type> expression)
     {
         Expression<Type> newExpression;
-        newExpression.root = std::make_unique<Ln<Type>>(expression.root);
+        newExpression.root = std::make_unique<Ln<Type>>(std::move(expression.root));
         return newExpression;
     }
 
 
+    // Every pass combines neighbours pairwise and halves the number of operands
+    template<typename Type, typename Operation>
+    Expression<Type> balance(std::vector<Expression<Type>> operands, Operation operation)
+    {
+        while(operands.size() > 1)
+        {
+            const std::size_t half = (operands.size() + 1) / 2;
+            for(std::size_t i = 0; i + 1 < operands.size(); i += 2)
+            {
+                operands[i / 2] = operation(std::move(operands[i]), std::move(operands[i + 1]));
+            }
+            if(operands.size() % 2 == 1)
+            {
+                operands[half - 1] = std::move(operands.back());
+            }
+            operands.resize(half);
+        }
+        return std::move(operands.front());
+    }
+
+
+    template<typename Type>
+    Expression<Type> sum(std::vector<Expression<Type>> terms)
+    {
+        if(terms.empty())
+        {
+            return Expression<Type>(Type{});
+        }
+        return balance(std::move(terms), [](Expression<Type>&& left, Expression<Type>&& right) {
+            return std::move(left) + std::move(right);
+        });
+    }
+
+
+    template<typename Iterator>
+    auto sum(Iterator begin, Iterator end)
+    {
+        return sum(std::vector<typename std::iterator_traits<Iterator>::value_type>(begin, end));
+    }
+
+
+    template<typename Type>
+    Expression<Type> product(std::vector<Expression<Type>> factors)
+    {
+        if(factors.empty())
+        {
+            return Expression<Type>(Type(1));
+        }
+        return balance(std::move(factors), [](Expression<Type>&& left, Expression<Type>&& right) {
+            return std::move(left) * std::move(right);
+        });
+    }
+
+
+    template<typename Iterator>
+    auto product(Iterator begin, Iterator end)
+    {
+        return product(std::vector<typename std::iterator_traits<Iterator>::value_type>(begin, end));
+    }
+
+
     template<typename Type>
     std::string Expression<Type>::toString() const
     {
@@ -236,39 +480,193 @@ namespace Math
 
 
     template<typename Type>
-    Expression<Type> Expression<Type>::substitute(const std::string& variable, const Expression& expression)
+    std::set<std::string> Expression<Type>::freeVariables() const
     {
-        Expression newExpression(*this);
-        newExpression.root = newExpression.root->substitute(variable, expression.root)->simplify();
+        std::set<std::string> variables;
+        for(const std::size_t id : this->root->getVariables().getIds())
+        {
+            variables.insert(variableName(id));
+        }
+        return variables;
+    }
+
+
+    template<typename Type>
+    Expression<Type> Expression<Type>::substitute(const std::string& variable, const Expression& expression) const
+    {
+        Substitution<Type> substitution;
+        std::size_t id = internVariable(variable);
+        substitution.variables.insert(id);
+        substitution.expressions.emplace(id, expression.root.get());
+
+        Expression newExpression;
+        newExpression.root = this->root->substitute(substitution)->simplify();
         return newExpression;
     }
 
 
     template<typename Type>
-    Type Expression<Type>::calculate(const std::vector<std::string>& variable, const std::vector<Type>& value)
+    Expression<Type> Expression<Type>::substitute(const std::map<std::string, Expression>& substitutions) const
+    {
+        Substitution<Type> substitution;
+        for(const auto& [variable, expression] : substitutions)
+        {
+            std::size_t id = internVariable(variable);
+            substitution.variables.insert(id);
+            substitution.expressions.emplace(id, expression.root.get());
+        }
+
+        Expression newExpression;
+        newExpression.root = this->root->substitute(substitution)->simplify();
+        return newExpression;
+    }
+
+
+    template<typename Type>
+    Type Expression<Type>::calculate(const std::vector<std::string>& variable, const std::vector<Type>& value) const
     {
         return this->root->calculate(variable, value);
     }
 
 
     template<typename Type>
-    Expression<Type> Expression<Type>::simplify()
+    Expression<Type> Expression<Type>::simplify() const
+    {
+        SimplifyCache<Type>& cache = SimplifyCache<Type>::global();
+
+        Expression newExpression;
+        newExpression.root = cache.isEnabled() ? this->root->simplify(cache) : this->root->simplify();
+        return newExpression;
+    }
+
+
+    template<typename Type>
+    Expression<Type> Expression<Type>::simplify(TaskPool& pool) const
     {
-        Expression newExpression(*this);
-        newExpression.root = newExpression.root->simplify();
+        Expression newExpression;
+        newExpression.root = this->root->simplify(pool);
         return newExpression;
     }
 
 
     template<typename Type>
-    Expression<Type> Expression<Type>::differentiate(const std::string &variable, int number)
+    Expression<Type> Expression<Type>::differentiate(const std::string &variable, int number) const
+    {
+        Dag<Type> dag;
+        auto index = dag.differentiate(dag.add(this->simplify().root), variable, number);
+
+        Expression derivative;
+        derivative.root = dag.toTape(index).simplify();
+        return derivative;
+    }
+
+
+    template<typename Type>
+    Tape<Type> Expression<Type>::derivative(const std::string& variable, int number) const
+    {
+        Dag<Type> dag;
+        return dag.toTape(dag.differentiate(dag.add(this->simplify().root), variable, number));
+    }
+
+
+    template<typename Type>
+    Expression<Type> Expression<Type>::specialize(const std::map<std::string, Type>& bindings) const
     {
-        Expression derivative(*this);
-        for(int i = 0; i < number; i++)
+        Dag<Type> dag;
+        auto index = dag.specialize(dag.add(this->root), bindings);
+
+        Expression result;
+        result.root = dag.toNode(index);
+        return result;
+    }
+
+
+    template<typename Type>
+    Evaluator<Type> Expression<Type>::compileSpecialized(const std::map<std::string, Type>& bindings) const
+    {
+        Dag<Type> dag;
+        auto index = dag.specialize(dag.add(this->root, true), bindings);
+        return Evaluator<Type>(dag, {dag.optimize(index)});
+    }
+
+
+    template<typename Type>
+    std::vector<Expression<Type>> Expression<Type>::gradient(const std::vector<std::string>& variables) const
+    {
+        Dag<Type> dag;
+        auto index = dag.add(this->root->simplify());
+
+        std::vector<Expression> gradient(variables.size());
+        for(std::size_t i = 0; i < variables.size(); i++)
+        {
+            gradient[i].root = dag.toNode(dag.differentiate(index, variables[i]))->simplify();
+        }
+        return gradient;
+    }
+
+
+    template<typename Type>
+    Evaluator<Type> Expression<Type>::compileGradient(const std::vector<std::string>& variables) const
+    {
+        Dag<Type> dag;
+        std::vector<std::uint32_t> outputs {dag.add(this->root, true)};
+        for(const std::string& variable : variables)
+        {
+            outputs.push_back(dag.differentiate(outputs.front(), variable));
+        }
+        for(std::uint32_t& output : outputs)
+        {
+            output = dag.optimize(output);
+        }
+        return Evaluator<Type>(dag, outputs);
+    }
+
+
+    template<typename Type>
+    Adjoint<Type> Expression<Type>::adjoint() const
+    {
+        Dag<Type> dag;
+        auto index = dag.add(this->root, true);
+        return Adjoint<Type>(dag, index);
+    }
+
+
+    template<typename Type>
+    Evaluator<Type> Expression<Type>::compile(const std::vector<Expression>& expressions)
+    {
+        Dag<Type> dag;
+        std::vector<std::uint32_t> outputs;
+        outputs.reserve(expressions.size());
+        for(const Expression& expression : expressions)
         {
-            derivative.root = derivative.root->simplify()->differentiate(variable);
+            outputs.push_back(dag.optimize(dag.add(expression.root, true)));
         }
-        return derivative.simplify();
+        return Evaluator<Type>(dag, outputs);
+    }
+
+
+    template<typename Type>
+    Taylor<Type> Expression<Type>::taylor() const
+    {
+        Dag<Type> dag;
+        auto index = dag.add(this->root, true);
+        return Taylor<Type>(dag, index);
+    }
+
+
+    template<typename Type>
+    Incremental<Type> Expression<Type>::incremental() const
+    {
+        Dag<Type> dag;
+        auto index = dag.add(this->root, true);
+        return Incremental<Type>(dag, index);
+    }
+
+
+    template<typename Type>
+    Tape<Type> Expression<Type>::tape() const
+    {
+        return Tape<Type>(this->root);
     }
 
 
@@ -278,6 +676,86 @@ namespace Math
         ostream << expression.toString();
         return ostream;
     }
+
+
+    template<typename Type>
+    std::unique_ptr<Node<Type>> Node<Type>::simplify(TaskPool& pool, std::size_t threshold) const
+    {
+        threshold = std::max<std::size_t>(threshold, 1);
+
+        // Sizes of the subtrees large enough to matter, operands first
+        std::unordered_map<const Node*, std::size_t> sizes;
+        const std::size_t total = this->fold<std::size_t>(
+            [](const Node&) { return true; },
+            [&sizes, threshold](const Node& node, std::size_t* operands) {
+                std::size_t size = 1;
+                for(std::size_t i = 0; i < node.countChildren(); i++)
+                {
+                    size += operands[i];
+                }
+                if(size >= threshold)
+                {
+                    sizes.emplace(&node, size);
+                }
+                return size;
+            }
+        );
+
+        // Every node is simplified from its simplified operands alone, so the subtrees
+        // of at most grain nodes below larger ones are independent tasks. A few per
+        // worker keep the workers busy when the tasks differ in size.
+        const std::size_t grain = std::max(threshold, total / (4 * pool.size()));
+        if(total <= grain)
+        {
+            return this->simplify();
+        }
+
+        std::vector<const Node*> roots;
+        std::vector<const Node*> stack {this};
+        while(!stack.empty())
+        {
+            const Node* node = stack.back();
+            stack.pop_back();
+            auto iter = sizes.find(node);
+            if(iter == sizes.end())
+            {
+                continue;
+            }
+            if(iter->second > grain)
+            {
+                for(std::size_t i = 0; i < node->countChildren(); i++)
+                {
+                    stack.push_back(node->getChild(i).get());
+                }
+                continue;
+            }
+            roots.push_back(node);
+        }
+
+        std::vector<std::unique_ptr<Node>> results(roots.size());
+        std::vector<std::function<void()>> tasks;
+        std::unordered_map<const Node*, std::size_t> found;
+        for(std::size_t k = 0; k < roots.size(); k++)
+        {
+            tasks.emplace_back([&roots, &results, k]() { results[k] = roots[k]->simplify(); });
+            found.emplace(roots[k], k);
+        }
+        pool.run(tasks);
+
+        // The rest of the tree above the tasks, as simplify does it
+        return this->fold<std::unique_ptr<Node>>(
+            [&found](const Node& node) { return !found.contains(&node); },
+            [&found, &results](const Node& node, std::unique_ptr<Node>* operands) {
+                auto iter = found.find(&node);
+                if(iter != found.end())
+                {
+                    return std::move(results[iter->second]);
+                }
+                std::unique_ptr<Node> copy = visit(node, [operands](const auto& self) { return self.make(operands); });
+                return visit(*copy, [](auto& self) { return self.rewrite(); });
+            }
+        );
+    }
 } // Math
 
 
@@ -0,0 +1,204 @@
+#ifndef INCREMENTAL_HPP
+#define INCREMENTAL_HPP
+
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Dag.hpp"
+#include "Evaluator.hpp"
+#include "VariableSet.hpp"
+
+
+namespace Math
+{
+    // Stateful evaluator that keeps the value of every instruction.
+    // After a variable changes only the instructions depending on it are recomputed.
+    template<typename Type>
+    class Incremental
+    {
+    public:
+        Incremental(const Dag<Type>& dag, std::uint32_t output);
+
+        [[nodiscard]] const std::vector<std::string>& getVariables() const;
+
+        void set(const std::string& variable, const Type& value);
+        void set(const std::vector<std::string>& variable, const std::vector<Type>& value);
+
+        Type calculate();
+
+        // Instructions recomputed by the last calculate and since construction
+        [[nodiscard]] std::size_t getRecomputed() const;
+        [[nodiscard]] std::size_t getTotalRecomputed() const;
+
+    private:
+        Evaluator<Type> evaluator;
+
+        // Instructions depending on every variable slot, in program order
+        std::vector<std::vector<std::uint32_t>> dependents;
+
+        std::vector<Type> registers;
+        std::vector<Type> slots;
+        std::vector<bool> assigned;
+        std::vector<bool> dirty;
+        std::vector<std::uint32_t> pending;
+
+        std::size_t recomputed = 0;
+        std::size_t totalRecomputed = 0;
+    };
+} // Math
+
+
+
+// Implementation
+namespace Math
+{
+    template<typename Type>
+    Incremental<Type>::Incremental(const Dag<Type>& dag, std::uint32_t output)
+        : evaluator(dag, {output})
+    {
+        const auto& program = this->evaluator.getProgram();
+        const std::size_t count = this->evaluator.getVariables().size();
+
+        std::vector<VariableSet> dependencies(program.size());
+        this->dependents.resize(count);
+        for(std::uint32_t i = 0; i < program.size(); i++)
+        {
+            const auto& instruction = program[i];
+            switch(instruction.type)
+            {
+                case TypeNode::Number:
+                    break;
+                case TypeNode::Variable:
+                    dependencies[i].insert(instruction.left);
+                    break;
+                case TypeNode::Minus:
+                case TypeNode::Sin:
+                case TypeNode::Cos:
+                case TypeNode::Exp:
+                case TypeNode::Ln:
+                    dependencies[i] = dependencies[instruction.left];
+                    break;
+                default:
+                    dependencies[i] = dependencies[instruction.left];
+                    dependencies[i] |= dependencies[instruction.right];
+            }
+            for(const std::size_t slot : dependencies[i].getIds())
+            {
+                this->dependents[slot].push_back(i);
+            }
+        }
+
+        this->registers.resize(program.size());
+        this->slots.resize(count);
+        this->assigned.resize(count, false);
+        this->dirty.resize(program.size(), true);
+        this->pending.resize(program.size());
+        for(std::uint32_t i = 0; i < program.size(); i++)
+        {
+            this->pending[i] = i;
+        }
+    }
+
+
+    template<typename Type>
+    const std::vector<std::string>& Incremental<Type>::getVariables() const
+    {
+        return this->evaluator.getVariables();
+    }
+
+
+    template<typename Type>
+    void Incremental<Type>::set(const std::string& variable, const Type& value)
+    {
+        const auto& variables = this->evaluator.getVariables();
+        auto iter = std::find(variables.begin(), variables.end(), variable);
+        if(iter == variables.end())
+        {
+            return;
+        }
+
+        const std::size_t slot = iter - variables.begin();
+        if(this->assigned[slot] && this->slots[slot] == value)
+        {
+            return;
+        }
+        this->slots[slot] = value;
+        this->assigned[slot] = true;
+        for(const std::uint32_t i : this->dependents[slot])
+        {
+            if(!this->dirty[i])
+            {
+                this->dirty[i] = true;
+                this->pending.push_back(i);
+            }
+        }
+    }
+
+
+    template<typename Type>
+    void Incremental<Type>::set(const std::vector<std::string>& variable, const std::vector<Type>& value)
+    {
+        for(std::size_t i = 0; i < variable.size(); i++)
+        {
+            this->set(variable[i], value[i]);
+        }
+    }
+
+
+    template<typename Type>
+    Type Incremental<Type>::calculate()
+    {
+        const auto& variables = this->evaluator.getVariables();
+        for(std::size_t slot = 0; slot < variables.size(); slot++)
+        {
+            if(!this->assigned[slot])
+            {
+                throw std::invalid_argument("The variable \"" + variables[slot] + "\" has no value");
+            }
+        }
+
+        std::sort(this->pending.begin(), this->pending.end());
+        this->recomputed = 0;
+        for(std::size_t k = 0; k < this->pending.size(); k++)
+        {
+            const std::uint32_t i = this->pending[k];
+            try
+            {
+                this->registers[i] = this->evaluator.execute(i, this->registers, this->slots);
+            }
+            catch(...)
+            {
+                this->pending.erase(this->pending.begin(), this->pending.begin() + k);
+                this->totalRecomputed += this->recomputed;
+                throw;
+            }
+            this->dirty[i] = false;
+            this->recomputed++;
+        }
+        this->pending.clear();
+        this->totalRecomputed += this->recomputed;
+
+        return this->registers[this->evaluator.getOutputs().front()];
+    }
+
+
+    template<typename Type>
+    std::size_t Incremental<Type>::getRecomputed() const
+    {
+        return this->recomputed;
+    }
+
+
+    template<typename Type>
+    std::size_t Incremental<Type>::getTotalRecomputed() const
+    {
+        return this->totalRecomputed;
+    }
+} // Math
+
+
+#endif // INCREMENTAL_HPP
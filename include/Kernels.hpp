@@ -0,0 +1,371 @@
+#ifndef KERNELS_HPP
+#define KERNELS_HPP
+
+
+#include <bit>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace Math
+{
+    // sin and cos of the same argument with one argument reduction
+    template<typename Value>
+    void sincos(const Value& x, Value& s, Value& c);
+
+    void sincos(double x, double& s, double& c);
+
+    template<typename Type>
+    void sincos(const std::complex<Type>& x, std::complex<Type>& s, std::complex<Type>& c);
+
+    // Batch version, the main loop over double has no calls and no branches so it can be vectorized
+    template<typename Type>
+    void sincos(const Type* x, Type* s, Type* c, std::size_t count);
+
+    void sincos(const double* x, double* s, double* c, std::size_t count);
+
+
+    // Complex numbers stored as separate arrays of real and imaginary parts
+    template<typename Type>
+    struct SplitComplex
+    {
+        std::vector<Type> real;
+        std::vector<Type> imag;
+    };
+
+    template<typename Type>
+    SplitComplex<Type> toSplit(const std::vector<std::complex<Type>>& values);
+
+    template<typename Type>
+    std::vector<std::complex<Type>> fromSplit(const SplitComplex<Type>& values);
+
+    // Kernels over split arrays: x = a + ib, y = c + id, the result is u + iv.
+    // The outputs must not overlap the inputs, they also hold intermediate values.
+    template<typename Type>
+    void complexMultiply(const Type* a, const Type* b, const Type* c, const Type* d, Type* u, Type* v, std::size_t count);
+
+    template<typename Type>
+    void complexDivide(const Type* a, const Type* b, const Type* c, const Type* d, Type* u, Type* v, std::size_t count);
+
+    template<typename Type>
+    void complexExp(const Type* a, const Type* b, Type* u, Type* v, std::size_t count);
+
+    template<typename Type>
+    void complexLog(const Type* a, const Type* b, Type* u, Type* v, std::size_t count);
+
+    // sin(x) = su + i sv and cos(x) = cu + i cv
+    template<typename Type>
+    void complexSinCos(const Type* a, const Type* b, Type* su, Type* sv, Type* cu, Type* cv, std::size_t count);
+} // Math
+
+
+
+// Implementation
+namespace Math
+{
+    namespace Kernels
+    {
+        // The medium range reduction is exact while |x| stays below 2^19 pi/2
+        inline constexpr double reductionLimit = 1e5;
+
+        // pi/2 in pieces of 33 bits, each with the tail that follows it (fdlibm __ieee754_rem_pio2)
+        inline constexpr double twoOverPi = 6.36619772367581382433e-01;
+        inline constexpr double piOverTwo1 = 1.57079632673412561417e+00;
+        inline constexpr double piOverTwo1Tail = 6.07710050650619224932e-11;
+        inline constexpr double piOverTwo2 = 6.07710050630396597660e-11;
+        inline constexpr double piOverTwo2Tail = 2.02226624879595063154e-21;
+        inline constexpr double piOverTwo3 = 2.02226624871116645580e-21;
+        inline constexpr double piOverTwo3Tail = 8.47842766036889956997e-32;
+
+        // Adding and subtracting 1.5 * 2^52 rounds to the nearest integer
+        inline constexpr double rounding = 6755399441055744.0;
+
+        // Minimax polynomials on [-pi/4, pi/4] (fdlibm __kernel_sin and __kernel_cos)
+        inline constexpr double S1 = -1.66666666666666324348e-01;
+        inline constexpr double S2 = 8.33333333332248946124e-03;
+        inline constexpr double S3 = -1.98412698298579493134e-04;
+        inline constexpr double S4 = 2.75573137070700676789e-06;
+        inline constexpr double S5 = -2.50507602534068634195e-08;
+        inline constexpr double S6 = 1.58969099521155010221e-10;
+
+        inline constexpr double C1 = 4.16666666666666019037e-02;
+        inline constexpr double C2 = -1.38888888888741095749e-03;
+        inline constexpr double C3 = 2.48015872894767294178e-05;
+        inline constexpr double C4 = -2.75573143513906633035e-07;
+        inline constexpr double C5 = 2.08757232129817482790e-09;
+        inline constexpr double C6 = -1.13596475577881948265e-11;
+
+
+        inline int exponent(double x)
+        {
+            return static_cast<int>(std::bit_cast<std::uint64_t>(x) >> 52 & 0x7FF);
+        }
+
+
+        // x = n pi/2 + r - w with the first piece of pi/2 and its tail, y0 = r - w
+        inline double reduceOnce(double x, double& r, double& w, double& y0)
+        {
+            double n = (x * twoOverPi + rounding) - rounding;
+            r = x - n * piOverTwo1;
+            w = n * piOverTwo1Tail;
+            y0 = r - w;
+            return n;
+        }
+
+
+        // Near a multiple of pi/2 the first piece cancels and the next ones are needed
+        inline bool cancels(double x, double y0)
+        {
+            return exponent(x) - exponent(y0) > 16;
+        }
+
+
+        // x = n pi/2 + y0 + y1 with |y0 + y1| <= pi/4, requires |x| <= reductionLimit
+        inline double reduce(double x, double& y0, double& y1)
+        {
+            double r, w;
+            double n = reduceOnce(x, r, w, y0);
+            if(cancels(x, y0))
+            {
+                double t = r;
+                w = n * piOverTwo2;
+                r = t - w;
+                w = n * piOverTwo2Tail - ((t - r) - w);
+                y0 = r - w;
+                if(exponent(x) - exponent(y0) > 49)
+                {
+                    t = r;
+                    w = n * piOverTwo3;
+                    r = t - w;
+                    w = n * piOverTwo3Tail - ((t - r) - w);
+                    y0 = r - w;
+                }
+            }
+            y1 = (r - y0) - w;
+            return n;
+        }
+
+
+        // sin and cos of n pi/2 + y0 + y1, the tail y1 corrects the polynomials to first order
+        inline void sincos(double n, double y0, double y1, double& s, double& c)
+        {
+            double z = y0 * y0;
+            double v = z * y0;
+            double p = S2 + z * (S3 + z * (S4 + z * (S5 + z * S6)));
+            double sine = y0 - ((z * (0.5 * y1 - v * p) - y1) - v * S1);
+
+            double half = 0.5 * z;
+            double w = 1.0 - half;
+            double q = z * z * (C1 + z * (C2 + z * (C3 + z * (C4 + z * (C5 + z * C6)))));
+            double cosine = w + (((1.0 - w) - half) + (q - y0 * y1));
+
+            // sin(r + q pi/2) and cos(r + q pi/2) by the quadrant q
+            int quadrant = static_cast<int>(n) & 3;
+            double first = (quadrant & 1) ? cosine : sine;
+            double second = (quadrant & 1) ? sine : cosine;
+            s = (quadrant & 2) ? -first : first;
+            c = ((quadrant + 1) & 2) ? -second : second;
+        }
+
+
+        // Requires |x| <= reductionLimit
+        inline void sincos(double x, double& s, double& c)
+        {
+            double y0, y1;
+            double n = reduce(x, y0, y1);
+            sincos(n, y0, y1, s, c);
+        }
+    } // Kernels
+
+
+    template<typename Value>
+    void sincos(const Value& x, Value& s, Value& c)
+    {
+        using std::sin;
+        using std::cos;
+
+        s = sin(x);
+        c = cos(x);
+    }
+
+
+    inline void sincos(double x, double& s, double& c)
+    {
+        if(std::abs(x) <= Kernels::reductionLimit)
+        {
+            Kernels::sincos(x, s, c);
+            return;
+        }
+        s = std::sin(x);
+        c = std::cos(x);
+    }
+
+
+    // sin(a + ib) = sin(a) cosh(b) + i cos(a) sinh(b)
+    // cos(a + ib) = cos(a) cosh(b) - i sin(a) sinh(b)
+    template<typename Type>
+    void sincos(const std::complex<Type>& x, std::complex<Type>& s, std::complex<Type>& c)
+    {
+        Type sine, cosine;
+        sincos(x.real(), sine, cosine);
+        Type sinh = std::sinh(x.imag());
+        Type cosh = std::cosh(x.imag());
+        s = std::complex<Type>(sine * cosh, cosine * sinh);
+        c = std::complex<Type>(cosine * cosh, -sine * sinh);
+    }
+
+
+    template<typename Type>
+    void sincos(const Type* x, Type* s, Type* c, std::size_t count)
+    {
+        for(std::size_t k = 0; k < count; k++)
+        {
+            sincos(x[k], s[k], c[k]);
+        }
+    }
+
+
+    inline void sincos(const double* x, double* s, double* c, std::size_t count)
+    {
+        bool reducible = true;
+        for(std::size_t k = 0; k < count; k++)
+        {
+            reducible &= std::abs(x[k]) <= Kernels::reductionLimit;
+        }
+        if(!reducible)
+        {
+            for(std::size_t k = 0; k < count; k++)
+            {
+                sincos(x[k], s[k], c[k]);
+            }
+            return;
+        }
+
+        // The first piece of pi/2 is enough for almost every argument
+        for(std::size_t k = 0; k < count; k++)
+        {
+            double r, w, y0;
+            double n = Kernels::reduceOnce(x[k], r, w, y0);
+            Kernels::sincos(n, y0, (r - y0) - w, s[k], c[k]);
+        }
+        // The few close to a multiple of pi/2 are done again with the full reduction
+        for(std::size_t k = 0; k < count; k++)
+        {
+            double r, w, y0;
+            Kernels::reduceOnce(x[k], r, w, y0);
+            if(Kernels::cancels(x[k], y0))
+            {
+                Kernels::sincos(x[k], s[k], c[k]);
+            }
+        }
+    }
+
+
+    template<typename Type>
+    SplitComplex<Type> toSplit(const std::vector<std::complex<Type>>& values)
+    {
+        SplitComplex<Type> result {std::vector<Type>(values.size()), std::vector<Type>(values.size())};
+        for(std::size_t k = 0; k < values.size(); k++)
+        {
+            result.real[k] = values[k].real();
+            result.imag[k] = values[k].imag();
+        }
+        return result;
+    }
+
+
+    template<typename Type>
+    std::vector<std::complex<Type>> fromSplit(const SplitComplex<Type>& values)
+    {
+        std::vector<std::complex<Type>> result(values.real.size());
+        for(std::size_t k = 0; k < result.size(); k++)
+        {
+            result[k] = std::complex<Type>(values.real[k], values.imag[k]);
+        }
+        return result;
+    }
+
+
+    // (a + ib)(c + id) = (ac - bd) + i(ad + bc)
+    template<typename Type>
+    void complexMultiply(const Type* a, const Type* b, const Type* c, const Type* d, Type* u, Type* v, std::size_t count)
+    {
+        for(std::size_t k = 0; k < count; k++)
+        {
+            Type real = a[k] * c[k] - b[k] * d[k];
+            Type imag = a[k] * d[k] + b[k] * c[k];
+            u[k] = real;
+            v[k] = imag;
+        }
+    }
+
+
+    // Smith's algorithm, divides by the larger of |c| and |d| to avoid overflow
+    template<typename Type>
+    void complexDivide(const Type* a, const Type* b, const Type* c, const Type* d, Type* u, Type* v, std::size_t count)
+    {
+        for(std::size_t k = 0; k < count; k++)
+        {
+            bool wide = std::abs(c[k]) >= std::abs(d[k]);
+            Type ratio = wide ? d[k] / c[k] : c[k] / d[k];
+            Type denominator = wide ? c[k] + d[k] * ratio : c[k] * ratio + d[k];
+            Type real = wide ? a[k] + b[k] * ratio : a[k] * ratio + b[k];
+            Type imag = wide ? b[k] - a[k] * ratio : b[k] * ratio - a[k];
+            u[k] = real / denominator;
+            v[k] = imag / denominator;
+        }
+    }
+
+
+    // exp(a + ib) = exp(a) (cos(b) + i sin(b)), cos(b) and sin(b) go to u and v first
+    template<typename Type>
+    void complexExp(const Type* a, const Type* b, Type* u, Type* v, std::size_t count)
+    {
+        sincos(b, v, u, count);
+        for(std::size_t k = 0; k < count; k++)
+        {
+            Type modulus = std::exp(a[k]);
+            u[k] *= modulus;
+            v[k] *= modulus;
+        }
+    }
+
+
+    // ln(a + ib) = ln|a + ib| + i arg(a + ib)
+    template<typename Type>
+    void complexLog(const Type* a, const Type* b, Type* u, Type* v, std::size_t count)
+    {
+        for(std::size_t k = 0; k < count; k++)
+        {
+            Type real = std::log(std::hypot(a[k], b[k]));
+            Type imag = std::atan2(b[k], a[k]);
+            u[k] = real;
+            v[k] = imag;
+        }
+    }
+
+
+    // sin(a) and cos(a) go to su and cu first
+    template<typename Type>
+    void complexSinCos(const Type* a, const Type* b, Type* su, Type* sv, Type* cu, Type* cv, std::size_t count)
+    {
+        sincos(a, su, cu, count);
+        for(std::size_t k = 0; k < count; k++)
+        {
+            Type sine = su[k];
+            Type cosine = cu[k];
+            Type sinh = std::sinh(b[k]);
+            Type cosh = std::cosh(b[k]);
+            su[k] = sine * cosh;
+            sv[k] = cosine * sinh;
+            cu[k] = cosine * cosh;
+            cv[k] = -sine * sinh;
+        }
+    }
+} // Math
+
+
+#endif // KERNELS_HPP
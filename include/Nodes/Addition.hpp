@@ -11,26 +11,25 @@ namespace Math
     class Addition final : public Node<Type>
     {
     public:
+        static constexpr TypeNode kind = TypeNode::Addition;
+
         Addition(const Addition& addition);
         Addition(const std::unique_ptr<Node<Type>>& left, const std::unique_ptr<Node<Type>>& right);
+        Addition(std::unique_ptr<Node<Type>>&& left, std::unique_ptr<Node<Type>>&& right);
 
-        std::unique_ptr<Node<Type>> makeCopy() override;
-
-        Priority getPriority() override;
+        ~Addition() override;
 
-        TypeNode getType() override;
+        Priority getPriority() const;
 
-        bool equal(std::unique_ptr<Node<Type>>& ptr) override;
+        std::unique_ptr<Node<Type>> make(std::unique_ptr<Node<Type>>* operands) const;
 
-        std::string toString() override;
+        std::string format(std::string* operands) const;
 
-        std::unique_ptr<Node<Type>> substitute(const std::string& variable, const std::unique_ptr<Node<Type>>& expression) override;
+        Type evaluate(const Type* operands, const std::vector<std::string>& variable, const std::vector<Type>& value) const;
 
-        Type calculate(const std::vector<std::string>& variable, const std::vector<Type>& value) override;
+        std::unique_ptr<Node<Type>> derive(const std::string& variable, std::unique_ptr<Node<Type>>* derivatives) const;
 
-        std::unique_ptr<Node<Type>> differentiate(const std::string& variable) override;
-
-        std::unique_ptr<Node<Type>> simplify() override;
+        std::unique_ptr<Node<Type>> rewrite();
 
         std::unique_ptr<Node<Type>> left;
         std::unique_ptr<Node<Type>> right;
@@ -42,105 +41,97 @@ namespace Math
 {
     template<typename Type>
     Addition<Type>::Addition(const Addition& addition)
+        : Node<Type>(TypeNode::Addition)
     {
         this->left = addition.left->makeCopy();
         this->right = addition.right->makeCopy();
+        this->summarize();
     }
 
 
     template<typename Type>
     Addition<Type>::Addition(const std::unique_ptr<Node<Type>>& left, const std::unique_ptr<Node<Type>>& right)
+        : Node<Type>(TypeNode::Addition)
     {
         this->left = left->makeCopy();
         this->right = right->makeCopy();
+        this->summarize();
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Addition<Type>::makeCopy()
+    Addition<Type>::Addition(std::unique_ptr<Node<Type>>&& left, std::unique_ptr<Node<Type>>&& right)
+        : Node<Type>(TypeNode::Addition)
     {
-        return std::make_unique<Addition>(this->left, this->right);
+        this->left = std::move(left);
+        this->right = std::move(right);
+        this->summarize();
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Addition<Type>::substitute(const std::string& variable, const std::unique_ptr<Node<Type>>& expression)
+    Addition<Type>::~Addition()
     {
-        return std::make_unique<Addition>(this->left->substitute(variable, expression), this->right->substitute(variable, expression));
+        this->release();
     }
 
 
     template<typename Type>
-    Type Addition<Type>::calculate(const std::vector<std::string>& variable, const std::vector<Type>& value)
+    std::unique_ptr<Node<Type>> Addition<Type>::make(std::unique_ptr<Node<Type>>* operands) const
     {
-        return this->left->calculate(variable, value) + this->right->calculate(variable, value);
+        return std::make_unique<Addition>(std::move(operands[0]), std::move(operands[1]));
     }
 
 
     template<typename Type>
-    Priority Addition<Type>::getPriority()
+    Type Addition<Type>::evaluate(const Type* operands, const std::vector<std::string>& variable, const std::vector<Type>& value) const
     {
-        return Priority::Addition;
+        return operands[0] + operands[1];
     }
 
 
     template<typename Type>
-    TypeNode Addition<Type>::getType()
+    Priority Addition<Type>::getPriority() const
     {
-        return TypeNode::Addition;
-    }
-
-
-    template<typename Type>
-    bool Addition<Type>::equal(std::unique_ptr<Node<Type>>& ptr)
-    {
-        if(this->getType() == ptr->getType())
-        {
-            auto* addition = dynamic_cast<Addition*>(ptr.get());
-            return this->left->equal(addition->left) && this->right->equal(addition->right);
-        }
-        return false;
+        return Priority::Addition;
     }
 
 
     template<typename Type>
-    std::string Addition<Type>::toString()
+    std::string Addition<Type>::format(std::string* operands) const
     {
-        std::string left = this->left->toString();
-        std::string right = this->right->toString();
+        std::string left = std::move(operands[0]);
+        std::string right = std::move(operands[1]);
         if(right.front() == '-')
         {
-            return left + " + (" + right + ")";
+            return std::move(left) + " + (" + right + ")";
         }
-        return left + " + " + right;
+        return std::move(left) + " + " + right;
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type> > Addition<Type>::differentiate(const std::string &variable)
+    std::unique_ptr<Node<Type>> Addition<Type>::derive(const std::string& variable, std::unique_ptr<Node<Type>>* derivatives) const
     {
         return std::make_unique<Addition>(
-            this->left->differentiate(variable),
-            this->right->differentiate(variable)
+            std::move(derivatives[0]),
+            std::move(derivatives[1])
         );
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Addition<Type>::simplify()
+    std::unique_ptr<Node<Type>> Addition<Type>::rewrite()
     {
-        this->left = this->left->simplify();
-        this->right = this->right->simplify();
-
         // 0 + x = x
-        if(this->left->toString() == "0" || this->left->toString() == "-0")
+        if(this->left->printsAs("0") || this->left->printsAs("-0"))
         {
-            return this->right->makeCopy();
+            return std::move(this->right);
         }
         // x + 0 = x
-        if(this->right->toString() == "0" || this->right->toString() == "-0")
+        if(this->right->printsAs("0") || this->right->printsAs("-0"))
         {
-            return this->left->makeCopy();
+            return std::move(this->left);
         }
         // a + b = a + b
         if(this->left->getType() == TypeNode::Number && this->right->getType() == TypeNode::Number)
@@ -152,8 +143,8 @@ namespace Math
         if(this->left->getType() == TypeNode::Minus
            && this->right->getType() == TypeNode::Minus)
         {
-            auto* left = dynamic_cast<Minus<Type>*>(this->left.get());
-            auto* right = dynamic_cast<Minus<Type>*>(this->right.get());
+            auto* left = nodeCast<Minus<Type>>(this->left.get());
+            auto* right = nodeCast<Minus<Type>>(this->right.get());
             return std::make_unique<Minus<Type>>(
                 std::make_unique<Addition>(
                     left->argument,
@@ -163,7 +154,7 @@ namespace Math
         }
         if(this->left->getType() == TypeNode::Minus)
         {
-            auto* left = dynamic_cast<Minus<Type>*>(this->left.get());
+            auto* left = nodeCast<Minus<Type>>(this->left.get());
             // -x + y = y - x
             return std::make_unique<Subtraction<Type>>(
                 this->right,
@@ -172,7 +163,7 @@ namespace Math
         }
         if(this->right->getType() == TypeNode::Minus)
         {
-            auto* right = dynamic_cast<Minus<Type>*>(this->right.get());
+            auto* right = nodeCast<Minus<Type>>(this->right.get());
             // x + (-y) = x - y
             return std::make_unique<Subtraction<Type>>(
                 this->left,
@@ -194,14 +185,14 @@ namespace Math
            && this->right->getType() == TypeNode::Power)
         {
             std::unique_ptr<Node<Type>> two = std::make_unique<Number<Type>>(getNumber<Type>(2.0));
-            auto* left = dynamic_cast<Power<Type>*>(this->left.get());
-            auto* right = dynamic_cast<Power<Type>*>(this->right.get());
+            auto* left = nodeCast<Power<Type>>(this->left.get());
+            auto* right = nodeCast<Power<Type>>(this->right.get());
             if(left->right->equal(two) && right->right->equal(two))
             {
                 if(left->left->getType() == TypeNode::Sin && right->left->getType() == TypeNode::Cos)
                 {
-                    auto* sin = dynamic_cast<Sin<Type>*>(left->left.get());
-                    auto* cos = dynamic_cast<Cos<Type>*>(right->left.get());
+                    auto* sin = nodeCast<Sin<Type>>(left->left.get());
+                    auto* cos = nodeCast<Cos<Type>>(right->left.get());
                     if(sin->argument->equal(cos->argument))
                     {
                         return std::make_unique<Number<Type>>(getNumber<Type>(1.0));
@@ -209,8 +200,8 @@ namespace Math
                 }
                 if(left->left->getType() == TypeNode::Cos && right->left->getType() == TypeNode::Sin)
                 {
-                    auto* sin = dynamic_cast<Sin<Type>*>(right->left.get());
-                    auto* cos = dynamic_cast<Cos<Type>*>(left->left.get());
+                    auto* sin = nodeCast<Sin<Type>>(right->left.get());
+                    auto* cos = nodeCast<Cos<Type>>(left->left.get());
                     if(sin->argument->equal(cos->argument))
                     {
                         return std::make_unique<Number<Type>>(getNumber<Type>(1.0));
@@ -223,7 +214,7 @@ namespace Math
         {
             if(this->right->getType() == TypeNode::Addition)
             {
-                auto* right = dynamic_cast<Addition*>(this->right.get());
+                auto* right = nodeCast<Addition>(this->right.get());
                 // a + (b + x) = (a + b) + x
                 if(right->left->getType() == TypeNode::Number)
                 {
@@ -249,7 +240,7 @@ namespace Math
             }
             if(this->right->getType() == TypeNode::Subtraction)
             {
-                auto* right = dynamic_cast<Subtraction<Type>*>(this->right.get());
+                auto* right = nodeCast<Subtraction<Type>>(this->right.get());
                 // a + (b - x) = (a + b) - x
                 if(right->left->getType() == TypeNode::Number)
                 {
@@ -279,7 +270,7 @@ namespace Math
         {
             if(this->left->getType() == TypeNode::Addition)
             {
-                auto* left = dynamic_cast<Addition*>(this->left.get());
+                auto* left = nodeCast<Addition>(this->left.get());
                 // (a + x) + b = (a + b) + x
                 if(left->left->getType() == TypeNode::Number)
                 {
@@ -305,7 +296,7 @@ namespace Math
             }
             if(this->left->getType() == TypeNode::Subtraction)
             {
-                auto* left = dynamic_cast<Subtraction<Type>*>(this->left.get());
+                auto* left = nodeCast<Subtraction<Type>>(this->left.get());
                 // (a - x) + b = (a + b) - x
                 if(left->left->getType() == TypeNode::Number)
                 {
@@ -334,8 +325,8 @@ namespace Math
         if(this->left->getType() == TypeNode::Multiplication
            && this->right->getType() == TypeNode::Multiplication)
         {
-            auto* left = dynamic_cast<Multiplication<Type>*>(this->left.get());
-            auto* right = dynamic_cast<Multiplication<Type>*>(this->right.get());
+            auto* left = nodeCast<Multiplication<Type>>(this->left.get());
+            auto* right = nodeCast<Multiplication<Type>>(this->right.get());
             // x * a + x * b = (a + b) * x
             if(left->left->equal(right->left))
             {
@@ -384,7 +375,7 @@ namespace Math
 
         if(this->left->getType() == TypeNode::Multiplication)
         {
-            auto* left = dynamic_cast<Multiplication<Type>*>(this->left.get());
+            auto* left = nodeCast<Multiplication<Type>>(this->left.get());
             // a * x + x = (a + 1) * x
             if(this->right->equal(left->right))
             {
@@ -411,7 +402,7 @@ namespace Math
 
         if(this->right->getType() == TypeNode::Multiplication)
         {
-            auto* right = dynamic_cast<Multiplication<Type>*>(this->right.get());
+            auto* right = nodeCast<Multiplication<Type>>(this->right.get());
             // x + a * x = (a + 1) * x
             if(this->left->equal(right->right))
             {
@@ -439,8 +430,8 @@ namespace Math
         if(this->left->getType() == TypeNode::Division
            && this->right->getType() == TypeNode::Division)
         {
-            auto* left = dynamic_cast<Division<Type>*>(this->left.get());
-            auto* right = dynamic_cast<Division<Type>*>(this->right.get());
+            auto* left = nodeCast<Division<Type>>(this->left.get());
+            auto* right = nodeCast<Division<Type>>(this->right.get());
             // a / x + b / x = (a + b) / x
             if(left->right->equal(right->right))
             {
@@ -454,7 +445,7 @@ namespace Math
             }
         }
 
-        return std::make_unique<Addition>(this->left, this->right);
+        return std::make_unique<Addition>(std::move(this->left), std::move(this->right));
     }
 } // Math
 
@@ -14,26 +14,25 @@ namespace Math
     class Cos final : public Node<Type>
     {
     public:
+        static constexpr TypeNode kind = TypeNode::Cos;
+
         Cos(const Cos& cos);
         explicit Cos(const std::unique_ptr<Node<Type>>& argument);
+        explicit Cos(std::unique_ptr<Node<Type>>&& argument);
 
-        std::unique_ptr<Node<Type>> makeCopy() override;
-
-        Priority getPriority() override;
+        ~Cos() override;
 
-        TypeNode getType() override;
+        Priority getPriority() const;
 
-        bool equal(std::unique_ptr<Node<Type>>& ptr) override;
+        std::unique_ptr<Node<Type>> make(std::unique_ptr<Node<Type>>* operands) const;
 
-        std::string toString() override;
+        std::string format(std::string* operands) const;
 
-        std::unique_ptr<Node<Type>> substitute(const std::string& variable, const std::unique_ptr<Node<Type>>& expression) override;
+        Type evaluate(const Type* operands, const std::vector<std::string>& variable, const std::vector<Type>& value) const;
 
-        Type calculate(const std::vector<std::string>& variable, const std::vector<Type>& value) override;
+        std::unique_ptr<Node<Type>> derive(const std::string& variable, std::unique_ptr<Node<Type>>* derivatives) const;
 
-        std::unique_ptr<Node<Type>> differentiate(const std::string& variable) override;
-
-        std::unique_ptr<Node<Type>> simplify() override;
+        std::unique_ptr<Node<Type>> rewrite();
 
         std::unique_ptr<Node<Type>> argument;
     };
@@ -44,89 +43,81 @@ namespace Math
 {
     template<typename Type>
     Cos<Type>::Cos(const Cos& cos)
+        : Node<Type>(TypeNode::Cos)
     {
         this->argument = cos.argument->makeCopy();
+        this->summarize();
     }
 
 
     template<typename Type>
     Cos<Type>::Cos(const std::unique_ptr<Node<Type>>& argument)
+        : Node<Type>(TypeNode::Cos)
     {
         this->argument = argument->makeCopy();
+        this->summarize();
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Cos<Type>::makeCopy()
+    Cos<Type>::Cos(std::unique_ptr<Node<Type>>&& argument)
+        : Node<Type>(TypeNode::Cos)
     {
-        return std::make_unique<Cos>(this->argument);
+        this->argument = std::move(argument);
+        this->summarize();
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Cos<Type>::substitute(const std::string& variable, const std::unique_ptr<Node<Type>>& expression)
+    Cos<Type>::~Cos()
     {
-        return std::make_unique<Cos>(this->argument->substitute(variable, expression));
+        this->release();
     }
 
 
     template<typename Type>
-    Type Cos<Type>::calculate(const std::vector<std::string>& variable, const std::vector<Type>& value)
+    std::unique_ptr<Node<Type>> Cos<Type>::make(std::unique_ptr<Node<Type>>* operands) const
     {
-        return std::cos(this->argument->calculate(variable, value));
+        return std::make_unique<Cos>(std::move(operands[0]));
     }
 
 
     template<typename Type>
-    Priority Cos<Type>::getPriority()
+    Type Cos<Type>::evaluate(const Type* operands, const std::vector<std::string>& variable, const std::vector<Type>& value) const
     {
-        return Priority::Cos;
+        return std::cos(operands[0]);
     }
 
 
     template<typename Type>
-    TypeNode Cos<Type>::getType()
+    Priority Cos<Type>::getPriority() const
     {
-        return TypeNode::Cos;
-    }
-
-
-    template<typename Type>
-    bool Cos<Type>::equal(std::unique_ptr<Node<Type>>& ptr)
-    {
-        if(this->getType() == ptr->getType())
-        {
-            Cos* cos = dynamic_cast<Cos*>(ptr.get());
-            return this->argument->equal(cos->argument);
-        }
-        return false;
+        return Priority::Cos;
     }
 
 
     template<typename Type>
-    std::string Cos<Type>::toString()
+    std::string Cos<Type>::format(std::string* operands) const
     {
-        return "cos(" + this->argument->toString() + ")";
+        return "cos(" + operands[0] + ")";
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Cos<Type>::differentiate(const std::string &variable)
+    std::unique_ptr<Node<Type>> Cos<Type>::derive(const std::string& variable, std::unique_ptr<Node<Type>>* derivatives) const
     {
         return std::make_unique<Multiplication<Type>>(
             std::make_unique<Minus<Type>>(
-                std::make_unique<Sin<Type>>(this->argument)
+                std::make_unique<Sin<Type>>(this->argument->makeCopy())
             ),
-            this->argument->differentiate(variable)
+            std::move(derivatives[0])
         );
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Cos<Type>::simplify()
+    std::unique_ptr<Node<Type>> Cos<Type>::rewrite()
     {
-        this->argument = this->argument->simplify();
-
         // cos(a) = cos(a)
         if(this->argument->getType() == TypeNode::Number)
         {
@@ -141,11 +132,11 @@ namespace Math
         // cos(-x) = cos(x)
         if(this->argument->getType() == TypeNode::Minus)
         {
-            auto* arg = dynamic_cast<Minus<Type>*>(this->argument.get());
+            auto* arg = nodeCast<Minus<Type>>(this->argument.get());
             return std::make_unique<Cos>(arg->argument)->simplify();
         }
 
-        return std::make_unique<Cos>(this->argument);
+        return std::make_unique<Cos>(std::move(this->argument));
     }
 } // Math
 
@@ -11,26 +11,25 @@ namespace Math
     class Division final : public Node<Type>
     {
     public:
+        static constexpr TypeNode kind = TypeNode::Division;
+
         Division(const Division& division);
         Division(const std::unique_ptr<Node<Type>>& left, const std::unique_ptr<Node<Type>>& right);
+        Division(std::unique_ptr<Node<Type>>&& left, std::unique_ptr<Node<Type>>&& right);
 
-        std::unique_ptr<Node<Type>> makeCopy() override;
-
-        Priority getPriority() override;
-
-        TypeNode getType() override;
+        ~Division() override;
 
-        bool equal(std::unique_ptr<Node<Type>>& ptr) override;
+        Priority getPriority() const;
 
-        std::string toString() override;
+        std::unique_ptr<Node<Type>> make(std::unique_ptr<Node<Type>>* operands) const;
 
-        std::unique_ptr<Node<Type>> substitute(const std::string& variable, const std::unique_ptr<Node<Type>>& expression) override;
+        std::string format(std::string* operands) const;
 
-        Type calculate(const std::vector<std::string>& variable, const std::vector<Type>& value) override;
+        Type evaluate(const Type* operands, const std::vector<std::string>& variable, const std::vector<Type>& value) const;
 
-        std::unique_ptr<Node<Type>> differentiate(const std::string& variable) override;
+        std::unique_ptr<Node<Type>> derive(const std::string& variable, std::unique_ptr<Node<Type>>* derivatives) const;
 
-        std::unique_ptr<Node<Type>> simplify() override;
+        std::unique_ptr<Node<Type>> rewrite();
 
         std::unique_ptr<Node<Type>> left;
         std::unique_ptr<Node<Type>> right;
@@ -42,77 +41,72 @@ namespace Math
 {
     template<typename Type>
     Division<Type>::Division(const Division& division)
+        : Node<Type>(TypeNode::Division)
     {
         this->left = division.left->makeCopy();
         this->right = division.right->makeCopy();
+        this->summarize();
     }
 
 
     template<typename Type>
     Division<Type>::Division(const std::unique_ptr<Node<Type>>& left, const std::unique_ptr<Node<Type>>& right)
+        : Node<Type>(TypeNode::Division)
     {
         this->left = left->makeCopy();
         this->right = right->makeCopy();
+        this->summarize();
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Division<Type>::makeCopy()
+    Division<Type>::Division(std::unique_ptr<Node<Type>>&& left, std::unique_ptr<Node<Type>>&& right)
+        : Node<Type>(TypeNode::Division)
     {
-        return std::make_unique<Division>(this->left, this->right);
+        this->left = std::move(left);
+        this->right = std::move(right);
+        this->summarize();
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Division<Type>::substitute(const std::string& variable, const std::unique_ptr<Node<Type>>& expression)
+    Division<Type>::~Division()
     {
-        return std::make_unique<Division>(this->left->substitute(variable, expression), this->right->substitute(variable, expression));
+        this->release();
     }
 
 
     template<typename Type>
-    Type Division<Type>::calculate(const std::vector<std::string>& variable, const std::vector<Type>& value)
+    std::unique_ptr<Node<Type>> Division<Type>::make(std::unique_ptr<Node<Type>>* operands) const
     {
-        Type denominator = this->right->calculate(variable, value);
-        if(denominator == Type{})
-        {
-            throw std::invalid_argument("Division by zero");
-        }
-        return this->left->calculate(variable, value) / denominator;
+        return std::make_unique<Division>(std::move(operands[0]), std::move(operands[1]));
     }
 
 
     template<typename Type>
-    Priority Division<Type>::getPriority()
+    Type Division<Type>::evaluate(const Type* operands, const std::vector<std::string>& variable, const std::vector<Type>& value) const
     {
-        return Priority::Division;
-    }
-
-
-    template<typename Type>
-    TypeNode Division<Type>::getType()
-    {
-        return TypeNode::Division;
+        Type denominator = operands[1];
+        if(denominator == Type{})
+        {
+            throw std::invalid_argument("Division by zero");
+        }
+        return operands[0] / denominator;
     }
 
 
     template<typename Type>
-    bool Division<Type>::equal(std::unique_ptr<Node<Type>>& ptr)
+    Priority Division<Type>::getPriority() const
     {
-        if(this->getType() == ptr->getType())
-        {
-            auto* division = dynamic_cast<Division*>(ptr.get());
-            return this->left->equal(division->left) && this->right->equal(division->right);
-        }
-        return false;
+        return Priority::Division;
     }
 
 
     template<typename Type>
-    std::string Division<Type>::toString()
+    std::string Division<Type>::format(std::string* operands) const
     {
-        std::string left = this->left->toString();
-        std::string right = this->right->toString();
+        std::string left = std::move(operands[0]);
+        std::string right = std::move(operands[1]);
         if(this->left->getPriority() < this->getPriority())
         {
             left = "(" + left + ")";
@@ -121,25 +115,25 @@ namespace Math
         {
             right = "(" + right + ")";
         }
-        return left + " / " + right;
+        return std::move(left) + " / " + right;
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Division<Type>::differentiate(const std::string &variable)
+    std::unique_ptr<Node<Type>> Division<Type>::derive(const std::string& variable, std::unique_ptr<Node<Type>>* derivatives) const
     {
         return std::make_unique<Division<Type>>(
             std::make_unique<Subtraction<Type>>(
                 std::make_unique<Multiplication<Type>>(
-                    this->left->differentiate(variable),
-                    this->right
+                    std::move(derivatives[0]),
+                    this->right->makeCopy()
                 ),
                 std::make_unique<Multiplication<Type>>(
-                    this->left,
-                    this->right->differentiate(variable))
+                    this->left->makeCopy(),
+                    std::move(derivatives[1]))
                 ),
             std::make_unique<Power<Type>>(
-                this->right,
+                this->right->makeCopy(),
                 std::make_unique<Number<Type>>(getNumber<Type>(2.0))
             )
         );
@@ -147,23 +141,20 @@ namespace Math
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Division<Type>::simplify()
+    std::unique_ptr<Node<Type>> Division<Type>::rewrite()
     {
-        this->left = this->left->simplify();
-        this->right = this->right->simplify();
-
         // 0 / x = 0
-        if(this->left->toString() == "0" || this->left->toString() == "-0")
+        if(this->left->printsAs("0") || this->left->printsAs("-0"))
         {
             return std::make_unique<Number<Type>>(Type{});
         }
         // x / 1 = x
-        if(this->right->toString() == "1")
+        if(this->right->printsAs("1"))
         {
-            return this->left->makeCopy();
+            return std::move(this->left);
         }
         // x / -1 = -x
-        if(this->right->toString() == "-1")
+        if(this->right->printsAs("-1"))
         {
             return std::make_unique<Minus<Type>>(this->left);
         }
@@ -182,8 +173,8 @@ namespace Math
         // -x / -y = x / y
         if(this->left->getType() == TypeNode::Minus && this->right->getType() == TypeNode::Minus)
         {
-            auto* left = dynamic_cast<Minus<Type>*>(this->left.get());
-            auto* right = dynamic_cast<Minus<Type>*>(this->right.get());
+            auto* left = nodeCast<Minus<Type>>(this->left.get());
+            auto* right = nodeCast<Minus<Type>>(this->right.get());
             return std::make_unique<Division>(
                 left->argument,
                 right->argument
@@ -192,7 +183,7 @@ namespace Math
         // -x / y = -(x / y)
         if(this->left->getType() == TypeNode::Minus)
         {
-            auto* left = dynamic_cast<Minus<Type>*>(this->left.get());
+            auto* left = nodeCast<Minus<Type>>(this->left.get());
             return std::make_unique<Minus<Type>>(
                 std::make_unique<Division>(
                     left->argument,
@@ -203,7 +194,7 @@ namespace Math
         // x / -y = -(x / y)
         if(this->right->getType() == TypeNode::Minus)
         {
-            auto* right = dynamic_cast<Minus<Type>*>(this->right.get());
+            auto* right = nodeCast<Minus<Type>>(this->right.get());
             return std::make_unique<Minus<Type>>(
                 std::make_unique<Division>(
                     this->left,
@@ -215,8 +206,8 @@ namespace Math
         if(this->left->getType() == TypeNode::Division
            && this->right->getType() == TypeNode::Division)
         {
-            auto* left = dynamic_cast<Division*>(this->left.get());
-            auto* right = dynamic_cast<Division*>(this->right.get());
+            auto* left = nodeCast<Division>(this->left.get());
+            auto* right = nodeCast<Division>(this->right.get());
             // (x / a) / (y / b) = (x * b) / (a * y)
             return std::make_unique<Division>(
                 std::make_unique<Multiplication<Type>>(
@@ -233,7 +224,7 @@ namespace Math
         // (a / b) / x = a / (b * x)
         if(this->left->getType() == TypeNode::Division)
         {
-            auto* left = dynamic_cast<Division*>(this->left.get());
+            auto* left = nodeCast<Division>(this->left.get());
             return std::make_unique<Division>(
                 left->left,
                 std::make_unique<Multiplication<Type>>(
@@ -245,7 +236,7 @@ namespace Math
         // x / (a / b) = x * b / a
         if(this->right->getType() == TypeNode::Division)
         {
-            auto* right = dynamic_cast<Division*>(this->right.get());
+            auto* right = nodeCast<Division>(this->right.get());
             return std::make_unique<Division>(
                 std::make_unique<Multiplication<Type>>(
                     this->left,
@@ -257,8 +248,8 @@ namespace Math
 
         if(this->left->getType() == TypeNode::Multiplication && this->right->getType() == TypeNode::Multiplication)
         {
-            auto* left = dynamic_cast<Multiplication<Type>*>(this->left.get());
-            auto* right = dynamic_cast<Multiplication<Type>*>(this->right.get());
+            auto* left = nodeCast<Multiplication<Type>>(this->left.get());
+            auto* right = nodeCast<Multiplication<Type>>(this->right.get());
 
             // (x * a) / (x * b) = a / b
             if(left->left->equal(right->left))
@@ -296,7 +287,7 @@ namespace Math
 
         if(this->left->getType() == TypeNode::Multiplication)
         {
-            auto* left = dynamic_cast<Multiplication<Type>*>(this->left.get());
+            auto* left = nodeCast<Multiplication<Type>>(this->left.get());
             // (x * a) / x = a
             if(left->left->equal(this->right))
             {
@@ -309,7 +300,7 @@ namespace Math
             }
             if(left->left->getType() == TypeNode::Power)
             {
-                auto* pow1 = dynamic_cast<Power<Type>*>(left->left.get());
+                auto* pow1 = nodeCast<Power<Type>>(left->left.get());
                 // (x^b * a) / x = a * x^(b - 1)
                 if(pow1->left->equal(this->right))
                 {
@@ -326,7 +317,7 @@ namespace Math
                 }
                 if(this->right->getType() == TypeNode::Power)
                 {
-                    auto* pow2 = dynamic_cast<Power<Type>*>(this->right.get());
+                    auto* pow2 = nodeCast<Power<Type>>(this->right.get());
                     // (x^b * a) / x^c = a * x^(b - c)
                     if(pow1->left->equal(pow2->left))
                     {
@@ -345,7 +336,7 @@ namespace Math
             }
             if(left->right->getType() == TypeNode::Power)
             {
-                auto* pow1 = dynamic_cast<Power<Type>*>(left->right.get());
+                auto* pow1 = nodeCast<Power<Type>>(left->right.get());
                 // (a * x^b) / x = a * x^(b - 1)
                 if(pow1->left->equal(this->right))
                 {
@@ -362,7 +353,7 @@ namespace Math
                 }
                 if(this->right->getType() == TypeNode::Power)
                 {
-                    auto* pow2 = dynamic_cast<Power<Type>*>(this->right.get());
+                    auto* pow2 = nodeCast<Power<Type>>(this->right.get());
                     // (a * x^b) / x^c = a * x^(b - c)
                     if(pow1->left->equal(pow2->left))
                     {
@@ -383,7 +374,7 @@ namespace Math
 
         if(this->right->getType() == TypeNode::Multiplication)
         {
-            auto* right = dynamic_cast<Multiplication<Type>*>(this->right.get());
+            auto* right = nodeCast<Multiplication<Type>>(this->right.get());
             // x / (x * a) = 1 / a
             if(right->left->equal(this->left))
             {
@@ -402,7 +393,7 @@ namespace Math
             }
             if(right->left->getType() == TypeNode::Power)
             {
-                auto* pow1 = dynamic_cast<Power<Type>*>(right->left.get());
+                auto* pow1 = nodeCast<Power<Type>>(right->left.get());
                 // x / (x^b * a) = x^(1 - b) / a
                 if(pow1->left->equal(this->left))
                 {
@@ -419,7 +410,7 @@ namespace Math
                 }
                 if(this->left->getType() == TypeNode::Power)
                 {
-                    auto* pow2 = dynamic_cast<Power<Type>*>(this->left.get());
+                    auto* pow2 = nodeCast<Power<Type>>(this->left.get());
                     // x^c / (x^b * a) = x^(c - b) / a
                     if(pow1->left->equal(pow2->left))
                     {
@@ -438,7 +429,7 @@ namespace Math
             }
             if(right->right->getType() == TypeNode::Power)
             {
-                auto* pow1 = dynamic_cast<Power<Type>*>(right->right.get());
+                auto* pow1 = nodeCast<Power<Type>>(right->right.get());
                 // x / (a * x^b) = x^(1 - b) / a
                 if(pow1->left->equal(this->left))
                 {
@@ -455,7 +446,7 @@ namespace Math
                 }
                 if(this->left->getType() == TypeNode::Power)
                 {
-                    auto* pow2 = dynamic_cast<Power<Type>*>(this->left.get());
+                    auto* pow2 = nodeCast<Power<Type>>(this->left.get());
                     // x^c / (a * x^b) = x^(c - b) / a
                     if(pow1->left->equal(pow2->left))
                     {
@@ -476,7 +467,7 @@ namespace Math
 
         if(this->left->getType() == TypeNode::Power)
         {
-            auto* left = dynamic_cast<Power<Type>*>(this->left.get());
+            auto* left = nodeCast<Power<Type>>(this->left.get());
             // x^a / x = x^(a - 1)
             if(left->left->equal(this->right))
             {
@@ -490,7 +481,7 @@ namespace Math
             }
             if(this->right->getType() == TypeNode::Power)
             {
-                auto* right = dynamic_cast<Power<Type>*>(this->right.get());
+                auto* right = nodeCast<Power<Type>>(this->right.get());
                 // x^a / x^b = x^(a - b)
                 if(left->left->equal(right->left))
                 {
@@ -507,7 +498,7 @@ namespace Math
 
         if(this->right->getType() == TypeNode::Power)
         {
-            auto* right = dynamic_cast<Power<Type>*>(this->right.get());
+            auto* right = nodeCast<Power<Type>>(this->right.get());
             // x / x^a = x^(1 - a)
             if(this->left->equal(right->left))
             {
@@ -521,7 +512,7 @@ namespace Math
             }
         }
 
-        return std::make_unique<Division>(this->left, this->right);
+        return std::make_unique<Division>(std::move(this->left), std::move(this->right));
     }
 } // Math
 
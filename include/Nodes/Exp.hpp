@@ -14,26 +14,25 @@ namespace Math
     class Exp final : public Node<Type>
     {
     public:
+        static constexpr TypeNode kind = TypeNode::Exp;
+
         Exp(const Exp& exp);
         explicit Exp(const std::unique_ptr<Node<Type>>& argument);
+        explicit Exp(std::unique_ptr<Node<Type>>&& argument);
 
-        std::unique_ptr<Node<Type>> makeCopy() override;
-
-        Priority getPriority() override;
+        ~Exp() override;
 
-        TypeNode getType() override;
+        Priority getPriority() const;
 
-        bool equal(std::unique_ptr<Node<Type>>& ptr) override;
+        std::unique_ptr<Node<Type>> make(std::unique_ptr<Node<Type>>* operands) const;
 
-        std::string toString() override;
+        std::string format(std::string* operands) const;
 
-        std::unique_ptr<Node<Type>> substitute(const std::string& variable, const std::unique_ptr<Node<Type>>& expression) override;
+        Type evaluate(const Type* operands, const std::vector<std::string>& variable, const std::vector<Type>& value) const;
 
-        Type calculate(const std::vector<std::string>& variable, const std::vector<Type>& value) override;
+        std::unique_ptr<Node<Type>> derive(const std::string& variable, std::unique_ptr<Node<Type>>* derivatives) const;
 
-        std::unique_ptr<Node<Type>> differentiate(const std::string& variable) override;
-
-        std::unique_ptr<Node<Type>> simplify() override;
+        std::unique_ptr<Node<Type>> rewrite();
 
         std::unique_ptr<Node<Type>> argument;
     };
@@ -44,87 +43,79 @@ namespace Math
 {
     template<typename Type>
     Exp<Type>::Exp(const Exp& exp)
+        : Node<Type>(TypeNode::Exp)
     {
         this->argument = exp.argument->makeCopy();
+        this->summarize();
     }
 
 
     template<typename Type>
     Exp<Type>::Exp(const std::unique_ptr<Node<Type>>& argument)
+        : Node<Type>(TypeNode::Exp)
     {
         this->argument = argument->makeCopy();
+        this->summarize();
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Exp<Type>::makeCopy()
+    Exp<Type>::Exp(std::unique_ptr<Node<Type>>&& argument)
+        : Node<Type>(TypeNode::Exp)
     {
-        return std::make_unique<Exp>(this->argument);
+        this->argument = std::move(argument);
+        this->summarize();
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Exp<Type>::substitute(const std::string& variable, const std::unique_ptr<Node<Type>>& expression)
+    Exp<Type>::~Exp()
     {
-        return std::make_unique<Exp>(this->argument->substitute(variable, expression));
+        this->release();
     }
 
 
     template<typename Type>
-    Type Exp<Type>::calculate(const std::vector<std::string>& variable, const std::vector<Type>& value)
+    std::unique_ptr<Node<Type>> Exp<Type>::make(std::unique_ptr<Node<Type>>* operands) const
     {
-        return std::exp(this->argument->calculate(variable, value));
+        return std::make_unique<Exp>(std::move(operands[0]));
     }
 
 
     template<typename Type>
-    Priority Exp<Type>::getPriority()
+    Type Exp<Type>::evaluate(const Type* operands, const std::vector<std::string>& variable, const std::vector<Type>& value) const
     {
-        return Priority::Exp;
+        return std::exp(operands[0]);
     }
 
 
     template<typename Type>
-    TypeNode Exp<Type>::getType()
+    Priority Exp<Type>::getPriority() const
     {
-        return TypeNode::Exp;
-    }
-
-
-    template<typename Type>
-    bool Exp<Type>::equal(std::unique_ptr<Node<Type>>& ptr)
-    {
-        if(this->getType() == ptr->getType())
-        {
-            Exp* exp = dynamic_cast<Exp*>(ptr.get());
-            return this->argument->equal(exp->argument);
-        }
-        return false;
+        return Priority::Exp;
     }
 
 
     template<typename Type>
-    std::string Exp<Type>::toString()
+    std::string Exp<Type>::format(std::string* operands) const
     {
-        return "exp(" + this->argument->toString() + ")";
+        return "exp(" + operands[0] + ")";
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Exp<Type>::differentiate(const std::string &variable)
+    std::unique_ptr<Node<Type>> Exp<Type>::derive(const std::string& variable, std::unique_ptr<Node<Type>>* derivatives) const
     {
         return std::make_unique<Multiplication<Type>>(
-            std::make_unique<Exp<Type>>(this->argument),
-            this->argument->differentiate(variable)
+            std::make_unique<Exp<Type>>(this->argument->makeCopy()),
+            std::move(derivatives[0])
         );
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Exp<Type>::simplify()
+    std::unique_ptr<Node<Type>> Exp<Type>::rewrite()
     {
-        this->argument = this->argument->simplify();
-
         // exp(a) = exp(a)
         if(this->argument->getType() == TypeNode::Number)
         {
@@ -139,18 +130,18 @@ namespace Math
         // exp(ln(x)) = x
         if(this->argument->getType() == TypeNode::Ln)
         {
-            auto* arg = dynamic_cast<Ln<Type>*>(this->argument.get());
+            auto* arg = nodeCast<Ln<Type>>(this->argument.get());
             return arg->argument->makeCopy();
         }
 
         if(this->argument->getType() == TypeNode::Addition)
         {
-            auto* arg = dynamic_cast<Addition<Type>*>(this->argument.get());
+            auto* arg = nodeCast<Addition<Type>>(this->argument.get());
 
             // exp(ln(x) + y) = x * exp(y)
             if(arg->left->getType() == TypeNode::Ln)
             {
-                auto* left = dynamic_cast<Ln<Type>*>(arg->left.get());
+                auto* left = nodeCast<Ln<Type>>(arg->left.get());
                 return std::make_unique<Multiplication<Type>>(
                     left->argument,
                     std::make_unique<Exp>(
@@ -161,7 +152,7 @@ namespace Math
             // exp(y + ln(x)) = x * exp(y)
             if(arg->right->getType() == TypeNode::Ln)
             {
-                auto* right = dynamic_cast<Ln<Type>*>(arg->right.get());
+                auto* right = nodeCast<Ln<Type>>(arg->right.get());
                 return std::make_unique<Multiplication<Type>>(
                     right->argument,
                     std::make_unique<Exp>(
@@ -173,12 +164,12 @@ namespace Math
 
         if(this->argument->getType() == TypeNode::Subtraction)
         {
-            auto* arg = dynamic_cast<Subtraction<Type>*>(this->argument.get());
+            auto* arg = nodeCast<Subtraction<Type>>(this->argument.get());
 
             // exp(ln(x) - y) = x / exp(y)
             if(arg->left->getType() == TypeNode::Ln)
             {
-                auto* left = dynamic_cast<Ln<Type>*>(arg->left.get());
+                auto* left = nodeCast<Ln<Type>>(arg->left.get());
                 return std::make_unique<Division<Type>>(
                     left->argument,
                     std::make_unique<Exp>(
@@ -189,7 +180,7 @@ namespace Math
             // exp(y - ln(x)) = exp(y) / x
             if(arg->right->getType() == TypeNode::Ln)
             {
-                auto* right = dynamic_cast<Ln<Type>*>(arg->right.get());
+                auto* right = nodeCast<Ln<Type>>(arg->right.get());
                 return std::make_unique<Division<Type>>(
                     std::make_unique<Exp>(
                         arg->left
@@ -201,11 +192,11 @@ namespace Math
 
         if(this->argument->getType() == TypeNode::Multiplication)
         {
-            auto* arg = dynamic_cast<Multiplication<Type>*>(this->argument.get());
+            auto* arg = nodeCast<Multiplication<Type>>(this->argument.get());
             // exp(ln(x) * a) = x^a
             if(arg->left->getType() == TypeNode::Ln)
             {
-                auto* left = dynamic_cast<Ln<Type>*>(arg->left.get());
+                auto* left = nodeCast<Ln<Type>>(arg->left.get());
                 return std::make_unique<Power<Type>>(
                     left->argument,
                     arg->right
@@ -214,7 +205,7 @@ namespace Math
             // exp(a * ln(x)) = x^a
             if(arg->right->getType() == TypeNode::Ln)
             {
-                auto* right = dynamic_cast<Ln<Type>*>(arg->right.get());
+                auto* right = nodeCast<Ln<Type>>(arg->right.get());
                 return std::make_unique<Power<Type>>(
                     right->argument,
                     arg->left
@@ -224,11 +215,11 @@ namespace Math
 
         if(this->argument->getType() == TypeNode::Division)
         {
-            auto* arg = dynamic_cast<Division<Type>*>(this->argument.get());
+            auto* arg = nodeCast<Division<Type>>(this->argument.get());
             // exp(ln(x) / a) = x^(1 / a)
             if(arg->left->getType() == TypeNode::Ln)
             {
-                auto* left = dynamic_cast<Ln<Type>*>(arg->left.get());
+                auto* left = nodeCast<Ln<Type>>(arg->left.get());
                 return std::make_unique<Power<Type>>(
                     left->argument,
                     std::make_unique<Division<Type>>(
@@ -239,7 +230,7 @@ namespace Math
             }
         }
 
-        return std::make_unique<Exp>(this->argument);
+        return std::make_unique<Exp>(std::move(this->argument));
     }
 } // Math
 
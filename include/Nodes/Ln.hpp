@@ -14,26 +14,25 @@ namespace Math
     class Ln final : public Node<Type>
     {
     public:
+        static constexpr TypeNode kind = TypeNode::Ln;
+
         Ln(const Ln& ln);
         explicit Ln(const std::unique_ptr<Node<Type>>& argument);
+        explicit Ln(std::unique_ptr<Node<Type>>&& argument);
 
-        std::unique_ptr<Node<Type>> makeCopy() override;
-
-        Priority getPriority() override;
-
-        TypeNode getType() override;
+        ~Ln() override;
 
-        bool equal(std::unique_ptr<Node<Type>>& ptr) override;
+        Priority getPriority() const;
 
-        std::string toString() override;
+        std::unique_ptr<Node<Type>> make(std::unique_ptr<Node<Type>>* operands) const;
 
-        std::unique_ptr<Node<Type>> substitute(const std::string& variable, const std::unique_ptr<Node<Type>>& expression) override;
+        std::string format(std::string* operands) const;
 
-        Type calculate(const std::vector<std::string>& variable, const std::vector<Type>& value) override;
+        Type evaluate(const Type* operands, const std::vector<std::string>& variable, const std::vector<Type>& value) const;
 
-        std::unique_ptr<Node<Type>> differentiate(const std::string& variable) override;
+        std::unique_ptr<Node<Type>> derive(const std::string& variable, std::unique_ptr<Node<Type>>* derivatives) const;
 
-        std::unique_ptr<Node<Type>> simplify() override;
+        std::unique_ptr<Node<Type>> rewrite();
 
         std::unique_ptr<Node<Type>> argument;
     };
@@ -44,36 +43,49 @@ namespace Math
 {
     template<typename Type>
     Ln<Type>::Ln(const Ln& ln)
+        : Node<Type>(TypeNode::Ln)
     {
         this->argument = ln.argument->makeCopy();
+        this->summarize();
     }
 
 
     template<typename Type>
     Ln<Type>::Ln(const std::unique_ptr<Node<Type>>& argument)
+        : Node<Type>(TypeNode::Ln)
     {
         this->argument = argument->makeCopy();
+        this->summarize();
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Ln<Type>::makeCopy()
+    Ln<Type>::Ln(std::unique_ptr<Node<Type>>&& argument)
+        : Node<Type>(TypeNode::Ln)
     {
-        return std::make_unique<Ln>(this->argument);
+        this->argument = std::move(argument);
+        this->summarize();
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Ln<Type>::substitute(const std::string& variable, const std::unique_ptr<Node<Type>>& expression)
+    Ln<Type>::~Ln()
     {
-        return std::make_unique<Ln>(this->argument->substitute(variable, expression));
+        this->release();
     }
 
 
     template<typename Type>
-    Type Ln<Type>::calculate(const std::vector<std::string>& variable, const std::vector<Type>& value)
+    std::unique_ptr<Node<Type>> Ln<Type>::make(std::unique_ptr<Node<Type>>* operands) const
     {
-        Type result = this->argument->calculate(variable, value);
+        return std::make_unique<Ln>(std::move(operands[0]));
+    }
+
+
+    template<typename Type>
+    Type Ln<Type>::evaluate(const Type* operands, const std::vector<std::string>& variable, const std::vector<Type>& value) const
+    {
+        Type result = operands[0];
         if(result == Type{})
         {
             throw std::invalid_argument("Logarithm from zero");
@@ -83,56 +95,35 @@ namespace Math
 
 
     template<typename Type>
-    Priority Ln<Type>::getPriority()
+    Priority Ln<Type>::getPriority() const
     {
         return Priority::Ln;
     }
 
 
     template<typename Type>
-    TypeNode Ln<Type>::getType()
+    std::string Ln<Type>::format(std::string* operands) const
     {
-        return TypeNode::Ln;
+        return "ln(" + operands[0] + ")";
     }
 
 
     template<typename Type>
-    bool Ln<Type>::equal(std::unique_ptr<Node<Type>>& ptr)
-    {
-        if(this->getType() == ptr->getType())
-        {
-            Ln* ln = dynamic_cast<Ln*>(ptr.get());
-            return this->argument->equal(ln->argument);
-        }
-        return false;
-    }
-
-
-    template<typename Type>
-    std::string Ln<Type>::toString()
-    {
-        return "ln(" + this->argument->toString() + ")";
-    }
-
-
-    template<typename Type>
-    std::unique_ptr<Node<Type>> Ln<Type>::differentiate(const std::string &variable)
+    std::unique_ptr<Node<Type>> Ln<Type>::derive(const std::string& variable, std::unique_ptr<Node<Type>>* derivatives) const
     {
         return std::make_unique<Multiplication<Type>>(
             std::make_unique<Division<Type>>(
                 std::make_unique<Number<Type>>(getNumber<Type>(1.0)),
-                this->argument
+                this->argument->makeCopy()
             ),
-            this->argument->differentiate(variable)
+            std::move(derivatives[0])
         );
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Ln<Type>::simplify()
+    std::unique_ptr<Node<Type>> Ln<Type>::rewrite()
     {
-        this->argument = this->argument->simplify();
-
         // ln(a) = ln(a)
         if(this->argument->getType() == TypeNode::Number)
         {
@@ -147,17 +138,17 @@ namespace Math
         // ln(exp(x)) = x
         if(this->argument->getType() == TypeNode::Exp)
         {
-            auto* arg = dynamic_cast<Exp<Type>*>(this->argument.get());
+            auto* arg = nodeCast<Exp<Type>>(this->argument.get());
             return arg->argument->makeCopy();
         }
 
         if(this->argument->getType() == TypeNode::Multiplication)
         {
-            auto* arg = dynamic_cast<Multiplication<Type>*>(this->argument.get());
+            auto* arg = nodeCast<Multiplication<Type>>(this->argument.get());
             // ln(exp(x) * a) = x + ln(a)
             if(arg->left->getType() == TypeNode::Exp)
             {
-                auto* left = dynamic_cast<Exp<Type>*>(arg->left.get());
+                auto* left = nodeCast<Exp<Type>>(arg->left.get());
                 return std::make_unique<Addition<Type>>(
                     left->argument,
                     std::make_unique<Ln>(
@@ -168,7 +159,7 @@ namespace Math
             // ln(a * exp(x)) = x + ln(a)
             if(arg->right->getType() == TypeNode::Exp)
             {
-                auto* right = dynamic_cast<Exp<Type>*>(arg->right.get());
+                auto* right = nodeCast<Exp<Type>>(arg->right.get());
                 return std::make_unique<Addition<Type>>(
                     right->argument,
                     std::make_unique<Ln>(
@@ -180,11 +171,11 @@ namespace Math
 
         if(this->argument->getType() == TypeNode::Division)
         {
-            auto* arg = dynamic_cast<Division<Type>*>(this->argument.get());
+            auto* arg = nodeCast<Division<Type>>(this->argument.get());
             // ln(exp(x) / a) = x - ln(a)
             if(arg->left->getType() == TypeNode::Exp)
             {
-                auto* left = dynamic_cast<Exp<Type>*>(arg->left.get());
+                auto* left = nodeCast<Exp<Type>>(arg->left.get());
                 return std::make_unique<Subtraction<Type>>(
                     left->argument,
                     std::make_unique<Ln>(
@@ -195,7 +186,7 @@ namespace Math
             // ln(a / exp(x)) = ln(a) - x
             if(arg->right->getType() == TypeNode::Exp)
             {
-                auto* right = dynamic_cast<Exp<Type>*>(arg->right.get());
+                auto* right = nodeCast<Exp<Type>>(arg->right.get());
                 return std::make_unique<Subtraction<Type>>(
                     std::make_unique<Ln>(
                         arg->left
@@ -205,7 +196,7 @@ namespace Math
             }
         }
 
-        return std::make_unique<Ln>(this->argument);
+        return std::make_unique<Ln>(std::move(this->argument));
     }
 } // Math
 
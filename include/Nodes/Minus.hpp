@@ -11,26 +11,25 @@ namespace Math
     class Minus final : public Node<Type>
     {
     public:
+        static constexpr TypeNode kind = TypeNode::Minus;
+
         Minus(const Minus& minus);
         explicit Minus(const std::unique_ptr<Node<Type>>& argument);
+        explicit Minus(std::unique_ptr<Node<Type>>&& argument);
 
-        std::unique_ptr<Node<Type>> makeCopy() override;
-
-        Priority getPriority() override;
+        ~Minus() override;
 
-        TypeNode getType() override;
+        Priority getPriority() const;
 
-        bool equal(std::unique_ptr<Node<Type>>& ptr) override;
+        std::unique_ptr<Node<Type>> make(std::unique_ptr<Node<Type>>* operands) const;
 
-        std::string toString() override;
+        std::string format(std::string* operands) const;
 
-        std::unique_ptr<Node<Type>> substitute(const std::string& variable, const std::unique_ptr<Node<Type>>& expression) override;
+        Type evaluate(const Type* operands, const std::vector<std::string>& variable, const std::vector<Type>& value) const;
 
-        Type calculate(const std::vector<std::string>& variable, const std::vector<Type>& value) override;
+        std::unique_ptr<Node<Type>> derive(const std::string& variable, std::unique_ptr<Node<Type>>* derivatives) const;
 
-        std::unique_ptr<Node<Type>> differentiate(const std::string& variable) override;
-
-        std::unique_ptr<Node<Type>> simplify() override;
+        std::unique_ptr<Node<Type>> rewrite();
 
         std::unique_ptr<Node<Type>> argument;
     };
@@ -41,69 +40,63 @@ namespace Math
 {
     template<typename Type>
     Minus<Type>::Minus(const Minus& minus)
+        : Node<Type>(TypeNode::Minus)
     {
         this->argument = minus.argument->makeCopy();
+        this->summarize();
     }
 
 
     template<typename Type>
     Minus<Type>::Minus(const std::unique_ptr<Node<Type>>& argument)
+        : Node<Type>(TypeNode::Minus)
     {
         this->argument = argument->makeCopy();
+        this->summarize();
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Minus<Type>::makeCopy()
+    Minus<Type>::Minus(std::unique_ptr<Node<Type>>&& argument)
+        : Node<Type>(TypeNode::Minus)
     {
-        return std::make_unique<Minus>(this->argument);
+        this->argument = std::move(argument);
+        this->summarize();
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Minus<Type>::substitute(const std::string& variable, const std::unique_ptr<Node<Type>>& expression)
+    Minus<Type>::~Minus()
     {
-        return std::make_unique<Minus>(this->argument->substitute(variable, expression));
+        this->release();
     }
 
 
     template<typename Type>
-    Type Minus<Type>::calculate(const std::vector<std::string>& variable, const std::vector<Type>& value)
+    std::unique_ptr<Node<Type>> Minus<Type>::make(std::unique_ptr<Node<Type>>* operands) const
     {
-        return -this->argument->calculate(variable, value);
+        return std::make_unique<Minus>(std::move(operands[0]));
     }
 
 
     template<typename Type>
-    Priority Minus<Type>::getPriority()
+    Type Minus<Type>::evaluate(const Type* operands, const std::vector<std::string>& variable, const std::vector<Type>& value) const
     {
-        return Priority::Minus;
+        return -operands[0];
     }
 
 
     template<typename Type>
-    TypeNode Minus<Type>::getType()
+    Priority Minus<Type>::getPriority() const
     {
-        return TypeNode::Minus;
-    }
-
-
-    template<typename Type>
-    bool Minus<Type>::equal(std::unique_ptr<Node<Type>>& ptr)
-    {
-        if(this->getType() == ptr->getType())
-        {
-            auto* minus = dynamic_cast<Minus*>(ptr.get());
-            return this->argument->equal(minus->argument);
-        }
-        return false;
+        return Priority::Minus;
     }
 
 
     template<typename Type>
-    std::string Minus<Type>::toString()
+    std::string Minus<Type>::format(std::string* operands) const
     {
-        std::string string = this->argument->toString();
+        std::string string = std::move(operands[0]);
         if(string.front() == '-' || this->argument->getPriority() <= this->getPriority())
         {
             return "-(" + string + ")";
@@ -113,17 +106,15 @@ namespace Math
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type> > Minus<Type>::differentiate(const std::string &variable)
+    std::unique_ptr<Node<Type>> Minus<Type>::derive(const std::string& variable, std::unique_ptr<Node<Type>>* derivatives) const
     {
-        return std::make_unique<Minus>(this->argument->differentiate(variable));
+        return std::make_unique<Minus>(std::move(derivatives[0]));
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Minus<Type>::simplify()
+    std::unique_ptr<Node<Type>> Minus<Type>::rewrite()
     {
-        this->argument = this->argument->simplify();
-
         // -(a) = -a
         if(this->argument->getType() == TypeNode::Number)
         {
@@ -132,11 +123,11 @@ namespace Math
         // -(-a) = a
         if(this->argument->getType() == TypeNode::Minus)
         {
-            auto* arg = dynamic_cast<Minus*>(this->argument.get());
+            auto* arg = nodeCast<Minus>(this->argument.get());
             return arg->argument->makeCopy();
         }
 
-        return std::make_unique<Minus>(this->argument);
+        return std::make_unique<Minus>(std::move(this->argument));
     }
 } // Math
 
@@ -11,26 +11,25 @@ namespace Math
     class Multiplication final : public Node<Type>
     {
     public:
+        static constexpr TypeNode kind = TypeNode::Multiplication;
+
         Multiplication(const Multiplication& multiplication);
         Multiplication(const std::unique_ptr<Node<Type>>& left, const std::unique_ptr<Node<Type>>& right);
+        Multiplication(std::unique_ptr<Node<Type>>&& left, std::unique_ptr<Node<Type>>&& right);
 
-        std::unique_ptr<Node<Type>> makeCopy() override;
-
-        Priority getPriority() override;
+        ~Multiplication() override;
 
-        TypeNode getType() override;
+        Priority getPriority() const;
 
-        bool equal(std::unique_ptr<Node<Type>>& ptr) override;
+        std::unique_ptr<Node<Type>> make(std::unique_ptr<Node<Type>>* operands) const;
 
-        std::string toString() override;
+        std::string format(std::string* operands) const;
 
-        std::unique_ptr<Node<Type>> substitute(const std::string& variable, const std::unique_ptr<Node<Type>>& expression) override;
+        Type evaluate(const Type* operands, const std::vector<std::string>& variable, const std::vector<Type>& value) const;
 
-        Type calculate(const std::vector<std::string>& variable, const std::vector<Type>& value) override;
+        std::unique_ptr<Node<Type>> derive(const std::string& variable, std::unique_ptr<Node<Type>>* derivatives) const;
 
-        std::unique_ptr<Node<Type>> differentiate(const std::string& variable) override;
-
-        std::unique_ptr<Node<Type>> simplify() override;
+        std::unique_ptr<Node<Type>> rewrite();
 
         std::unique_ptr<Node<Type>> left;
         std::unique_ptr<Node<Type>> right;
@@ -42,72 +41,67 @@ namespace Math
 {
     template<typename Type>
     Multiplication<Type>::Multiplication(const Multiplication& multiplication)
+        : Node<Type>(TypeNode::Multiplication)
     {
         this->left = multiplication.left->makeCopy();
         this->right = multiplication.right->makeCopy();
+        this->summarize();
     }
 
 
     template<typename Type>
     Multiplication<Type>::Multiplication(const std::unique_ptr<Node<Type>>& left, const std::unique_ptr<Node<Type>>& right)
+        : Node<Type>(TypeNode::Multiplication)
     {
         this->left = left->makeCopy();
         this->right = right->makeCopy();
+        this->summarize();
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Multiplication<Type>::makeCopy()
-    {
-        return std::make_unique<Multiplication>(this->left, this->right);
-    }
-
-
-    template<typename Type>
-    std::unique_ptr<Node<Type>> Multiplication<Type>::substitute(const std::string& variable, const std::unique_ptr<Node<Type>>& expression)
+    Multiplication<Type>::Multiplication(std::unique_ptr<Node<Type>>&& left, std::unique_ptr<Node<Type>>&& right)
+        : Node<Type>(TypeNode::Multiplication)
     {
-        return std::make_unique<Multiplication>(this->left->substitute(variable, expression), this->right->substitute(variable, expression));
+        this->left = std::move(left);
+        this->right = std::move(right);
+        this->summarize();
     }
 
 
     template<typename Type>
-    Type Multiplication<Type>::calculate(const std::vector<std::string>& variable, const std::vector<Type>& value)
+    Multiplication<Type>::~Multiplication()
     {
-        return this->left->calculate(variable, value) * this->right->calculate(variable, value);
+        this->release();
     }
 
 
     template<typename Type>
-    Priority Multiplication<Type>::getPriority()
+    std::unique_ptr<Node<Type>> Multiplication<Type>::make(std::unique_ptr<Node<Type>>* operands) const
     {
-        return Priority::Multiplication;
+        return std::make_unique<Multiplication>(std::move(operands[0]), std::move(operands[1]));
     }
 
 
     template<typename Type>
-    TypeNode Multiplication<Type>::getType()
+    Type Multiplication<Type>::evaluate(const Type* operands, const std::vector<std::string>& variable, const std::vector<Type>& value) const
     {
-        return TypeNode::Multiplication;
+        return operands[0] * operands[1];
     }
 
 
     template<typename Type>
-    bool Multiplication<Type>::equal(std::unique_ptr<Node<Type>>& ptr)
+    Priority Multiplication<Type>::getPriority() const
     {
-        if(this->getType() == ptr->getType())
-        {
-            auto* multiplication = dynamic_cast<Multiplication*>(ptr.get());
-            return this->left->equal(multiplication->left) && this->right->equal(multiplication->right);
-        }
-        return false;
+        return Priority::Multiplication;
     }
 
 
     template<typename Type>
-    std::string Multiplication<Type>::toString()
+    std::string Multiplication<Type>::format(std::string* operands) const
     {
-        std::string left = this->left->toString();
-        std::string right = this->right->toString();
+        std::string left = std::move(operands[0]);
+        std::string right = std::move(operands[1]);
         if(this->left->getPriority() < this->getPriority())
         {
             left = "(" + left + ")";
@@ -116,56 +110,53 @@ namespace Math
         {
             right = "(" + right + ")";
         }
-        return left + " * " + right;
+        return std::move(left) + " * " + right;
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Multiplication<Type>::differentiate(const std::string &variable)
+    std::unique_ptr<Node<Type>> Multiplication<Type>::derive(const std::string& variable, std::unique_ptr<Node<Type>>* derivatives) const
     {
         return std::make_unique<Addition<Type>>(
             std::make_unique<Multiplication<Type>>(
-                this->left->differentiate(variable),
-                this->right
+                std::move(derivatives[0]),
+                this->right->makeCopy()
             ),
             std::make_unique<Multiplication<Type>>(
-                this->left,
-                this->right->differentiate(variable)
+                this->left->makeCopy(),
+                std::move(derivatives[1])
             )
         );
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Multiplication<Type>::simplify()
+    std::unique_ptr<Node<Type>> Multiplication<Type>::rewrite()
     {
-        this->left = this->left->simplify();
-        this->right = this->right->simplify();
-
         // 0 * x = x * 0 = 0
-        if(this->left->toString() == "0" || this->left->toString() == "-0" ||
-           this->right->toString() == "0" || this->right->toString() == "-0")
+        if(this->left->printsAs("0") || this->left->printsAs("-0") ||
+           this->right->printsAs("0") || this->right->printsAs("-0"))
         {
             return std::make_unique<Number<Type>>(Type{});
         }
 
         // 1 * x = x
-        if(this->left->toString() == "1")
+        if(this->left->printsAs("1"))
         {
-            return this->right->makeCopy();
+            return std::move(this->right);
         }
         // -1 * x = -x
-        if(this->left->toString() == "-1")
+        if(this->left->printsAs("-1"))
         {
             return std::make_unique<Minus<Type>>(this->right);
         }
         // x * 1 = x
-        if(this->right->toString() == "1")
+        if(this->right->printsAs("1"))
         {
-            return this->left->makeCopy();
+            return std::move(this->left);
         }
         // x * -1 = x
-        if(this->right->toString() == "-1")
+        if(this->right->printsAs("-1"))
         {
             return std::make_unique<Minus<Type>>(this->left);
         }
@@ -178,11 +169,11 @@ namespace Math
 
         if(this->left->getType() == TypeNode::Number)
         {
-            auto* left = dynamic_cast<Number<Type>*>(this->left.get());
+            auto* left = nodeCast<Number<Type>>(this->left.get());
 
             if(this->right->getType() == TypeNode::Multiplication)
             {
-                auto* right = dynamic_cast<Multiplication*>(this->right.get());
+                auto* right = nodeCast<Multiplication>(this->right.get());
                 // a * (b * x) = (a * b) * x
                 if(right->left->getType() == TypeNode::Number)
                 {
@@ -209,7 +200,7 @@ namespace Math
 
             if(this->right->getType() == TypeNode::Division)
             {
-                auto* right = dynamic_cast<Division<Type>*>(this->right.get());
+                auto* right = nodeCast<Division<Type>>(this->right.get());
                 // a * (b / x) = (a * b) / x
                 if(right->left->getType() == TypeNode::Number)
                 {
@@ -237,11 +228,11 @@ namespace Math
 
         if(this->right->getType() == TypeNode::Number)
         {
-            auto* right = dynamic_cast<Number<Type>*>(this->right.get());
+            auto* right = nodeCast<Number<Type>>(this->right.get());
 
             if(this->left->getType() == TypeNode::Multiplication)
             {
-                auto* left = dynamic_cast<Multiplication*>(this->left.get());
+                auto* left = nodeCast<Multiplication>(this->left.get());
                 // (a * x) * b = (a * b) * x
                 if(left->left->getType() == TypeNode::Number)
                 {
@@ -268,7 +259,7 @@ namespace Math
 
             if(this->left->getType() == TypeNode::Division)
             {
-                auto* left = dynamic_cast<Division<Type>*>(this->left.get());
+                auto* left = nodeCast<Division<Type>>(this->left.get());
                 // (a / x) * b = (a * b) / x
                 if(left->left->getType() == TypeNode::Number)
                 {
@@ -306,8 +297,8 @@ namespace Math
         // -x * -y = x * y
         if(this->left->getType() == TypeNode::Minus && this->right->getType() == TypeNode::Minus)
         {
-            auto* left = dynamic_cast<Minus<Type>*>(this->left.get());
-            auto* right = dynamic_cast<Minus<Type>*>(this->right.get());
+            auto* left = nodeCast<Minus<Type>>(this->left.get());
+            auto* right = nodeCast<Minus<Type>>(this->right.get());
             return std::make_unique<Multiplication>(
                 left->argument,
                 right->argument
@@ -316,7 +307,7 @@ namespace Math
         // -x * y = -(x * y)
         if(this->left->getType() == TypeNode::Minus)
         {
-            auto* left = dynamic_cast<Minus<Type>*>(this->left.get());
+            auto* left = nodeCast<Minus<Type>>(this->left.get());
             return std::make_unique<Minus<Type>>(
                 std::make_unique<Multiplication>(
                     left->argument,
@@ -327,7 +318,7 @@ namespace Math
         // x * -y = -(x * y)
         if(this->right->getType() == TypeNode::Minus)
         {
-            auto* right = dynamic_cast<Minus<Type>*>(this->right.get());
+            auto* right = nodeCast<Minus<Type>>(this->right.get());
             return std::make_unique<Minus<Type>>(
                 std::make_unique<Multiplication>(
                     this->left,
@@ -339,8 +330,8 @@ namespace Math
         // a / x * b / y = (a * b) / (x * y)
         if(this->left->getType() == TypeNode::Division && this->right->getType() == TypeNode::Division)
         {
-            auto* left = dynamic_cast<Division<Type>*>(this->left.get());
-            auto* right = dynamic_cast<Division<Type>*>(this->right.get());
+            auto* left = nodeCast<Division<Type>>(this->left.get());
+            auto* right = nodeCast<Division<Type>>(this->right.get());
             return std::make_unique<Division<Type>>(
                 std::make_unique<Multiplication<Type>>(
                     left->left,
@@ -356,7 +347,7 @@ namespace Math
         // (a / b) * c = (a * c) / b
         if(this->left->getType() == TypeNode::Division)
         {
-            auto* left = dynamic_cast<Division<Type>*>(this->left.get());
+            auto* left = nodeCast<Division<Type>>(this->left.get());
             return std::make_unique<Division<Type>>(
                 std::make_unique<Multiplication>(
                     left->left,
@@ -369,7 +360,7 @@ namespace Math
         // a * (b / c) = (a * b) / c
         if(this->right->getType() == TypeNode::Division)
         {
-            auto* right = dynamic_cast<Division<Type>*>(this->right.get());
+            auto* right = nodeCast<Division<Type>>(this->right.get());
             return std::make_unique<Division<Type>>(
                 std::make_unique<Multiplication>(
                     this->left,
@@ -381,7 +372,7 @@ namespace Math
 
         if(this->right->getType() == TypeNode::Division)
         {
-            auto* right = dynamic_cast<Division<Type>*>(this->right.get());
+            auto* right = nodeCast<Division<Type>>(this->right.get());
             // x * a / x = a
             if(this->left->equal(right->right))
             {
@@ -389,7 +380,7 @@ namespace Math
             }
             if(this->left->getType() == TypeNode::Power)
             {
-                auto* pow1 = dynamic_cast<Power<Type>*>(this->left.get());
+                auto* pow1 = nodeCast<Power<Type>>(this->left.get());
                 // x^b * a / x = a * x^(b - 1)
                 if(right->right->equal(pow1->left))
                 {
@@ -407,7 +398,7 @@ namespace Math
                 // x^b * a / x^c = a * x^(b - c)
                 if(right->right->getType() == TypeNode::Power)
                 {
-                    auto* pow2 = dynamic_cast<Power<Type>*>(right->right.get());
+                    auto* pow2 = nodeCast<Power<Type>>(right->right.get());
                     if(pow1->left->equal(pow2->left))
                     {
                         return std::make_unique<Multiplication>(
@@ -427,10 +418,10 @@ namespace Math
 
         if(this->left->getType() == TypeNode::Multiplication)
         {
-            auto* left = dynamic_cast<Multiplication*>(this->left.get());
+            auto* left = nodeCast<Multiplication>(this->left.get());
             if(left->right->getType() == TypeNode::Power)
             {
-                auto* pow1 = dynamic_cast<Power<Type>*>(left->right.get());
+                auto* pow1 = nodeCast<Power<Type>>(left->right.get());
                 // (a * x^b) * x = a * x^(b + 1)
                 if(this->right->equal(pow1->left))
                 {
@@ -448,7 +439,7 @@ namespace Math
                 // (a * x^b) * x^c = a * x^(b + c)
                 if(this->right->getType() == TypeNode::Power)
                 {
-                    auto* pow2 = dynamic_cast<Power<Type>*>(this->right.get());
+                    auto* pow2 = nodeCast<Power<Type>>(this->right.get());
                     if(pow2->left->equal(pow1->left))
                     {
                         return std::make_unique<Multiplication>(
@@ -466,7 +457,7 @@ namespace Math
             }
             if(left->left->getType() == TypeNode::Power)
             {
-                auto* pow1 = dynamic_cast<Power<Type>*>(left->left.get());
+                auto* pow1 = nodeCast<Power<Type>>(left->left.get());
                 // (x^b * a) * x = a * x^(b + 1)
                 if(this->right->equal(pow1->left))
                 {
@@ -484,7 +475,7 @@ namespace Math
                 // (x^b * a) * x^c = a * x^(b + c)
                 if(this->right->getType() == TypeNode::Power)
                 {
-                    auto* pow2 = dynamic_cast<Power<Type>*>(this->right.get());
+                    auto* pow2 = nodeCast<Power<Type>>(this->right.get());
                     if(pow2->left->equal(pow1->left))
                     {
                         return std::make_unique<Multiplication>(
@@ -526,10 +517,10 @@ namespace Math
 
         if(this->right->getType() == TypeNode::Multiplication)
         {
-            auto* right = dynamic_cast<Multiplication*>(this->right.get());
+            auto* right = nodeCast<Multiplication>(this->right.get());
             if(right->right->getType() == TypeNode::Power)
             {
-                auto* pow1 = dynamic_cast<Power<Type>*>(right->right.get());
+                auto* pow1 = nodeCast<Power<Type>>(right->right.get());
                 // x * (a * x^b) = a * x^(b + 1)
                 if(this->left->equal(pow1->left))
                 {
@@ -547,7 +538,7 @@ namespace Math
                 // x^c * (a * x^b) = a * x^(b + c)
                 if(this->left->getType() == TypeNode::Power)
                 {
-                    auto* pow2 = dynamic_cast<Power<Type>*>(this->left.get());
+                    auto* pow2 = nodeCast<Power<Type>>(this->left.get());
                     if(pow2->left->equal(pow1->left))
                     {
                         return std::make_unique<Multiplication>(
@@ -565,7 +556,7 @@ namespace Math
             }
             if(right->left->getType() == TypeNode::Power)
             {
-                auto* pow1 = dynamic_cast<Power<Type>*>(right->left.get());
+                auto* pow1 = nodeCast<Power<Type>>(right->left.get());
                 // x * (x^b * a) = a * x^(b + 1)
                 if(this->left->equal(pow1->left))
                 {
@@ -583,7 +574,7 @@ namespace Math
                 // x^c * (x^b * a) = a * x^(b + c)
                 if(this->left->getType() == TypeNode::Power)
                 {
-                    auto* pow2 = dynamic_cast<Power<Type>*>(this->left.get());
+                    auto* pow2 = nodeCast<Power<Type>>(this->left.get());
                     if(pow2->left->equal(pow1->left))
                     {
                         return std::make_unique<Multiplication>(
@@ -625,7 +616,7 @@ namespace Math
 
         if(this->left->getType() == TypeNode::Power)
         {
-            auto* left = dynamic_cast<Power<Type>*>(this->left.get());
+            auto* left = nodeCast<Power<Type>>(this->left.get());
             // x^a * x = x^(a + 1)
             if(this->right->equal(left->left))
             {
@@ -640,7 +631,7 @@ namespace Math
             // x^a * x^b = x^(a + b)
             if(this->right->getType() == TypeNode::Power)
             {
-                auto* right = dynamic_cast<Power<Type>*>(this->right.get());
+                auto* right = nodeCast<Power<Type>>(this->right.get());
                 if(left->left->equal(right->left))
                 {
                     return std::make_unique<Power<Type>>(
@@ -656,7 +647,7 @@ namespace Math
 
         if(this->right->getType() == TypeNode::Power)
         {
-            auto* right = dynamic_cast<Power<Type>*>(this->right.get());
+            auto* right = nodeCast<Power<Type>>(this->right.get());
             // x * x^a = x^(a + 1)
             if(this->left->equal(right->left))
             {
@@ -670,7 +661,7 @@ namespace Math
             }
         }
 
-        return std::make_unique<Multiplication>(this->left, this->right);
+        return std::make_unique<Multiplication>(std::move(this->left), std::move(this->right));
     }
 } // Math
 
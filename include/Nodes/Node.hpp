@@ -2,10 +2,19 @@
 #define NODE_HPP
 
 
+#include <algorithm>
 #include <memory>
 #include <complex>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "../VariableSet.hpp"
+
 
 namespace Math
 {
@@ -67,30 +76,18 @@ namespace Math
 
 
     template<typename Type>
-    class Node
-    {
-    public:
-        virtual ~Node() = default;
-
-        virtual std::unique_ptr<Node> makeCopy() = 0;
-
-        virtual Priority getPriority() = 0;
+    class Node;
 
-        virtual TypeNode getType() = 0;
 
-        virtual bool equal(std::unique_ptr<Node>& ptr) = 0;
-
-        virtual std::string toString() = 0;
-
-        virtual std::unique_ptr<Node> substitute(const std::string& variable, const std::unique_ptr<Node>& expression) = 0;
-
-        virtual Type calculate(const std::vector<std::string>& variable, const std::vector<Type>& value) = 0;
-
-        virtual std::unique_ptr<Node> differentiate(const std::string& variable) = 0;
-
-        virtual std::unique_ptr<Node> simplify() = 0;
+    // Simultaneous replacement of several variables, keyed by interned id
+    template<typename Type>
+    struct Substitution
+    {
+        VariableSet variables;
+        std::unordered_map<std::size_t, Node<Type>*> expressions;
     };
 
+
     template<typename Type>
     class Number;
 
@@ -126,6 +123,662 @@ namespace Math
 
     template<typename Type>
     class Ln;
+
+    template<typename Type>
+    class SimplifyCache;
+
+    class TaskPool;
+
+
+    // Calls visitor with the node cast to its own final class. The set of node kinds is
+    // closed, so a switch on the stored type replaces virtual calls and dynamic_cast.
+    template<typename Type, typename Visitor>
+    decltype(auto) visit(Node<Type>& node, Visitor&& visitor);
+
+    template<typename Type, typename Visitor>
+    decltype(auto) visit(const Node<Type>& node, Visitor&& visitor);
+
+    // The node as Kind, or nullptr if it is of another kind
+    template<typename Kind, typename Type>
+    Kind* nodeCast(Node<Type>* node);
+
+    template<typename Kind, typename Type>
+    const Kind* nodeCast(const Node<Type>* node);
+
+
+    // The operations on a whole tree walk it with an explicit stack, so their stack use
+    // does not depend on the depth of the tree. Every node kind implements only the step
+    // for itself, given the results for its operands:
+    //     make(operands), format(operands), evaluate(operands, variable, value),
+    //     derive(variable, derivatives), rewrite() and getPriority(), see visit.
+    // Only rewrite changes a node, and only a node simplify has just made, so a tree
+    // can be read from several threads at once.
+    template<typename Type>
+    class Node
+    {
+    public:
+        virtual ~Node() = default;
+
+        std::unique_ptr<Node> makeCopy() const;
+
+        Priority getPriority() const;
+
+        [[nodiscard]] TypeNode getType() const;
+
+        bool equal(const std::unique_ptr<Node>& ptr) const;
+        bool equal(const Node& other) const;
+
+        std::string toString() const;
+
+        std::unique_ptr<Node> substitute(const Substitution<Type>& substitution) const;
+
+        Type calculate(const std::vector<std::string>& variable, const std::vector<Type>& value) const;
+
+        std::unique_ptr<Node> differentiate(const std::string& variable) const;
+
+        // The result is a new tree, this one is left as it is
+        std::unique_ptr<Node> simplify() const;
+
+        // Same result, the subtrees found in the cache are not simplified again
+        std::unique_ptr<Node> simplify(SimplifyCache<Type>& cache) const;
+
+        // Same result, subtrees of at least threshold nodes are simplified as tasks of pool.
+        // Defined in Expression.hpp, so this header does not pull in the threads.
+        std::unique_ptr<Node> simplify(TaskPool& pool, std::size_t threshold = 1024) const;
+
+        // Collected from the leaves on each call, the nodes keep only the summary
+        [[nodiscard]] VariableSet getVariables() const;
+
+        // Bit id % 64 of every variable of the tree, a clear bit rules the variable out
+        [[nodiscard]] std::uint64_t getSummary() const;
+
+        // Structural hash and number of nodes of the tree, kept since construction.
+        // Equal trees hash equally, including numbers 0 and -0.
+        [[nodiscard]] std::uint64_t getHash() const;
+        [[nodiscard]] std::size_t getSize() const;
+
+        [[nodiscard]] bool depends(const std::string& variable) const;
+
+        // Same as toString() == text for the numbers the simplification rules look for,
+        // without printing a large operand
+        bool printsAs(const std::string& text) const;
+
+        // Operands in order, none for Number and Variable
+        std::size_t countChildren() const;
+        std::unique_ptr<Node>& getChild(std::size_t index);
+        const std::unique_ptr<Node>& getChild(std::size_t index) const;
+
+        // Same kind, the operands are not compared. Number and Variable also compare the value or name.
+        bool same(const Node& other) const;
+
+    protected:
+        explicit Node(TypeNode type);
+
+        // Destroys the operands without one destructor call per level
+        void release();
+
+        // Sets summary, hash and size from the value or the operands, the constructors call it last
+        void summarize();
+
+        std::uint64_t summary = 0;
+        std::uint64_t hash = 0;
+        std::size_t size = 1;
+
+    private:
+        const TypeNode type;
+
+        // Post-order walk: visit gets the node and the results of its operands, or nullptr
+        // for a leaf and for a node whose operands descend rejected
+        template<typename Result, typename Descend, typename Visit>
+        Result fold(Descend descend, Visit visit) const;
+    };
+
+
+    template<typename Type>
+    Node<Type>::Node(TypeNode type)
+        : type(type)
+    {
+    }
+
+
+    template<typename Type>
+    TypeNode Node<Type>::getType() const
+    {
+        return this->type;
+    }
+
+
+    template<typename Type>
+    Priority Node<Type>::getPriority() const
+    {
+        return visit(*this, [](const auto& node) { return node.getPriority(); });
+    }
+
+
+    template<typename Type>
+    VariableSet Node<Type>::getVariables() const
+    {
+        VariableSet variables;
+        std::vector<const Node*> stack {this};
+        while(!stack.empty())
+        {
+            const Node* node = stack.back();
+            stack.pop_back();
+            if(node->type == TypeNode::Variable)
+            {
+                variables.insert(static_cast<const Variable<Type>*>(node)->id);
+            }
+            for(std::size_t i = 0; i < node->countChildren(); i++)
+            {
+                // Subtrees without variables are skipped
+                if(node->getChild(i)->summary != 0)
+                {
+                    stack.push_back(node->getChild(i).get());
+                }
+            }
+        }
+        return variables;
+    }
+
+
+    template<typename Type>
+    std::uint64_t Node<Type>::getSummary() const
+    {
+        return this->summary;
+    }
+
+
+    template<typename Type>
+    std::uint64_t Node<Type>::getHash() const
+    {
+        return this->hash;
+    }
+
+
+    template<typename Type>
+    std::size_t Node<Type>::getSize() const
+    {
+        return this->size;
+    }
+
+
+    template<typename Type>
+    bool Node<Type>::depends(const std::string& variable) const
+    {
+        const std::size_t id = findVariable(variable);
+        if(id == noVariable)
+        {
+            return false;
+        }
+
+        const std::uint64_t bit = VariableSet::bit(id);
+        std::vector<const Node*> stack {this};
+        while(!stack.empty())
+        {
+            const Node* node = stack.back();
+            stack.pop_back();
+            if(!(node->summary & bit))
+            {
+                continue;
+            }
+            if(node->type == TypeNode::Variable && static_cast<const Variable<Type>*>(node)->id == id)
+            {
+                return true;
+            }
+            for(std::size_t i = 0; i < node->countChildren(); i++)
+            {
+                stack.push_back(node->getChild(i).get());
+            }
+        }
+        return false;
+    }
+
+
+    template<typename Type>
+    bool Node<Type>::printsAs(const std::string& text) const
+    {
+        // Only a number or the negation of a number prints without spaces, letters or brackets
+        const bool number = this->getType() == TypeNode::Number
+            || (this->getType() == TypeNode::Minus && this->getChild(0)->getType() == TypeNode::Number);
+        return number && this->toString() == text;
+    }
+
+
+    template<typename Type>
+    std::size_t Node<Type>::countChildren() const
+    {
+        switch(this->type)
+        {
+            case TypeNode::Number:
+            case TypeNode::Variable:
+                return 0;
+            case TypeNode::Minus:
+            case TypeNode::Sin:
+            case TypeNode::Cos:
+            case TypeNode::Exp:
+            case TypeNode::Ln:
+                return 1;
+            default:
+                return 2;
+        }
+    }
+
+
+    template<typename Type>
+    std::unique_ptr<Node<Type>>& Node<Type>::getChild(std::size_t index)
+    {
+        return visit(*this, [index](auto& node) -> std::unique_ptr<Node>& {
+            if constexpr(requires { node.left; })
+            {
+                return index == 0 ? node.left : node.right;
+            }
+            else if constexpr(requires { node.argument; })
+            {
+                return node.argument;
+            }
+            else
+            {
+                throw std::invalid_argument("The node has no operands");
+            }
+        });
+    }
+
+
+    template<typename Type>
+    const std::unique_ptr<Node<Type>>& Node<Type>::getChild(std::size_t index) const
+    {
+        return const_cast<Node&>(*this).getChild(index);
+    }
+
+
+    template<typename Type>
+    bool Node<Type>::same(const Node& other) const
+    {
+        if(this->type != other.type)
+        {
+            return false;
+        }
+        switch(this->type)
+        {
+            case TypeNode::Number:
+                return static_cast<const Number<Type>&>(*this).value == static_cast<const Number<Type>&>(other).value;
+            case TypeNode::Variable:
+                return static_cast<const Variable<Type>&>(*this).name == static_cast<const Variable<Type>&>(other).name;
+            default:
+                return true;
+        }
+    }
+
+
+    template<typename Type>
+    template<typename Result, typename Descend, typename Visit>
+    Result Node<Type>::fold(Descend descend, Visit visit) const
+    {
+        struct Frame
+        {
+            const Node* node;
+            std::size_t next;
+            std::size_t count;
+        };
+
+        std::vector<Frame> stack {{this, 0, descend(*this) ? this->countChildren() : 0}};
+        std::vector<Result> results;
+        while(true)
+        {
+            Frame& frame = stack.back();
+            if(frame.next < frame.count)
+            {
+                const Node* child = frame.node->getChild(frame.next++).get();
+                stack.push_back({child, 0, descend(*child) ? child->countChildren() : 0});
+                continue;
+            }
+
+            Result* operands = frame.count > 0 ? results.data() + results.size() - frame.count : nullptr;
+            Result result = visit(*frame.node, operands);
+            results.erase(results.end() - frame.count, results.end());
+            stack.pop_back();
+            if(stack.empty())
+            {
+                return result;
+            }
+            results.push_back(std::move(result));
+        }
+    }
+
+
+    template<typename Type>
+    std::unique_ptr<Node<Type>> Node<Type>::makeCopy() const
+    {
+        return this->fold<std::unique_ptr<Node>>(
+            [](const Node&) { return true; },
+            [](const Node& node, std::unique_ptr<Node>* operands) {
+                return visit(node, [operands](const auto& self) { return self.make(operands); });
+            }
+        );
+    }
+
+
+    template<typename Type>
+    bool Node<Type>::equal(const std::unique_ptr<Node>& ptr) const
+    {
+        return this->equal(*ptr);
+    }
+
+
+    template<typename Type>
+    bool Node<Type>::equal(const Node& other) const
+    {
+        if(!this->same(other))
+        {
+            return false;
+        }
+        if(this->countChildren() == 0)
+        {
+            return true;
+        }
+
+        std::vector<std::pair<const Node*, const Node*>> stack {{this, &other}};
+        while(!stack.empty())
+        {
+            auto [first, second] = stack.back();
+            stack.pop_back();
+            if(!first->same(*second))
+            {
+                return false;
+            }
+            for(std::size_t i = first->countChildren(); i-- > 0;)
+            {
+                stack.emplace_back(first->getChild(i).get(), second->getChild(i).get());
+            }
+        }
+        return true;
+    }
+
+
+    template<typename Type>
+    std::string Node<Type>::toString() const
+    {
+        return this->fold<std::string>(
+            [](const Node&) { return true; },
+            [](const Node& node, std::string* operands) {
+                return visit(node, [operands](const auto& self) { return self.format(operands); });
+            }
+        );
+    }
+
+
+    template<typename Type>
+    std::unique_ptr<Node<Type>> Node<Type>::substitute(const Substitution<Type>& substitution) const
+    {
+        // nullptr stands for a subtree left as it is, it is copied once its parent changes
+        const std::uint64_t summary = substitution.variables.getSummary();
+        std::unique_ptr<Node> result = this->fold<std::unique_ptr<Node>>(
+            [summary](const Node& node) { return (node.summary & summary) != 0; },
+            [&substitution, summary](const Node& node, std::unique_ptr<Node>* operands) -> std::unique_ptr<Node> {
+                if(node.getType() == TypeNode::Variable)
+                {
+                    auto iter = substitution.expressions.find(static_cast<const Variable<Type>&>(node).id);
+                    return iter == substitution.expressions.end() ? nullptr : iter->second->makeCopy();
+                }
+                if(!(node.summary & summary) || operands == nullptr)
+                {
+                    return nullptr;
+                }
+
+                bool changed = false;
+                for(std::size_t i = 0; i < node.countChildren(); i++)
+                {
+                    changed = changed || operands[i] != nullptr;
+                }
+                if(!changed)
+                {
+                    return nullptr;
+                }
+                for(std::size_t i = 0; i < node.countChildren(); i++)
+                {
+                    if(!operands[i])
+                    {
+                        operands[i] = node.getChild(i)->makeCopy();
+                    }
+                }
+                return visit(node, [operands](const auto& self) { return self.make(operands); });
+            }
+        );
+        return result ? std::move(result) : this->makeCopy();
+    }
+
+
+    template<typename Type>
+    Type Node<Type>::calculate(const std::vector<std::string>& variable, const std::vector<Type>& value) const
+    {
+        return this->fold<Type>(
+            [](const Node&) { return true; },
+            [&variable, &value](const Node& node, Type* operands) {
+                return visit(node, [&](const auto& self) { return self.evaluate(operands, variable, value); });
+            }
+        );
+    }
+
+
+    template<typename Type>
+    std::unique_ptr<Node<Type>> Node<Type>::differentiate(const std::string& variable) const
+    {
+        // nullptr stands for a zero derivative, so subtrees without the variable are not copied
+        const std::size_t id = findVariable(variable);
+        const std::uint64_t bit = id == noVariable ? 0 : VariableSet::bit(id);
+        std::unique_ptr<Node> result = this->fold<std::unique_ptr<Node>>(
+            [bit](const Node& node) { return (node.summary & bit) != 0; },
+            [&variable, id, bit](const Node& node, std::unique_ptr<Node>* derivatives) -> std::unique_ptr<Node> {
+                // c' = 0
+                if(node.getType() == TypeNode::Variable)
+                {
+                    const auto& self = static_cast<const Variable<Type>&>(node);
+                    return self.id == id ? self.derive(variable, derivatives) : nullptr;
+                }
+                if(!(node.summary & bit) || derivatives == nullptr)
+                {
+                    return nullptr;
+                }
+
+                bool dependent = false;
+                for(std::size_t i = 0; i < node.countChildren(); i++)
+                {
+                    dependent = dependent || derivatives[i] != nullptr;
+                }
+                if(!dependent)
+                {
+                    return nullptr;
+                }
+                for(std::size_t i = 0; i < node.countChildren(); i++)
+                {
+                    if(!derivatives[i])
+                    {
+                        derivatives[i] = std::make_unique<Number<Type>>(Type{});
+                    }
+                }
+                return visit(node, [&](const auto& self) { return self.derive(variable, derivatives); });
+            }
+        );
+        return result ? std::move(result) : std::make_unique<Number<Type>>(Type{});
+    }
+
+
+    template<typename Type>
+    std::unique_ptr<Node<Type>> Node<Type>::simplify() const
+    {
+        return this->fold<std::unique_ptr<Node>>(
+            [](const Node&) { return true; },
+            [](const Node& node, std::unique_ptr<Node>* operands) {
+                // The rules run on a new node over the simplified operands and may take them from it
+                std::unique_ptr<Node> copy = visit(node, [operands](const auto& self) { return self.make(operands); });
+                return visit(*copy, [](auto& self) { return self.rewrite(); });
+            }
+        );
+    }
+
+
+    template<typename Type>
+    std::unique_ptr<Node<Type>> Node<Type>::simplify(SimplifyCache<Type>& cache) const
+    {
+        // A subtree found in the cache is not walked into
+        std::unordered_map<const Node*, std::unique_ptr<Node>> found;
+        return this->fold<std::unique_ptr<Node>>(
+            [&](const Node& node) {
+                if(!cache.accepts(node.size))
+                {
+                    return true;
+                }
+                std::unique_ptr<Node> result = cache.find(node);
+                if(!result)
+                {
+                    return true;
+                }
+                found.emplace(&node, std::move(result));
+                return false;
+            },
+            [&](const Node& node, std::unique_ptr<Node>* operands) {
+                const bool accepted = cache.accepts(node.size);
+                if(accepted && !found.empty())
+                {
+                    auto iter = found.find(&node);
+                    if(iter != found.end())
+                    {
+                        return std::move(iter->second);
+                    }
+                }
+
+                std::unique_ptr<Node> copy = visit(node, [operands](const auto& self) { return self.make(operands); });
+                std::unique_ptr<Node> result = visit(*copy, [](auto& self) { return self.rewrite(); });
+                if(accepted)
+                {
+                    cache.insert(node, *result);
+                }
+                return result;
+            }
+        );
+    }
+
+
+    template<typename Type>
+    void Node<Type>::summarize()
+    {
+        auto mix = [](std::uint64_t seed, std::uint64_t value) {
+            seed ^= value + 0x9E3779B97F4A7C15ull + (seed << 6) + (seed >> 2);
+            return seed * 0xBF58476D1CE4E5B9ull;
+        };
+
+        this->hash = mix(0, static_cast<std::uint64_t>(this->type));
+        this->size = 1;
+        switch(this->type)
+        {
+            case TypeNode::Number:
+            {
+                // Hashed by value, so 0 and -0 hash equally as they compare equal
+                const Type& value = static_cast<const Number<Type>*>(this)->value;
+                using Part = decltype(std::real(value));
+                this->hash = mix(this->hash, std::hash<Part>{}(std::real(value)));
+                this->hash = mix(this->hash, std::hash<Part>{}(std::imag(value)));
+                break;
+            }
+            case TypeNode::Variable:
+            {
+                const std::size_t id = static_cast<const Variable<Type>*>(this)->id;
+                this->hash = mix(this->hash, id);
+                this->summary = VariableSet::bit(id);
+                break;
+            }
+            default:
+                this->summary = 0;
+                for(std::size_t i = 0; i < this->countChildren(); i++)
+                {
+                    const Node& child = *this->getChild(i);
+                    this->summary |= child.summary;
+                    this->hash = mix(this->hash, child.hash);
+                    this->size += child.size;
+                }
+        }
+    }
+
+
+    template<typename Type>
+    void Node<Type>::release()
+    {
+        std::vector<std::unique_ptr<Node>> stack;
+        auto detach = [&stack](Node& node) {
+            for(std::size_t i = 0; i < node.countChildren(); i++)
+            {
+                std::unique_ptr<Node>& child = node.getChild(i);
+                if(child && child->countChildren() > 0)
+                {
+                    stack.push_back(std::move(child));
+                }
+            }
+        };
+
+        detach(*this);
+        while(!stack.empty())
+        {
+            std::unique_ptr<Node> node = std::move(stack.back());
+            stack.pop_back();
+            detach(*node);
+        }
+    }
+
+
+    template<typename Type, typename Visitor>
+    decltype(auto) visit(Node<Type>& node, Visitor&& visitor)
+    {
+        switch(node.getType())
+        {
+            case TypeNode::Number:
+                return visitor(static_cast<Number<Type>&>(node));
+            case TypeNode::Variable:
+                return visitor(static_cast<Variable<Type>&>(node));
+            case TypeNode::Addition:
+                return visitor(static_cast<Addition<Type>&>(node));
+            case TypeNode::Subtraction:
+                return visitor(static_cast<Subtraction<Type>&>(node));
+            case TypeNode::Minus:
+                return visitor(static_cast<Minus<Type>&>(node));
+            case TypeNode::Multiplication:
+                return visitor(static_cast<Multiplication<Type>&>(node));
+            case TypeNode::Division:
+                return visitor(static_cast<Division<Type>&>(node));
+            case TypeNode::Power:
+                return visitor(static_cast<Power<Type>&>(node));
+            case TypeNode::Sin:
+                return visitor(static_cast<Sin<Type>&>(node));
+            case TypeNode::Cos:
+                return visitor(static_cast<Cos<Type>&>(node));
+            case TypeNode::Exp:
+                return visitor(static_cast<Exp<Type>&>(node));
+            default:
+                return visitor(static_cast<Ln<Type>&>(node));
+        }
+    }
+
+
+    template<typename Type, typename Visitor>
+    decltype(auto) visit(const Node<Type>& node, Visitor&& visitor)
+    {
+        return visit(const_cast<Node<Type>&>(node), [&visitor](auto& self) -> decltype(auto) {
+            return visitor(std::as_const(self));
+        });
+    }
+
+
+    template<typename Kind, typename Type>
+    Kind* nodeCast(Node<Type>* node)
+    {
+        return node->getType() == Kind::kind ? static_cast<Kind*>(node) : nullptr;
+    }
+
+
+    template<typename Kind, typename Type>
+    const Kind* nodeCast(const Node<Type>* node)
+    {
+        return node->getType() == Kind::kind ? static_cast<const Kind*>(node) : nullptr;
+    }
 } // Math
 
 
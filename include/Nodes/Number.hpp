@@ -14,26 +14,22 @@ namespace Math
     class Number final : public Node<Type>
     {
     public:
+        static constexpr TypeNode kind = TypeNode::Number;
+
         Number(const Number& number);
         explicit Number(Type value);
 
-        std::unique_ptr<Node<Type>> makeCopy() override;
-
-        Priority getPriority() override;
-
-        TypeNode getType() override;
+        Priority getPriority() const;
 
-        bool equal(std::unique_ptr<Node<Type>>& ptr) override;
+        std::unique_ptr<Node<Type>> make(std::unique_ptr<Node<Type>>* operands) const;
 
-        std::string toString() override;
+        std::string format(std::string* operands) const;
 
-        std::unique_ptr<Node<Type>> substitute(const std::string& variable, const std::unique_ptr<Node<Type>>& expression) override;
+        Type evaluate(const Type* operands, const std::vector<std::string>& variable, const std::vector<Type>& value) const;
 
-        Type calculate(const std::vector<std::string>& variable, const std::vector<Type>& value) override;
+        std::unique_ptr<Node<Type>> derive(const std::string& variable, std::unique_ptr<Node<Type>>* derivatives) const;
 
-        std::unique_ptr<Node<Type>> differentiate(const std::string& variable) override;
-
-        std::unique_ptr<Node<Type>> simplify() override;
+        std::unique_ptr<Node<Type>> rewrite();
 
         Type value;
     };
@@ -44,41 +40,37 @@ namespace Math
 {
     template<typename Type>
     Number<Type>::Number(const Number &number)
+        : Node<Type>(TypeNode::Number)
     {
         this->value = number.value;
+        this->summarize();
     }
 
 
     template<typename Type>
     Number<Type>::Number(Type value)
-        : value(value)
+        : Node<Type>(TypeNode::Number), value(value)
     {
+        this->summarize();
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Number<Type>::makeCopy()
+    std::unique_ptr<Node<Type>> Number<Type>::make(std::unique_ptr<Node<Type>>* operands) const
     {
         return std::make_unique<Number>(this->value);
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Number<Type>::substitute(const std::string &variable, const std::unique_ptr<Node<Type>>& expression)
-    {
-        return std::make_unique<Number>(*this);
-    }
-
-
-    template<typename Type>
-    Type Number<Type>::calculate(const std::vector<std::string>& variable, const std::vector<Type>& value)
+    Type Number<Type>::evaluate(const Type* operands, const std::vector<std::string>& variable, const std::vector<Type>& value) const
     {
         return this->value;
     }
 
 
     template<typename Type>
-    Priority Number<Type>::getPriority()
+    Priority Number<Type>::getPriority() const
     {
         if(std::is_same_v<Type, std::complex<float>> ||
            std::is_same_v<Type, std::complex<double>> ||
@@ -97,26 +89,7 @@ namespace Math
 
 
     template<typename Type>
-    TypeNode Number<Type>::getType()
-    {
-        return TypeNode::Number;
-    }
-
-
-    template<typename Type>
-    bool Number<Type>::equal(std::unique_ptr<Node<Type>>& ptr)
-    {
-        if(this->getType() == ptr->getType())
-        {
-            auto* number = dynamic_cast<Number*>(ptr.get());
-            return this->value == number->value;
-        }
-        return false;
-    }
-
-
-    template<typename Type>
-    std::string Number<Type>::toString()
+    std::string Number<Type>::format(std::string* operands) const
     {
         if(std::is_same_v<Type, std::complex<float>> ||
            std::is_same_v<Type, std::complex<double>> ||
@@ -175,14 +148,14 @@ namespace Math
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Number<Type>::differentiate(const std::string &variable)
+    std::unique_ptr<Node<Type>> Number<Type>::derive(const std::string& variable, std::unique_ptr<Node<Type>>* derivatives) const
     {
         return std::make_unique<Number<Type>>(Type{});
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Number<Type>::simplify()
+    std::unique_ptr<Node<Type>> Number<Type>::rewrite()
     {
         return std::make_unique<Number>(*this);
     }
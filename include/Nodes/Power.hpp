@@ -11,26 +11,25 @@ namespace Math
     class Power final : public Node<Type>
     {
     public:
+        static constexpr TypeNode kind = TypeNode::Power;
+
         Power(const Power& power);
         Power(const std::unique_ptr<Node<Type>>& left, const std::unique_ptr<Node<Type>>& right);
+        Power(std::unique_ptr<Node<Type>>&& left, std::unique_ptr<Node<Type>>&& right);
 
-        std::unique_ptr<Node<Type>> makeCopy() override;
-
-        Priority getPriority() override;
-
-        TypeNode getType() override;
+        ~Power() override;
 
-        bool equal(std::unique_ptr<Node<Type>>& ptr) override;
+        Priority getPriority() const;
 
-        std::string toString() override;
+        std::unique_ptr<Node<Type>> make(std::unique_ptr<Node<Type>>* operands) const;
 
-        std::unique_ptr<Node<Type>> substitute(const std::string& variable, const std::unique_ptr<Node<Type>>& expression) override;
+        std::string format(std::string* operands) const;
 
-        Type calculate(const std::vector<std::string>& variable, const std::vector<Type>& value) override;
+        Type evaluate(const Type* operands, const std::vector<std::string>& variable, const std::vector<Type>& value) const;
 
-        std::unique_ptr<Node<Type>> differentiate(const std::string& variable) override;
+        std::unique_ptr<Node<Type>> derive(const std::string& variable, std::unique_ptr<Node<Type>>* derivatives) const;
 
-        std::unique_ptr<Node<Type>> simplify() override;
+        std::unique_ptr<Node<Type>> rewrite();
 
         std::unique_ptr<Node<Type>> left;
         std::unique_ptr<Node<Type>> right;
@@ -42,40 +41,54 @@ namespace Math
 {
     template<typename Type>
     Power<Type>::Power(const Power& power)
+        : Node<Type>(TypeNode::Power)
     {
         this->left = power.left->makeCopy();
         this->right = power.right->makeCopy();
+        this->summarize();
     }
 
 
     template<typename Type>
     Power<Type>::Power(const std::unique_ptr<Node<Type>>& left, const std::unique_ptr<Node<Type>>& right)
+        : Node<Type>(TypeNode::Power)
     {
         this->left = left->makeCopy();
         this->right = right->makeCopy();
+        this->summarize();
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Power<Type>::makeCopy()
+    Power<Type>::Power(std::unique_ptr<Node<Type>>&& left, std::unique_ptr<Node<Type>>&& right)
+        : Node<Type>(TypeNode::Power)
     {
-        return std::make_unique<Power>(this->left, this->right);
+        this->left = std::move(left);
+        this->right = std::move(right);
+        this->summarize();
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Power<Type>::substitute(const std::string& variable, const std::unique_ptr<Node<Type>>& expression)
+    Power<Type>::~Power()
     {
-        return std::make_unique<Power>(this->left->substitute(variable, expression), this->right->substitute(variable, expression));
+        this->release();
     }
 
 
     template<typename Type>
-    Type Power<Type>::calculate(const std::vector<std::string>& variable, const std::vector<Type>& value)
+    std::unique_ptr<Node<Type>> Power<Type>::make(std::unique_ptr<Node<Type>>* operands) const
+    {
+        return std::make_unique<Power>(std::move(operands[0]), std::move(operands[1]));
+    }
+
+
+    template<typename Type>
+    Type Power<Type>::evaluate(const Type* operands, const std::vector<std::string>& variable, const std::vector<Type>& value) const
     {
         try
         {
-            return std::pow(this->left->calculate(variable, value), this->right->calculate(variable, value));
+            return std::pow(operands[0], operands[1]);
         }
         catch(...)
         {
@@ -85,36 +98,17 @@ namespace Math
 
 
     template<typename Type>
-    Priority Power<Type>::getPriority()
+    Priority Power<Type>::getPriority() const
     {
         return Priority::Power;
     }
 
 
     template<typename Type>
-    TypeNode Power<Type>::getType()
+    std::string Power<Type>::format(std::string* operands) const
     {
-        return TypeNode::Power;
-    }
-
-
-    template<typename Type>
-    bool Power<Type>::equal(std::unique_ptr<Node<Type>>& ptr)
-    {
-        if(this->getType() == ptr->getType())
-        {
-            auto* power = dynamic_cast<Power*>(ptr.get());
-            return this->left->equal(power->left) && this->right->equal(power->right);
-        }
-        return false;
-    }
-
-
-    template<typename Type>
-    std::string Power<Type>::toString()
-    {
-        std::string left = this->left->toString();
-        std::string right = this->right->toString();
+        std::string left = std::move(operands[0]);
+        std::string right = std::move(operands[1]);
         if(left.front() == '-' || this->left->getPriority() <= this->getPriority())
         {
             left = "(" + left + ")";
@@ -128,20 +122,20 @@ namespace Math
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Power<Type>::differentiate(const std::string &variable)
+    std::unique_ptr<Node<Type>> Power<Type>::derive(const std::string& variable, std::unique_ptr<Node<Type>>* derivatives) const
     {
         return std::make_unique<Multiplication<Type>>(
             std::make_unique<Addition<Type>>(
                 std::make_unique<Division<Type>>(
                     std::make_unique<Multiplication<Type>>(
-                        this->right,
-                        this->left->differentiate(variable)
+                        this->right->makeCopy(),
+                        std::move(derivatives[0])
                     ),
-                    this->left
+                    this->left->makeCopy()
                 ),
                 std::make_unique<Multiplication<Type>>(
-                    this->right->differentiate(variable),
-                    std::make_unique<Ln<Type>>(this->left)
+                    std::move(derivatives[1]),
+                    std::make_unique<Ln<Type>>(this->left->makeCopy())
                 )
             ),
             this->makeCopy()
@@ -150,36 +144,33 @@ namespace Math
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Power<Type>::simplify()
+    std::unique_ptr<Node<Type>> Power<Type>::rewrite()
     {
-        this->left = this->left->simplify();
-        this->right = this->right->simplify();
-
         // 0^x = 0
-        if((this->left->toString() == "0" || this->left->toString() == "-0")
-           && !(this->right->toString() == "0" || this->right->toString() == "-0"))
+        if((this->left->printsAs("0") || this->left->printsAs("-0"))
+           && !(this->right->printsAs("0") || this->right->printsAs("-0")))
         {
-            return this->left->makeCopy();
+            return std::move(this->left);
         }
         // 1^x = 1
-        if(this->left->toString() == "1")
+        if(this->left->printsAs("1"))
         {
-            return this->left->makeCopy();
+            return std::move(this->left);
         }
         // x^1 = x
-        if(this->right->toString() == "1")
+        if(this->right->printsAs("1"))
         {
-            return this->left->makeCopy();
+            return std::move(this->left);
         }
         // x^0 = 1
-        if(this->right->toString() == "0" || this->right->toString() == "-0")
+        if(this->right->printsAs("0") || this->right->printsAs("-0"))
         {
             return std::make_unique<Number<Type>>(getNumber<Type>(1.0));
         }
 
         if(this->left->getType() == TypeNode::Power)
         {
-            auto* left = dynamic_cast<Power*>(this->left.get());
+            auto* left = nodeCast<Power>(this->left.get());
             return std::make_unique<Power>(
                 left->left,
                 std::make_unique<Multiplication<Type>>(
@@ -189,7 +180,7 @@ namespace Math
             )->simplify();
         }
 
-        return std::make_unique<Power>(this->left, this->right);
+        return std::make_unique<Power>(std::move(this->left), std::move(this->right));
     }
 } // Math
 
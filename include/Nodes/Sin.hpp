@@ -14,26 +14,25 @@ namespace Math
     class Sin final : public Node<Type>
     {
     public:
+        static constexpr TypeNode kind = TypeNode::Sin;
+
         Sin(const Sin& sin);
         explicit Sin(const std::unique_ptr<Node<Type>>& argument);
+        explicit Sin(std::unique_ptr<Node<Type>>&& argument);
 
-        std::unique_ptr<Node<Type>> makeCopy() override;
-
-        Priority getPriority() override;
+        ~Sin() override;
 
-        TypeNode getType() override;
+        Priority getPriority() const;
 
-        bool equal(std::unique_ptr<Node<Type>>& ptr) override;
+        std::unique_ptr<Node<Type>> make(std::unique_ptr<Node<Type>>* operands) const;
 
-        std::string toString() override;
+        std::string format(std::string* operands) const;
 
-        std::unique_ptr<Node<Type>> substitute(const std::string& variable, const std::unique_ptr<Node<Type>>& expression) override;
+        Type evaluate(const Type* operands, const std::vector<std::string>& variable, const std::vector<Type>& value) const;
 
-        Type calculate(const std::vector<std::string>& variable, const std::vector<Type>& value) override;
+        std::unique_ptr<Node<Type>> derive(const std::string& variable, std::unique_ptr<Node<Type>>* derivatives) const;
 
-        std::unique_ptr<Node<Type>> differentiate(const std::string& variable) override;
-
-        std::unique_ptr<Node<Type>> simplify() override;
+        std::unique_ptr<Node<Type>> rewrite();
 
         std::unique_ptr<Node<Type>> argument;
     };
@@ -44,87 +43,79 @@ namespace Math
 {
     template<typename Type>
     Sin<Type>::Sin(const Sin& sin)
+        : Node<Type>(TypeNode::Sin)
     {
         this->argument = sin.argument->makeCopy();
+        this->summarize();
     }
 
 
     template<typename Type>
     Sin<Type>::Sin(const std::unique_ptr<Node<Type>>& argument)
+        : Node<Type>(TypeNode::Sin)
     {
         this->argument = argument->makeCopy();
+        this->summarize();
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Sin<Type>::makeCopy()
+    Sin<Type>::Sin(std::unique_ptr<Node<Type>>&& argument)
+        : Node<Type>(TypeNode::Sin)
     {
-        return std::make_unique<Sin>(this->argument);
+        this->argument = std::move(argument);
+        this->summarize();
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Sin<Type>::substitute(const std::string& variable, const std::unique_ptr<Node<Type>>& expression)
+    Sin<Type>::~Sin()
     {
-        return std::make_unique<Sin>(this->argument->substitute(variable, expression));
+        this->release();
     }
 
 
     template<typename Type>
-    Type Sin<Type>::calculate(const std::vector<std::string>& variable, const std::vector<Type>& value)
+    std::unique_ptr<Node<Type>> Sin<Type>::make(std::unique_ptr<Node<Type>>* operands) const
     {
-        return std::sin(this->argument->calculate(variable, value));
+        return std::make_unique<Sin>(std::move(operands[0]));
     }
 
 
     template<typename Type>
-    Priority Sin<Type>::getPriority()
+    Type Sin<Type>::evaluate(const Type* operands, const std::vector<std::string>& variable, const std::vector<Type>& value) const
     {
-        return Priority::Sin;
+        return std::sin(operands[0]);
     }
 
 
     template<typename Type>
-    TypeNode Sin<Type>::getType()
+    Priority Sin<Type>::getPriority() const
     {
-        return TypeNode::Sin;
-    }
-
-
-    template<typename Type>
-    bool Sin<Type>::equal(std::unique_ptr<Node<Type>>& ptr)
-    {
-        if(this->getType() == ptr->getType())
-        {
-            Sin* sin = dynamic_cast<Sin*>(ptr.get());
-            return this->argument->equal(sin->argument);
-        }
-        return false;
+        return Priority::Sin;
     }
 
 
     template<typename Type>
-    std::string Sin<Type>::toString()
+    std::string Sin<Type>::format(std::string* operands) const
     {
-        return "sin(" + this->argument->toString() + ")";
+        return "sin(" + operands[0] + ")";
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Sin<Type>::differentiate(const std::string &variable)
+    std::unique_ptr<Node<Type>> Sin<Type>::derive(const std::string& variable, std::unique_ptr<Node<Type>>* derivatives) const
     {
         return std::make_unique<Multiplication<Type>>(
-            std::make_unique<Cos<Type>>(this->argument),
-            this->argument->differentiate(variable)
+            std::make_unique<Cos<Type>>(this->argument->makeCopy()),
+            std::move(derivatives[0])
         );
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Sin<Type>::simplify()
+    std::unique_ptr<Node<Type>> Sin<Type>::rewrite()
     {
-        this->argument = this->argument->simplify();
-
         // sin(a) = sin(a)
         if(this->argument->getType() == TypeNode::Number)
         {
@@ -139,7 +130,7 @@ namespace Math
         // sin(-x) = -sin(x)
         if(this->argument->getType() == TypeNode::Minus)
         {
-            auto* arg = dynamic_cast<Minus<Type>*>(this->argument.get());
+            auto* arg = nodeCast<Minus<Type>>(this->argument.get());
             return std::make_unique<Minus<Type>>(
                 std::make_unique<Sin>(
                     arg->argument
@@ -147,7 +138,7 @@ namespace Math
             )->simplify();
         }
 
-        return std::make_unique<Sin>(this->argument);
+        return std::make_unique<Sin>(std::move(this->argument));
     }
 } // Math
 
@@ -11,26 +11,25 @@ namespace Math
     class Subtraction final : public Node<Type>
     {
     public:
+        static constexpr TypeNode kind = TypeNode::Subtraction;
+
         Subtraction(const Subtraction& subtraction);
         Subtraction(const std::unique_ptr<Node<Type>>& left, const std::unique_ptr<Node<Type>>& right);
+        Subtraction(std::unique_ptr<Node<Type>>&& left, std::unique_ptr<Node<Type>>&& right);
 
-        std::unique_ptr<Node<Type>> makeCopy() override;
-
-        Priority getPriority() override;
+        ~Subtraction() override;
 
-        TypeNode getType() override;
+        Priority getPriority() const;
 
-        bool equal(std::unique_ptr<Node<Type>>& ptr) override;
+        std::unique_ptr<Node<Type>> make(std::unique_ptr<Node<Type>>* operands) const;
 
-        std::string toString() override;
+        std::string format(std::string* operands) const;
 
-        std::unique_ptr<Node<Type>> substitute(const std::string& variable, const std::unique_ptr<Node<Type>>& expression) override;
+        Type evaluate(const Type* operands, const std::vector<std::string>& variable, const std::vector<Type>& value) const;
 
-        Type calculate(const std::vector<std::string>& variable, const std::vector<Type>& value) override;
+        std::unique_ptr<Node<Type>> derive(const std::string& variable, std::unique_ptr<Node<Type>>* derivatives) const;
 
-        std::unique_ptr<Node<Type>> differentiate(const std::string& variable) override;
-
-        std::unique_ptr<Node<Type>> simplify() override;
+        std::unique_ptr<Node<Type>> rewrite();
 
         std::unique_ptr<Node<Type>> left;
         std::unique_ptr<Node<Type>> right;
@@ -42,105 +41,97 @@ namespace Math
 {
     template<typename Type>
     Subtraction<Type>::Subtraction(const Subtraction& subtraction)
+        : Node<Type>(TypeNode::Subtraction)
     {
         this->left = subtraction.left->makeCopy();
         this->right = subtraction.right->makeCopy();
+        this->summarize();
     }
 
 
     template<typename Type>
     Subtraction<Type>::Subtraction(const std::unique_ptr<Node<Type>>& left, const std::unique_ptr<Node<Type>>& right)
+        : Node<Type>(TypeNode::Subtraction)
     {
         this->left = left->makeCopy();
         this->right = right->makeCopy();
+        this->summarize();
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Subtraction<Type>::makeCopy()
+    Subtraction<Type>::Subtraction(std::unique_ptr<Node<Type>>&& left, std::unique_ptr<Node<Type>>&& right)
+        : Node<Type>(TypeNode::Subtraction)
     {
-        return std::make_unique<Subtraction>(this->left, this->right);
+        this->left = std::move(left);
+        this->right = std::move(right);
+        this->summarize();
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Subtraction<Type>::substitute(const std::string& variable, const std::unique_ptr<Node<Type>>& expression)
+    Subtraction<Type>::~Subtraction()
     {
-        return std::make_unique<Subtraction>(this->left->substitute(variable, expression), this->right->substitute(variable, expression));
+        this->release();
     }
 
 
     template<typename Type>
-    Type Subtraction<Type>::calculate(const std::vector<std::string>& variable, const std::vector<Type>& value)
+    std::unique_ptr<Node<Type>> Subtraction<Type>::make(std::unique_ptr<Node<Type>>* operands) const
     {
-        return this->left->calculate(variable, value) - this->right->calculate(variable, value);
+        return std::make_unique<Subtraction>(std::move(operands[0]), std::move(operands[1]));
     }
 
 
     template<typename Type>
-    Priority Subtraction<Type>::getPriority()
+    Type Subtraction<Type>::evaluate(const Type* operands, const std::vector<std::string>& variable, const std::vector<Type>& value) const
     {
-        return Priority::Subtraction;
+        return operands[0] - operands[1];
     }
 
 
     template<typename Type>
-    TypeNode Subtraction<Type>::getType()
+    Priority Subtraction<Type>::getPriority() const
     {
-        return TypeNode::Subtraction;
-    }
-
-
-    template<typename Type>
-    bool Subtraction<Type>::equal(std::unique_ptr<Node<Type>>& ptr)
-    {
-        if(this->getType() == ptr->getType())
-        {
-            auto* subtraction = dynamic_cast<Subtraction*>(ptr.get());
-            return this->left->equal(subtraction->left) && this->right->equal(subtraction->right);
-        }
-        return false;
+        return Priority::Subtraction;
     }
 
 
     template<typename Type>
-    std::string Subtraction<Type>::toString()
+    std::string Subtraction<Type>::format(std::string* operands) const
     {
-        std::string left = this->left->toString();
-        std::string right = this->right->toString();
+        std::string left = std::move(operands[0]);
+        std::string right = std::move(operands[1]);
         if(right.front() == '-' || this->right->getPriority() <= this->getPriority())
         {
             right = "(" + right + ")";
         }
-        return left + " - " + right;
+        return std::move(left) + " - " + right;
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type> > Subtraction<Type>::differentiate(const std::string &variable)
+    std::unique_ptr<Node<Type>> Subtraction<Type>::derive(const std::string& variable, std::unique_ptr<Node<Type>>* derivatives) const
     {
         return std::make_unique<Subtraction<Type>>(
-            this->left->differentiate(variable),
-            this->right->differentiate(variable)
+            std::move(derivatives[0]),
+            std::move(derivatives[1])
         );
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Subtraction<Type>::simplify()
+    std::unique_ptr<Node<Type>> Subtraction<Type>::rewrite()
     {
-        this->left = this->left->simplify();
-        this->right = this->right->simplify();
-
         // 0 - x = -x
-        if(this->left->toString() == "0" || this->left->toString() == "-0")
+        if(this->left->printsAs("0") || this->left->printsAs("-0"))
         {
             return std::make_unique<Minus<Type>>(this->right);
         }
         // x - 0 = x
-        if(this->right->toString() == "0" || this->right->toString() == "-0")
+        if(this->right->printsAs("0") || this->right->printsAs("-0"))
         {
-            return this->left->makeCopy();
+            return std::move(this->left);
         }
         // a - b = a - b
         if(this->left->getType() == TypeNode::Number && this->right->getType() == TypeNode::Number)
@@ -156,7 +147,7 @@ namespace Math
         // -x - y = -(x + y)
         if(this->left->getType() == TypeNode::Minus)
         {
-            auto* left = dynamic_cast<Minus<Type>*>(this->left.get());
+            auto* left = nodeCast<Minus<Type>>(this->left.get());
             return std::make_unique<Minus<Type>>(
                 std::make_unique<Addition<Type>>(
                     left->argument,
@@ -167,7 +158,7 @@ namespace Math
         // x - (-y) = x + y
         if(this->right->getType() == TypeNode::Minus)
         {
-            auto* right = dynamic_cast<Minus<Type>*>(this->right.get());
+            auto* right = nodeCast<Minus<Type>>(this->right.get());
             return std::make_unique<Addition<Type>>(
                 this->left,
                 right->argument
@@ -178,7 +169,7 @@ namespace Math
         {
             if(this->left->getType() == TypeNode::Addition)
             {
-                auto* left = dynamic_cast<Addition<Type>*>(this->left.get());
+                auto* left = nodeCast<Addition<Type>>(this->left.get());
                 // (x + a) - b = (a - b) + x
                 if(left->right->getType() == TypeNode::Number)
                 {
@@ -204,7 +195,7 @@ namespace Math
             }
             if(this->left->getType() == TypeNode::Subtraction)
             {
-                auto* left = dynamic_cast<Subtraction*>(this->left.get());
+                auto* left = nodeCast<Subtraction>(this->left.get());
                 // (x - a) - b = x - (a + b)
                 if(left->right->getType() == TypeNode::Number)
                 {
@@ -234,7 +225,7 @@ namespace Math
         {
             if(this->right->getType() == TypeNode::Addition)
             {
-                auto* right = dynamic_cast<Addition<Type>*>(this->right.get());
+                auto* right = nodeCast<Addition<Type>>(this->right.get());
                 // a - (x + b) = (a - b) - x
                 if(right->right->getType() == TypeNode::Number)
                 {
@@ -260,7 +251,7 @@ namespace Math
             }
             if(this->right->getType() == TypeNode::Subtraction)
             {
-                auto* right = dynamic_cast<Subtraction*>(this->right.get());
+                auto* right = nodeCast<Subtraction>(this->right.get());
                 // a - (x - b) = (a + b) - x
                 if(right->right->getType() == TypeNode::Number)
                 {
@@ -289,8 +280,8 @@ namespace Math
         if(this->left->getType() == TypeNode::Multiplication
            && this->right->getType() == TypeNode::Multiplication)
         {
-            auto* left = dynamic_cast<Multiplication<Type>*>(this->left.get());
-            auto* right = dynamic_cast<Multiplication<Type>*>(this->right.get());
+            auto* left = nodeCast<Multiplication<Type>>(this->left.get());
+            auto* right = nodeCast<Multiplication<Type>>(this->right.get());
             // x * a - x * b = (a - b) * x
             if(left->left->equal(right->left))
             {
@@ -339,7 +330,7 @@ namespace Math
 
         if(this->left->getType() == TypeNode::Multiplication)
         {
-            auto* left = dynamic_cast<Multiplication<Type>*>(this->left.get());
+            auto* left = nodeCast<Multiplication<Type>>(this->left.get());
             // a * x - x = (a - 1) * x
             if(this->right->equal(left->right))
             {
@@ -366,7 +357,7 @@ namespace Math
 
         if(this->right->getType() == TypeNode::Multiplication)
         {
-            auto* right = dynamic_cast<Multiplication<Type>*>(this->right.get());
+            auto* right = nodeCast<Multiplication<Type>>(this->right.get());
             // x - a * x = (1 - a) * x
             if(this->left->equal(right->right))
             {
@@ -394,8 +385,8 @@ namespace Math
         if(this->left->getType() == TypeNode::Division
            && this->right->getType() == TypeNode::Division)
         {
-            auto* left = dynamic_cast<Division<Type>*>(this->left.get());
-            auto* right = dynamic_cast<Division<Type>*>(this->right.get());
+            auto* left = nodeCast<Division<Type>>(this->left.get());
+            auto* right = nodeCast<Division<Type>>(this->right.get());
             // a / x - b / x = (a - b) / x
             if(left->right->equal(right->right))
             {
@@ -409,7 +400,7 @@ namespace Math
             }
         }
 
-        return std::make_unique<Subtraction>(this->left, this->right);
+        return std::make_unique<Subtraction>(std::move(this->left), std::move(this->right));
     }
 } // Math
 
@@ -13,28 +13,25 @@ namespace Math
     class Variable final : public Node<Type>
     {
     public:
+        static constexpr TypeNode kind = TypeNode::Variable;
+
         Variable(const Variable& variable);
         explicit Variable(const std::string& name);
 
-        std::unique_ptr<Node<Type>> makeCopy() override;
-
-        Priority getPriority() override;
-
-        TypeNode getType() override;
-
-        bool equal(std::unique_ptr<Node<Type>>& ptr) override;
+        Priority getPriority() const;
 
-        std::string toString() override;
+        std::unique_ptr<Node<Type>> make(std::unique_ptr<Node<Type>>* operands) const;
 
-        std::unique_ptr<Node<Type>> substitute(const std::string& variable, const std::unique_ptr<Node<Type>>& expression) override;
+        std::string format(std::string* operands) const;
 
-        Type calculate(const std::vector<std::string>& variable, const std::vector<Type>& value) override;
+        Type evaluate(const Type* operands, const std::vector<std::string>& variable, const std::vector<Type>& value) const;
 
-        std::unique_ptr<Node<Type>> differentiate(const std::string& variable) override;
+        std::unique_ptr<Node<Type>> derive(const std::string& variable, std::unique_ptr<Node<Type>>* derivatives) const;
 
-        std::unique_ptr<Node<Type>> simplify() override;
+        std::unique_ptr<Node<Type>> rewrite();
 
         std::string name;
+        std::size_t id;
     };
 } // Math
 
@@ -43,14 +40,17 @@ namespace Math
 {
     template<typename Type>
     Variable<Type>::Variable(const Variable &variable)
+        : Node<Type>(TypeNode::Variable)
     {
         this->name = variable.name;
+        this->id = variable.id;
+        this->summarize();
     }
 
 
     template<typename Type>
     Variable<Type>::Variable(const std::string& name)
-        : name(name)
+        : Node<Type>(TypeNode::Variable), name(name)
     {
         if(name.empty())
         {
@@ -67,29 +67,20 @@ namespace Math
                 throw std::invalid_argument("The variable can only consist of letters and digits");
             }
         }
+        this->id = internVariable(name);
+        this->summarize();
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Variable<Type>::makeCopy()
+    std::unique_ptr<Node<Type>> Variable<Type>::make(std::unique_ptr<Node<Type>>* operands) const
     {
-        return std::make_unique<Variable>(this->name);
-    }
-
-
-    template<typename Type>
-    std::unique_ptr<Node<Type>> Variable<Type>::substitute(const std::string &variable, const std::unique_ptr<Node<Type>>& expression)
-    {
-        if(this->name == variable)
-        {
-            return expression->makeCopy();
-        }
-        return this->makeCopy();
+        return std::make_unique<Variable>(*this);
     }
 
 
     template<typename Type>
-    Type Variable<Type>::calculate(const std::vector<std::string>& variable, const std::vector<Type>& value)
+    Type Variable<Type>::evaluate(const Type* operands, const std::vector<std::string>& variable, const std::vector<Type>& value) const
     {
         auto iter = std::find(variable.begin(), variable.end(), this->name);
         if(iter == variable.end())
@@ -102,40 +93,21 @@ namespace Math
 
 
     template<typename Type>
-    Priority Variable<Type>::getPriority()
+    Priority Variable<Type>::getPriority() const
     {
         return Priority::Variable;
     }
 
 
     template<typename Type>
-    TypeNode Variable<Type>::getType()
-    {
-        return TypeNode::Variable;
-    }
-
-
-    template<typename Type>
-    bool Variable<Type>::equal(std::unique_ptr<Node<Type>>& ptr)
-    {
-        if(this->getType() == ptr->getType())
-        {
-            auto* variable = dynamic_cast<Variable*>(ptr.get());
-            return this->name == variable->name;
-        }
-        return false;
-    }
-
-
-    template<typename Type>
-    std::string Variable<Type>::toString()
+    std::string Variable<Type>::format(std::string* operands) const
     {
         return this->name;
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type> > Variable<Type>::differentiate(const std::string &variable)
+    std::unique_ptr<Node<Type>> Variable<Type>::derive(const std::string& variable, std::unique_ptr<Node<Type>>* derivatives) const
     {
         if(this->name == variable)
         {
@@ -146,7 +118,7 @@ namespace Math
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Variable<Type>::simplify()
+    std::unique_ptr<Node<Type>> Variable<Type>::rewrite()
     {
         return std::make_unique<Variable>(*this);
     }
@@ -4,6 +4,8 @@
 
 #include <complex>
 #include <memory>
+#include <optional>
+#include <vector>
 
 #include "Lexer.hpp"
 #include "Nodes/Node.hpp"
@@ -33,14 +35,28 @@ namespace Math
         std::pair<std::string, std::unique_ptr<Node<Type>>> parseAssignment();
 
     private:
+        // An open group and the operands waiting for the rest of its sum.
+        // The nesting lives in a vector of frames, so depth is limited by memory only.
+        struct Frame
+        {
+            std::optional<TypeNode> function;
+            bool negate = false;
+            TokenType sumOperator = TokenType::PLUS;
+            std::unique_ptr<Node<Type>> sum;
+            TokenType productOperator = TokenType::STAR;
+            std::unique_ptr<Node<Type>> product;
+            std::vector<std::unique_ptr<Node<Type>>> bases;
+        };
+
+        // sum     := ["-"] product {("+" | "-") product}
+        // product := power {("*" | "/") power | power}
+        // power   := primary ["^" power]
+        // primary := NUMBER | SYMBOL | FUNCTION group | group
+        // group   := "(" sum ")"
         std::unique_ptr<Node<Type>> expr();
-        std::unique_ptr<Node<Type>> sum();
-        std::unique_ptr<Node<Type>> unary();
-        std::unique_ptr<Node<Type>> mul();
-        std::unique_ptr<Node<Type>> pow();
-        std::unique_ptr<Node<Type>> primary();
-        std::unique_ptr<Node<Type>> funcCall();
-        std::unique_ptr<Node<Type>> group();
+
+        static std::unique_ptr<Node<Type>> binary(TokenType type, std::unique_ptr<Node<Type>>&& left, std::unique_ptr<Node<Type>>&& right);
+        static std::unique_ptr<Node<Type>> call(std::optional<TypeNode> function, std::unique_ptr<Node<Type>>&& argument);
     };
 } // Math
 
@@ -89,179 +105,158 @@ namespace Math
     template<typename Type>
     std::unique_ptr<Node<Type>> Parser<Type>::expr()
     {
-        return this->sum();
-    }
-
-
-    template<typename Type>
-    std::unique_ptr<Node<Type>> Parser<Type>::sum()
-    {
-        auto left {this->unary()};
-        auto token {this->getNextToken()};
-
-        while(token.type == TokenType::PLUS || token.type == TokenType::MINUS)
-        {
-            if(token.type == TokenType::PLUS)
-            {
-                left = std::make_unique<Addition<Type>>(left, this->mul());
-            }
-            else
-            {
-                left = std::make_unique<Subtraction<Type>>(left, this->mul());
-            }
-            token = this->getNextToken();
-        }
-        this->pushBack(token);
-
-        return left;
-    }
-
-
-    template<typename Type>
-    std::unique_ptr<Node<Type>> Parser<Type>::unary()
-    {
-        auto token {this->getNextToken()};
-
-        if(token.type == TokenType::MINUS)
-        {
-            return std::make_unique<Minus<Type>>(mul());
-        }
-        this->pushBack(token);
-
-        return mul();
-    }
-
-
-    template<typename Type>
-    std::unique_ptr<Node<Type>> Parser<Type>::mul()
-    {
-        auto left {this->pow()};
-
+        std::vector<Frame> frames(1);
         while(true)
         {
+            // Operand: opens a group or reads a primary
             auto token {this->getNextToken()};
+            Frame& open = frames.back();
+            if(token.type == TokenType::MINUS && !open.negate && !open.sum && !open.product && open.bases.empty())
+            {
+                open.negate = true;
+                token = this->getNextToken();
+            }
 
-            if(token.type == TokenType::STAR)
+            std::unique_ptr<Node<Type>> operand;
+            if(token.type == TokenType::LPAR)
             {
-                left = std::make_unique<Multiplication<Type>>(left, this->pow());
+                frames.emplace_back();
+                continue;
             }
-            else if(token.type == TokenType::SLASH)
+            if(token.type == TokenType::NUMBER)
             {
-                left = std::make_unique<Division<Type>>(left, this->pow());
+                operand = std::make_unique<Number<Type>>(getNumber<Type>(std::stod(token.str)));
             }
-            else if(token.type == TokenType::SYMBOL || token.type == TokenType::LPAR)
+            else if(token.type == TokenType::SYMBOL)
             {
-                this->pushBack(token);
-                left = std::make_unique<Multiplication<Type>>(left, this->pow());
+                const std::optional<TypeNode> function = token.str == "sin" ? TypeNode::Sin
+                    : token.str == "cos" ? TypeNode::Cos
+                    : token.str == "exp" ? TypeNode::Exp
+                    : token.str == "ln" ? std::optional<TypeNode>(TypeNode::Ln)
+                    : std::nullopt;
+                if(function)
+                {
+                    if(this->getNextToken().type != TokenType::LPAR)
+                    {
+                        throw std::invalid_argument("Can not parse group expression");
+                    }
+                    frames.emplace_back().function = function;
+                    continue;
+                }
+                if(token.str == "i" && (std::is_same_v<Type, std::complex<float>> ||
+                                        std::is_same_v<Type, std::complex<double>> ||
+                                        std::is_same_v<Type, std::complex<long double>>))
+                {
+                    operand = std::make_unique<Number<Type>>(getNumber<Type>(0.0, 1.0));
+                }
+                else
+                {
+                    operand = std::make_unique<Variable<Type>>(token.str);
+                }
             }
             else
             {
-                this->pushBack(token);
-                break;
+                throw std::invalid_argument("Can not parse primary expression");
             }
-        }
-
-        return left;
-    }
 
-
-    template<typename Type>
-    std::unique_ptr<Node<Type>> Parser<Type>::pow()
-    {
-        auto left {this->primary()};
-        auto token {this->getNextToken()};
-
-        if(token.type == TokenType::POW)
-        {
-            return std::make_unique<Power<Type>>(left, this->pow());
-        }
-        this->pushBack(token);
-
-        return left;
-    }
-
-
-    template<typename Type>
-    std::unique_ptr<Node<Type>> Parser<Type>::primary()
-    {
-        auto token {this->getNextToken()};
-
-        if(token.type == TokenType::LPAR)
-        {
-            this->pushBack(token);
-            return this->group();
-        }
-
-        if(token.type == TokenType::NUMBER)
-        {
-            return std::make_unique<Number<Type>>(getNumber<Type>(std::stod(token.str)));
-        }
-
-        if(token.type == TokenType::SYMBOL)
-        {
-            if(token.str == "sin" || token.str == "cos" || token.str == "exp" || token.str == "ln")
+            // Operator: folds the operand into the innermost frame, closing groups on the way
+            while(true)
             {
-                this->pushBack(token);
-                return this->funcCall();
+                Frame& frame = frames.back();
+                token = this->getNextToken();
+                if(token.type == TokenType::POW)
+                {
+                    frame.bases.push_back(std::move(operand));
+                    break;
+                }
+
+                // x^y^z = x^(y^z)
+                while(!frame.bases.empty())
+                {
+                    operand = std::make_unique<Power<Type>>(std::move(frame.bases.back()), std::move(operand));
+                    frame.bases.pop_back();
+                }
+                frame.product = frame.product
+                    ? binary(frame.productOperator, std::move(frame.product), std::move(operand))
+                    : std::move(operand);
+                if(token.type == TokenType::STAR || token.type == TokenType::SLASH)
+                {
+                    frame.productOperator = token.type;
+                    break;
+                }
+                // 2x, x(y + 1)
+                if(token.type == TokenType::SYMBOL || token.type == TokenType::LPAR)
+                {
+                    this->pushBack(token);
+                    frame.productOperator = TokenType::STAR;
+                    break;
+                }
+
+                if(frame.negate)
+                {
+                    frame.product = std::make_unique<Minus<Type>>(std::move(frame.product));
+                    frame.negate = false;
+                }
+                frame.sum = frame.sum
+                    ? binary(frame.sumOperator, std::move(frame.sum), std::move(frame.product))
+                    : std::move(frame.product);
+                if(token.type == TokenType::PLUS || token.type == TokenType::MINUS)
+                {
+                    frame.sumOperator = token.type;
+                    break;
+                }
+
+                if(frames.size() == 1)
+                {
+                    this->pushBack(token);
+                    return std::move(frame.sum);
+                }
+                if(token.type != TokenType::RPAR)
+                {
+                    throw std::invalid_argument("Can not parse group expression");
+                }
+                operand = call(frame.function, std::move(frame.sum));
+                frames.pop_back();
             }
-            if(token.str == "i" && (std::is_same_v<Type, std::complex<float>> ||
-                                    std::is_same_v<Type, std::complex<double>> ||
-                                    std::is_same_v<Type, std::complex<long double>>))
-            {
-                return std::make_unique<Number<Type>>(getNumber<Type>(0.0, 1.0));
-            }
-            return std::make_unique<Variable<Type>>(token.str);
         }
-
-        throw std::invalid_argument("Can not parse primary expression");
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Parser<Type>::funcCall()
+    std::unique_ptr<Node<Type>> Parser<Type>::binary(TokenType type, std::unique_ptr<Node<Type>>&& left, std::unique_ptr<Node<Type>>&& right)
     {
-        auto name {this->getNextToken()};
-
-        if(name.type == TokenType::SYMBOL)
+        switch(type)
         {
-            if(name.str == "sin")
-            {
-                return std::make_unique<Sin<Type>>(this->group());
-            }
-            if(name.str == "cos")
-            {
-                return std::make_unique<Cos<Type>>(this->group());
-            }
-            if(name.str == "exp")
-            {
-                return std::make_unique<Exp<Type>>(this->group());
-            }
-            if(name.str == "ln")
-            {
-                return std::make_unique<Ln<Type>>(this->group());
-            }
+            case TokenType::PLUS:
+                return std::make_unique<Addition<Type>>(std::move(left), std::move(right));
+            case TokenType::MINUS:
+                return std::make_unique<Subtraction<Type>>(std::move(left), std::move(right));
+            case TokenType::STAR:
+                return std::make_unique<Multiplication<Type>>(std::move(left), std::move(right));
+            default:
+                return std::make_unique<Division<Type>>(std::move(left), std::move(right));
         }
-
-        throw std::invalid_argument("Can not parse function call");
     }
 
 
     template<typename Type>
-    std::unique_ptr<Node<Type>> Parser<Type>::group()
+    std::unique_ptr<Node<Type>> Parser<Type>::call(std::optional<TypeNode> function, std::unique_ptr<Node<Type>>&& argument)
     {
-        if(this->getNextToken().type != TokenType::LPAR)
+        if(!function)
         {
-            throw std::invalid_argument("Can not parse group expression");
+            return std::move(argument);
         }
-
-        auto result {this->expr()};
-
-        if(this->getNextToken().type != TokenType::RPAR)
+        switch(*function)
         {
-            throw std::invalid_argument("Can not parse group expression");
+            case TypeNode::Sin:
+                return std::make_unique<Sin<Type>>(std::move(argument));
+            case TypeNode::Cos:
+                return std::make_unique<Cos<Type>>(std::move(argument));
+            case TypeNode::Exp:
+                return std::make_unique<Exp<Type>>(std::move(argument));
+            default:
+                return std::make_unique<Ln<Type>>(std::move(argument));
         }
-
-        return result;
     }
 } // Math
 
@@ -0,0 +1,313 @@
+#ifndef SIMPLIFY_CACHE_HPP
+#define SIMPLIFY_CACHE_HPP
+
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Nodes/Node.hpp"
+#include "Nodes/Number.hpp"
+#include "Nodes/Variable.hpp"
+
+
+namespace Math
+{
+    // Simplified subtrees by the structural hash of their input. The entries are spread
+    // over shards by hash, a lookup takes only the shared lock of one shard, so readers
+    // never wait for each other. A subtree is stored when it misses for the second time,
+    // one seen once is only remembered by hash. When a shard holds more nodes than its part
+    // of the capacity, entries not used since the last sweep are evicted (clock algorithm).
+    template<typename Type>
+    class SimplifyCache
+    {
+    public:
+        struct Statistics
+        {
+            std::size_t hits;
+            std::size_t misses;
+            std::size_t insertions;
+            std::size_t evictions;
+            std::size_t entries;
+            std::size_t nodes;
+
+            [[nodiscard]] double hitRate() const;
+        };
+
+        // Capacity counts the nodes of the stored inputs and results. Only subtrees of
+        // minimumSize to maximumSize nodes are looked up and stored, smaller ones are cheaper
+        // to simplify again and larger ones would be copied at every level of a long chain.
+        explicit SimplifyCache(std::size_t capacity = 1 << 20, std::size_t shards = 16,
+            std::size_t minimumSize = 16, std::size_t maximumSize = 256);
+
+        // The cache of Expression::simplify, disabled until enable is called
+        static SimplifyCache& global();
+
+        void enable();
+        void disable();
+        [[nodiscard]] bool isEnabled() const;
+
+        void setCapacity(std::size_t capacity);
+        void clear();
+
+        [[nodiscard]] Statistics getStatistics() const;
+
+        [[nodiscard]] bool accepts(std::size_t size) const;
+
+        // A copy of the simplified tree, or nullptr
+        std::unique_ptr<Node<Type>> find(const Node<Type>& node);
+        void insert(const Node<Type>& node, const Node<Type>& simplified);
+
+    private:
+        struct Entry
+        {
+            std::unique_ptr<Node<Type>> input;
+            std::unique_ptr<Node<Type>> result;
+            std::size_t nodes;
+            std::atomic<bool> referenced;
+        };
+
+        struct Shard
+        {
+            mutable std::shared_mutex mutex;
+            std::unordered_multimap<std::uint64_t, Entry*> index;
+            std::vector<std::pair<std::uint64_t, std::unique_ptr<Entry>>> clock;
+            std::unordered_set<std::uint64_t> seen;
+            std::size_t hand = 0;
+            std::size_t nodes = 0;
+        };
+
+        Shard& getShard(std::uint64_t hash);
+
+        // Requires the unique lock of the shard
+        void evict(Shard& shard, std::size_t limit);
+
+        std::vector<Shard> shards;
+        std::atomic<std::size_t> capacity;
+        const std::size_t minimumSize;
+        const std::size_t maximumSize;
+        std::atomic<bool> enabled = false;
+
+        std::atomic<std::size_t> hits = 0;
+        std::atomic<std::size_t> misses = 0;
+        std::atomic<std::size_t> insertions = 0;
+        std::atomic<std::size_t> evictions = 0;
+    };
+} // Math
+
+
+
+// Implementation
+namespace Math
+{
+    template<typename Type>
+    double SimplifyCache<Type>::Statistics::hitRate() const
+    {
+        const std::size_t lookups = this->hits + this->misses;
+        return lookups == 0 ? 0.0 : static_cast<double>(this->hits) / static_cast<double>(lookups);
+    }
+
+
+    template<typename Type>
+    SimplifyCache<Type>::SimplifyCache(std::size_t capacity, std::size_t shards, std::size_t minimumSize, std::size_t maximumSize)
+        : shards(std::max<std::size_t>(shards, 1)), capacity(capacity), minimumSize(minimumSize), maximumSize(maximumSize)
+    {
+    }
+
+
+    template<typename Type>
+    SimplifyCache<Type>& SimplifyCache<Type>::global()
+    {
+        static SimplifyCache cache;
+        return cache;
+    }
+
+
+    template<typename Type>
+    void SimplifyCache<Type>::enable()
+    {
+        this->enabled = true;
+    }
+
+
+    template<typename Type>
+    void SimplifyCache<Type>::disable()
+    {
+        this->enabled = false;
+    }
+
+
+    template<typename Type>
+    bool SimplifyCache<Type>::isEnabled() const
+    {
+        return this->enabled;
+    }
+
+
+    template<typename Type>
+    void SimplifyCache<Type>::setCapacity(std::size_t capacity)
+    {
+        this->capacity = capacity;
+        for(Shard& shard : this->shards)
+        {
+            std::unique_lock lock(shard.mutex);
+            this->evict(shard, capacity / this->shards.size());
+        }
+    }
+
+
+    template<typename Type>
+    void SimplifyCache<Type>::clear()
+    {
+        for(Shard& shard : this->shards)
+        {
+            std::unique_lock lock(shard.mutex);
+            shard.index.clear();
+            shard.clock.clear();
+            shard.seen.clear();
+            shard.hand = 0;
+            shard.nodes = 0;
+        }
+        this->hits = 0;
+        this->misses = 0;
+        this->insertions = 0;
+        this->evictions = 0;
+    }
+
+
+    template<typename Type>
+    typename SimplifyCache<Type>::Statistics SimplifyCache<Type>::getStatistics() const
+    {
+        Statistics statistics {this->hits, this->misses, this->insertions, this->evictions, 0, 0};
+        for(const Shard& shard : this->shards)
+        {
+            std::shared_lock lock(shard.mutex);
+            statistics.entries += shard.clock.size();
+            statistics.nodes += shard.nodes;
+        }
+        return statistics;
+    }
+
+
+    template<typename Type>
+    bool SimplifyCache<Type>::accepts(std::size_t size) const
+    {
+        return size >= this->minimumSize && size <= this->maximumSize;
+    }
+
+
+    template<typename Type>
+    std::unique_ptr<Node<Type>> SimplifyCache<Type>::find(const Node<Type>& node)
+    {
+        Shard& shard = this->getShard(node.getHash());
+        {
+            std::shared_lock lock(shard.mutex);
+            auto [begin, end] = shard.index.equal_range(node.getHash());
+            for(auto iter = begin; iter != end; ++iter)
+            {
+                Entry& entry = *iter->second;
+                if(entry.input->equal(node))
+                {
+                    entry.referenced.store(true, std::memory_order_relaxed);
+                    this->hits.fetch_add(1, std::memory_order_relaxed);
+                    return entry.result->makeCopy();
+                }
+            }
+        }
+        this->misses.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+
+    template<typename Type>
+    void SimplifyCache<Type>::insert(const Node<Type>& node, const Node<Type>& simplified)
+    {
+        const std::uint64_t hash = node.getHash();
+        const std::size_t limit = this->capacity / this->shards.size();
+        const std::size_t nodes = node.getSize() + simplified.getSize();
+        if(nodes > limit)
+        {
+            return;
+        }
+
+        // Most subtrees are never seen again, the first miss copies nothing
+        Shard& shard = this->getShard(hash);
+        {
+            std::unique_lock lock(shard.mutex);
+            if(shard.seen.size() >= limit)
+            {
+                shard.seen.clear();
+            }
+            if(shard.seen.insert(hash).second)
+            {
+                return;
+            }
+        }
+
+        auto entry = std::make_unique<Entry>();
+        entry->nodes = nodes;
+        entry->input = node.makeCopy();
+        entry->result = simplified.makeCopy();
+        entry->referenced = false;
+
+        std::unique_lock lock(shard.mutex);
+        shard.seen.erase(hash);
+        auto [begin, end] = shard.index.equal_range(hash);
+        for(auto iter = begin; iter != end; ++iter)
+        {
+            // Another thread simplified the same subtree meanwhile
+            if(iter->second->input->equal(node))
+            {
+                return;
+            }
+        }
+
+        this->evict(shard, limit - entry->nodes);
+        shard.nodes += entry->nodes;
+        shard.index.emplace(hash, entry.get());
+        shard.clock.emplace_back(hash, std::move(entry));
+        this->insertions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+
+    template<typename Type>
+    typename SimplifyCache<Type>::Shard& SimplifyCache<Type>::getShard(std::uint64_t hash)
+    {
+        return this->shards[(hash >> 32) % this->shards.size()];
+    }
+
+
+    template<typename Type>
+    void SimplifyCache<Type>::evict(Shard& shard, std::size_t limit)
+    {
+        while(shard.nodes > limit && !shard.clock.empty())
+        {
+            if(shard.hand >= shard.clock.size())
+            {
+                shard.hand = 0;
+            }
+            auto& [hash, entry] = shard.clock[shard.hand];
+            if(entry->referenced.exchange(false, std::memory_order_relaxed))
+            {
+                shard.hand++;
+                continue;
+            }
+
+            auto [begin, end] = shard.index.equal_range(hash);
+            shard.index.erase(std::find_if(begin, end, [&entry](const auto& item) { return item.second == entry.get(); }));
+            shard.nodes -= entry->nodes;
+            std::swap(shard.clock[shard.hand], shard.clock.back());
+            shard.clock.pop_back();
+            this->evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+} // Math
+
+
+#endif // SIMPLIFY_CACHE_HPP
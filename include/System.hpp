@@ -0,0 +1,429 @@
+#ifndef SYSTEM_HPP
+#define SYSTEM_HPP
+
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Dag.hpp"
+#include "Dual.hpp"
+#include "Evaluator.hpp"
+#include "Expression.hpp"
+
+
+namespace Math
+{
+    // Coordinate format, entries sorted by row and then by column
+    template<typename Type>
+    struct SparseMatrix
+    {
+        std::size_t rows = 0;
+        std::size_t columns = 0;
+        std::vector<std::size_t> row;
+        std::vector<std::size_t> column;
+        std::vector<Type> value;
+    };
+
+
+    // A vector of expressions f_0..f_(m-1) in the variables x_0..x_(n-1).
+    // The sparsity of the Jacobian and of the Hessian is read from the
+    // dependencies of the compiled program. Structurally orthogonal columns
+    // (or rows) are colored alike and computed together, so a Jacobian costs
+    // one sweep per color instead of one sweep per variable.
+    template<typename Type>
+    class System
+    {
+    public:
+        enum class Mode
+        {
+            Forward,
+            Reverse
+        };
+
+        System(const std::vector<Expression<Type>>& expressions, const std::vector<std::string>& variables);
+
+        [[nodiscard]] std::size_t rows() const;
+        [[nodiscard]] std::size_t columns() const;
+        [[nodiscard]] const std::vector<std::string>& getVariables() const;
+
+        // Number of sweeps a Jacobian takes in the given mode
+        [[nodiscard]] std::size_t getColors(Mode mode) const;
+        // Number of sweeps a Hessian takes
+        [[nodiscard]] std::size_t getHessianColors() const;
+
+        std::vector<Type> calculate(const std::vector<Type>& value) const;
+
+        SparseMatrix<Type> jacobian(const std::vector<Type>& value, Mode mode = Mode::Forward) const;
+
+        // Lower triangle of the Hessian of sum weight_i * f_i, by forward over reverse mode
+        SparseMatrix<Type> hessian(const std::vector<Type>& value, const std::vector<Type>& weight) const;
+
+    private:
+        // Greedy coloring of count items, the items of every group must get distinct colors
+        static std::vector<std::size_t> color(const std::vector<std::vector<std::size_t>>& groups, std::size_t count);
+
+        std::vector<Type> getSlots(const std::vector<Type>& value) const;
+
+        Evaluator<Type> evaluator;
+        std::vector<std::string> variables;
+        std::vector<std::size_t> slots;
+
+        SparseMatrix<Type> jacobianPattern;
+        std::vector<std::size_t> columnColors;
+        std::vector<std::size_t> rowColors;
+
+        SparseMatrix<Type> hessianPattern;
+        std::vector<std::size_t> hessianColors;
+    };
+} // Math
+
+
+
+// Implementation
+namespace Math
+{
+    template<typename Type>
+    System<Type>::System(const std::vector<Expression<Type>>& expressions, const std::vector<std::string>& variables)
+        : evaluator([&expressions]()
+        {
+            Dag<Type> dag;
+            std::vector<std::uint32_t> outputs;
+            for(const auto& expression : expressions)
+            {
+                outputs.push_back(dag.add(expression.root, true));
+            }
+            return Evaluator<Type>(dag, outputs);
+        }()), variables(variables)
+    {
+        const auto& program = this->evaluator.getProgram();
+        const auto& outputs = this->evaluator.getOutputs();
+
+        std::unordered_map<std::string, std::size_t> columnOf;
+        for(std::size_t j = 0; j < variables.size(); j++)
+        {
+            columnOf.emplace(variables[j], j);
+        }
+        for(const std::string& name : this->evaluator.getVariables())
+        {
+            auto iter = columnOf.find(name);
+            if(iter == columnOf.end())
+            {
+                throw std::invalid_argument("The variable \"" + name + "\" has no value");
+            }
+            this->slots.push_back(iter->second);
+        }
+
+        // Sorted columns every register depends on, and the columns coupled to every column
+        // by a nonlinear instruction. Both are sparse, a register depends on few variables.
+        std::vector<std::vector<std::size_t>> dependencies(program.size());
+        std::vector<std::vector<std::size_t>> coupled(variables.size());
+        auto merge = [](const std::vector<std::size_t>& first, const std::vector<std::size_t>& second)
+        {
+            std::vector<std::size_t> result;
+            result.reserve(first.size() + second.size());
+            std::set_union(first.begin(), first.end(), second.begin(), second.end(), std::back_inserter(result));
+            return result;
+        };
+        auto couple = [&coupled](const std::vector<std::size_t>& first, const std::vector<std::size_t>& second)
+        {
+            for(const std::size_t i : first)
+            {
+                coupled[i].insert(coupled[i].end(), second.begin(), second.end());
+            }
+            for(const std::size_t i : second)
+            {
+                coupled[i].insert(coupled[i].end(), first.begin(), first.end());
+            }
+        };
+        for(std::size_t i = 0; i < program.size(); i++)
+        {
+            const auto& instruction = program[i];
+            switch(instruction.type)
+            {
+                case TypeNode::Number:
+                    break;
+                case TypeNode::Variable:
+                    dependencies[i] = {this->slots[instruction.left]};
+                    break;
+                case TypeNode::Minus:
+                    dependencies[i] = dependencies[instruction.left];
+                    break;
+                case TypeNode::Sin:
+                case TypeNode::Cos:
+                case TypeNode::Exp:
+                case TypeNode::Ln:
+                    dependencies[i] = dependencies[instruction.left];
+                    couple(dependencies[i], dependencies[i]);
+                    break;
+                default:
+                    dependencies[i] = merge(dependencies[instruction.left], dependencies[instruction.right]);
+                    if(instruction.type == TypeNode::Multiplication)
+                    {
+                        couple(dependencies[instruction.left], dependencies[instruction.right]);
+                    }
+                    else if(instruction.type == TypeNode::Division)
+                    {
+                        couple(dependencies[instruction.right], dependencies[i]);
+                    }
+                    else if(instruction.type == TypeNode::Power)
+                    {
+                        couple(dependencies[i], dependencies[i]);
+                    }
+            }
+        }
+        for(auto& columns : coupled)
+        {
+            std::sort(columns.begin(), columns.end());
+            columns.erase(std::unique(columns.begin(), columns.end()), columns.end());
+        }
+
+        std::vector<std::vector<std::size_t>> rowColumns(outputs.size());
+        std::vector<std::vector<std::size_t>> columnRows(variables.size());
+        this->jacobianPattern.rows = outputs.size();
+        this->jacobianPattern.columns = variables.size();
+        for(std::size_t i = 0; i < outputs.size(); i++)
+        {
+            rowColumns[i] = dependencies[outputs[i]];
+            for(const std::size_t j : rowColumns[i])
+            {
+                columnRows[j].push_back(i);
+                this->jacobianPattern.row.push_back(i);
+                this->jacobianPattern.column.push_back(j);
+            }
+        }
+        this->jacobianPattern.value.resize(this->jacobianPattern.row.size());
+        this->columnColors = color(rowColumns, variables.size());
+        this->rowColors = color(columnRows, outputs.size());
+
+        std::vector<std::vector<std::size_t>> hessianRows(variables.size());
+        this->hessianPattern.rows = variables.size();
+        this->hessianPattern.columns = variables.size();
+        for(std::size_t i = 0; i < variables.size(); i++)
+        {
+            hessianRows[i] = std::move(coupled[i]);
+            for(const std::size_t j : hessianRows[i])
+            {
+                if(j > i)
+                {
+                    break;
+                }
+                this->hessianPattern.row.push_back(i);
+                this->hessianPattern.column.push_back(j);
+            }
+        }
+        this->hessianPattern.value.resize(this->hessianPattern.row.size());
+        this->hessianColors = color(hessianRows, variables.size());
+    }
+
+
+    template<typename Type>
+    std::size_t System<Type>::rows() const
+    {
+        return this->jacobianPattern.rows;
+    }
+
+
+    template<typename Type>
+    std::size_t System<Type>::columns() const
+    {
+        return this->jacobianPattern.columns;
+    }
+
+
+    template<typename Type>
+    const std::vector<std::string>& System<Type>::getVariables() const
+    {
+        return this->variables;
+    }
+
+
+    template<typename Type>
+    std::size_t System<Type>::getColors(Mode mode) const
+    {
+        const auto& colors = mode == Mode::Forward ? this->columnColors : this->rowColors;
+        return colors.empty() ? 0 : *std::max_element(colors.begin(), colors.end()) + 1;
+    }
+
+
+    template<typename Type>
+    std::size_t System<Type>::getHessianColors() const
+    {
+        const auto& colors = this->hessianColors;
+        return colors.empty() ? 0 : *std::max_element(colors.begin(), colors.end()) + 1;
+    }
+
+
+    template<typename Type>
+    std::vector<Type> System<Type>::calculate(const std::vector<Type>& value) const
+    {
+        return this->evaluator.calculate(this->getSlots(value));
+    }
+
+
+    template<typename Type>
+    SparseMatrix<Type> System<Type>::jacobian(const std::vector<Type>& value, Mode mode) const
+    {
+        const auto& outputs = this->evaluator.getOutputs();
+        const std::vector<Type> slots = this->getSlots(value);
+        SparseMatrix<Type> jacobian = this->jacobianPattern;
+
+        std::vector<std::vector<std::size_t>> entries(this->getColors(mode));
+        for(std::size_t e = 0; e < jacobian.row.size(); e++)
+        {
+            entries[mode == Mode::Forward ? this->columnColors[jacobian.column[e]] : this->rowColors[jacobian.row[e]]].push_back(e);
+        }
+
+        std::vector<std::size_t> slotOf(this->variables.size());
+        for(std::size_t s = 0; s < this->slots.size(); s++)
+        {
+            slotOf[this->slots[s]] = s;
+        }
+
+        if(mode == Mode::Forward)
+        {
+            std::vector<Dual<Type>> seed(slots.size());
+            for(std::size_t c = 0; c < entries.size(); c++)
+            {
+                for(std::size_t s = 0; s < slots.size(); s++)
+                {
+                    seed[s] = Dual<Type>(slots[s], this->columnColors[this->slots[s]] == c ? getNumber<Type>(1.0) : Type{});
+                }
+                std::vector<Dual<Type>> tape = this->evaluator.forward(seed);
+                for(const std::size_t e : entries[c])
+                {
+                    jacobian.value[e] = tape[outputs[jacobian.row[e]]].derivative;
+                }
+            }
+            return jacobian;
+        }
+
+        std::vector<Type> tape = this->evaluator.forward(slots);
+        for(std::size_t c = 0; c < entries.size(); c++)
+        {
+            std::vector<Type> adjoint(tape.size());
+            for(std::size_t i = 0; i < outputs.size(); i++)
+            {
+                if(this->rowColors[i] == c)
+                {
+                    adjoint[outputs[i]] = getNumber<Type>(1.0);
+                }
+            }
+            std::vector<Type> gradient = this->evaluator.backward(tape, std::move(adjoint));
+            for(const std::size_t e : entries[c])
+            {
+                jacobian.value[e] = gradient[slotOf[jacobian.column[e]]];
+            }
+        }
+        return jacobian;
+    }
+
+
+    template<typename Type>
+    SparseMatrix<Type> System<Type>::hessian(const std::vector<Type>& value, const std::vector<Type>& weight) const
+    {
+        if(weight.size() != this->rows())
+        {
+            throw std::invalid_argument("The number of weights does not match the number of expressions");
+        }
+
+        const auto& outputs = this->evaluator.getOutputs();
+        const std::vector<Type> slots = this->getSlots(value);
+        SparseMatrix<Type> hessian = this->hessianPattern;
+
+        std::vector<std::vector<std::size_t>> entries(this->getHessianColors());
+        for(std::size_t e = 0; e < hessian.row.size(); e++)
+        {
+            entries[this->hessianColors[hessian.column[e]]].push_back(e);
+        }
+
+        std::vector<std::size_t> slotOf(this->variables.size());
+        for(std::size_t s = 0; s < this->slots.size(); s++)
+        {
+            slotOf[this->slots[s]] = s;
+        }
+
+        std::vector<Dual<Type>> seed(slots.size());
+        for(std::size_t c = 0; c < entries.size(); c++)
+        {
+            for(std::size_t s = 0; s < slots.size(); s++)
+            {
+                seed[s] = Dual<Type>(slots[s], this->hessianColors[this->slots[s]] == c ? getNumber<Type>(1.0) : Type{});
+            }
+            std::vector<Dual<Type>> tape = this->evaluator.forward(seed);
+            std::vector<Dual<Type>> adjoint(tape.size());
+            for(std::size_t i = 0; i < outputs.size(); i++)
+            {
+                adjoint[outputs[i]] += Dual<Type>(weight[i]);
+            }
+            std::vector<Dual<Type>> gradient = this->evaluator.backward(tape, std::move(adjoint));
+            for(const std::size_t e : entries[c])
+            {
+                hessian.value[e] = gradient[slotOf[hessian.row[e]]].derivative;
+            }
+        }
+        return hessian;
+    }
+
+
+    template<typename Type>
+    std::vector<std::size_t> System<Type>::color(const std::vector<std::vector<std::size_t>>& groups, std::size_t count)
+    {
+        std::vector<std::vector<std::size_t>> membership(count);
+        for(std::size_t g = 0; g < groups.size(); g++)
+        {
+            for(const std::size_t item : groups[g])
+            {
+                membership[item].push_back(g);
+            }
+        }
+
+        const std::size_t none = static_cast<std::size_t>(-1);
+        std::vector<std::size_t> colors(count, none);
+        std::vector<std::size_t> forbidden(count + 1, none);
+        for(std::size_t item = 0; item < count; item++)
+        {
+            for(const std::size_t g : membership[item])
+            {
+                for(const std::size_t other : groups[g])
+                {
+                    if(colors[other] != none)
+                    {
+                        forbidden[colors[other]] = item;
+                    }
+                }
+            }
+            std::size_t c = 0;
+            while(forbidden[c] == item)
+            {
+                c++;
+            }
+            colors[item] = c;
+        }
+        return colors;
+    }
+
+
+    template<typename Type>
+    std::vector<Type> System<Type>::getSlots(const std::vector<Type>& value) const
+    {
+        if(value.size() != this->variables.size())
+        {
+            throw std::invalid_argument("The number of values does not match the number of variables");
+        }
+        std::vector<Type> slots;
+        slots.reserve(this->slots.size());
+        for(const std::size_t column : this->slots)
+        {
+            slots.push_back(value[column]);
+        }
+        return slots;
+    }
+} // Math
+
+
+#endif // SYSTEM_HPP
@@ -0,0 +1,971 @@
+#ifndef TAPE_HPP
+#define TAPE_HPP
+
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Nodes/Node.hpp"
+#include "Nodes/Number.hpp"
+#include "Nodes/Variable.hpp"
+#include "Nodes/Minus.hpp"
+#include "Nodes/Addition.hpp"
+#include "Nodes/Subtraction.hpp"
+#include "Nodes/Sin.hpp"
+#include "Nodes/Cos.hpp"
+#include "Nodes/Exp.hpp"
+#include "Nodes/Ln.hpp"
+#include "Nodes/Multiplication.hpp"
+#include "Nodes/Division.hpp"
+#include "Nodes/Power.hpp"
+
+
+namespace Math
+{
+    // Expression stored as one contiguous array of records in post-order. The operands
+    // of a record always precede it and the last record is the root, so every operation
+    // is a single loop over the array without pointers, virtual calls or a stack.
+    // Unlike Dag nothing is merged, a tape made from a tree prints back to the same text.
+    template<typename Type>
+    class Tape
+    {
+    public:
+        // Number: left is an index into the constant pool
+        // Variable: left is the variable slot
+        // Unary nodes: left is the argument
+        struct Record
+        {
+            TypeNode type;
+            std::uint32_t left;
+            std::uint32_t right;
+        };
+
+        Tape() = default;
+        explicit Tape(const std::unique_ptr<Node<Type>>& node);
+
+        // Checks that the records are in post-order and every index is in range
+        Tape(std::vector<Record> records, std::vector<Type> constants, std::vector<std::string> variables);
+
+        // A record used by several others is expanded into copies
+        [[nodiscard]] std::unique_ptr<Node<Type>> toNode() const;
+
+        // Same tree as toNode()->simplify(), a record used several times is simplified once
+        [[nodiscard]] std::unique_ptr<Node<Type>> simplify() const;
+
+        [[nodiscard]] std::string toString() const;
+
+        Type calculate(const std::vector<std::string>& variable, const std::vector<Type>& value) const;
+
+        // The derivative reuses the records of the expression as operands, so the result
+        // may share records. Additions of zero and multiplications by one are not written.
+        [[nodiscard]] Tape differentiate(const std::string& variable) const;
+
+        // Compact binary form: a header with the counts, records of 9 bytes, the constants
+        // as raw bytes and the variable names. deserialize rejects malformed input.
+        [[nodiscard]] std::string serialize() const;
+        static Tape deserialize(const std::string& bytes);
+
+        [[nodiscard]] std::size_t size() const;
+
+        [[nodiscard]] const std::vector<Record>& getRecords() const;
+        [[nodiscard]] const std::vector<Type>& getConstants() const;
+
+        // Variable names by slot
+        [[nodiscard]] const std::vector<std::string>& getVariables() const;
+
+    private:
+        static std::size_t arity(TypeNode type);
+
+        std::uint32_t push(const Record& record);
+
+        std::uint32_t number(Type value);
+        std::uint32_t unary(TypeNode type, std::uint32_t argument);
+        std::uint32_t binary(TypeNode type, std::uint32_t left, std::uint32_t right);
+
+        bool isNumber(std::uint32_t index, double value) const;
+
+        // How many records use every record as an operand
+        std::vector<std::uint32_t> countUses() const;
+
+        // toNode, with the rules of simplify applied to every node once its operands are built
+        std::unique_ptr<Node<Type>> build(bool simplify) const;
+
+        // Drops the records, constants and variables the root does not use
+        void compact();
+
+        std::vector<Record> records;
+        std::vector<Type> constants;
+        std::vector<std::string> variables;
+    };
+} // Math
+
+
+
+// Implementation
+namespace Math
+{
+    template<typename Type>
+    Tape<Type>::Tape(const std::unique_ptr<Node<Type>>& node)
+    {
+        std::unordered_map<std::size_t, std::uint32_t> slots;
+        std::vector<std::pair<Node<Type>*, std::size_t>> stack {{node.get(), 0}};
+        std::vector<std::uint32_t> operands;
+        while(!stack.empty())
+        {
+            auto& [current, next] = stack.back();
+            if(next < current->countChildren())
+            {
+                Node<Type>* child = current->getChild(next++).get();
+                stack.emplace_back(child, 0);
+                continue;
+            }
+
+            const TypeNode type = current->getType();
+            Record record {type, 0, 0};
+            switch(arity(type))
+            {
+                case 0:
+                    if(type == TypeNode::Number)
+                    {
+                        record.left = static_cast<std::uint32_t>(this->constants.size());
+                        this->constants.push_back(static_cast<Number<Type>*>(current)->value);
+                    }
+                    else
+                    {
+                        auto* variable = static_cast<Variable<Type>*>(current);
+                        auto [iter, inserted] = slots.emplace(variable->id, static_cast<std::uint32_t>(this->variables.size()));
+                        if(inserted)
+                        {
+                            this->variables.push_back(variable->name);
+                        }
+                        record.left = iter->second;
+                    }
+                    break;
+                case 1:
+                    record.left = operands.back();
+                    operands.pop_back();
+                    break;
+                default:
+                    record.left = operands[operands.size() - 2];
+                    record.right = operands.back();
+                    operands.resize(operands.size() - 2);
+            }
+            operands.push_back(this->push(record));
+            stack.pop_back();
+        }
+    }
+
+
+    template<typename Type>
+    Tape<Type>::Tape(std::vector<Record> records, std::vector<Type> constants, std::vector<std::string> variables)
+        : records(std::move(records)), constants(std::move(constants)), variables(std::move(variables))
+    {
+        if(this->records.empty())
+        {
+            throw std::invalid_argument("Empty tape");
+        }
+        for(std::uint32_t i = 0; i < this->records.size(); i++)
+        {
+            // Operands must precede their user
+            const Record& record = this->records[i];
+            bool valid = true;
+            switch(arity(record.type))
+            {
+                case 0:
+                    valid = record.left < (record.type == TypeNode::Number ? this->constants.size() : this->variables.size());
+                    break;
+                case 1:
+                    valid = record.left < i;
+                    break;
+                default:
+                    valid = record.left < i && record.right < i;
+            }
+            if(!valid)
+            {
+                throw std::invalid_argument("Record operand out of range");
+            }
+        }
+        for(const std::string& variable : this->variables)
+        {
+            if(variable.empty())
+            {
+                throw std::invalid_argument("Empty variable name");
+            }
+        }
+    }
+
+
+    template<typename Type>
+    std::unique_ptr<Node<Type>> Tape<Type>::toNode() const
+    {
+        return this->build(false);
+    }
+
+
+    template<typename Type>
+    std::unique_ptr<Node<Type>> Tape<Type>::simplify() const
+    {
+        return this->build(true);
+    }
+
+
+    template<typename Type>
+    std::unique_ptr<Node<Type>> Tape<Type>::build(bool simplify) const
+    {
+        // The last use of a record takes its node, earlier uses copy it
+        std::vector<std::uint32_t> uses = this->countUses();
+        std::vector<std::unique_ptr<Node<Type>>> nodes(this->records.size());
+        auto take = [&](std::uint32_t index) {
+            return --uses[index] == 0 ? std::move(nodes[index]) : nodes[index]->makeCopy();
+        };
+
+        for(std::size_t i = 0; i < this->records.size(); i++)
+        {
+            const Record& record = this->records[i];
+            switch(record.type)
+            {
+                case TypeNode::Number:
+                    nodes[i] = std::make_unique<Number<Type>>(this->constants[record.left]);
+                    break;
+                case TypeNode::Variable:
+                    nodes[i] = std::make_unique<Variable<Type>>(this->variables[record.left]);
+                    break;
+                case TypeNode::Minus:
+                    nodes[i] = std::make_unique<Minus<Type>>(take(record.left));
+                    break;
+                case TypeNode::Sin:
+                    nodes[i] = std::make_unique<Sin<Type>>(take(record.left));
+                    break;
+                case TypeNode::Cos:
+                    nodes[i] = std::make_unique<Cos<Type>>(take(record.left));
+                    break;
+                case TypeNode::Exp:
+                    nodes[i] = std::make_unique<Exp<Type>>(take(record.left));
+                    break;
+                case TypeNode::Ln:
+                    nodes[i] = std::make_unique<Ln<Type>>(take(record.left));
+                    break;
+                case TypeNode::Addition:
+                {
+                    auto left = take(record.left);
+                    nodes[i] = std::make_unique<Addition<Type>>(std::move(left), take(record.right));
+                    break;
+                }
+                case TypeNode::Subtraction:
+                {
+                    auto left = take(record.left);
+                    nodes[i] = std::make_unique<Subtraction<Type>>(std::move(left), take(record.right));
+                    break;
+                }
+                case TypeNode::Multiplication:
+                {
+                    auto left = take(record.left);
+                    nodes[i] = std::make_unique<Multiplication<Type>>(std::move(left), take(record.right));
+                    break;
+                }
+                case TypeNode::Division:
+                {
+                    auto left = take(record.left);
+                    nodes[i] = std::make_unique<Division<Type>>(std::move(left), take(record.right));
+                    break;
+                }
+                case TypeNode::Power:
+                {
+                    auto left = take(record.left);
+                    nodes[i] = std::make_unique<Power<Type>>(std::move(left), take(record.right));
+                    break;
+                }
+            }
+            if(simplify)
+            {
+                nodes[i] = visit(*nodes[i], [](auto& self) { return self.rewrite(); });
+            }
+        }
+        return std::move(nodes.back());
+    }
+
+
+    // The same parentheses as the format of the nodes
+    template<typename Type>
+    std::string Tape<Type>::toString() const
+    {
+        std::vector<std::uint32_t> uses = this->countUses();
+        std::vector<std::string> strings(this->records.size());
+        std::vector<Priority> priorities(this->records.size());
+        auto take = [&](std::uint32_t index) {
+            return --uses[index] == 0 ? std::move(strings[index]) : strings[index];
+        };
+
+        for(std::size_t i = 0; i < this->records.size(); i++)
+        {
+            const Record& record = this->records[i];
+            if(arity(record.type) == 0)
+            {
+                std::unique_ptr<Node<Type>> leaf = record.type == TypeNode::Number
+                    ? std::unique_ptr<Node<Type>>(std::make_unique<Number<Type>>(this->constants[record.left]))
+                    : std::unique_ptr<Node<Type>>(std::make_unique<Variable<Type>>(this->variables[record.left]));
+                strings[i] = leaf->toString();
+                priorities[i] = leaf->getPriority();
+                continue;
+            }
+
+            std::string left = take(record.left);
+            const Priority leftPriority = priorities[record.left];
+            std::string right = arity(record.type) == 2 ? take(record.right) : std::string();
+            const Priority rightPriority = arity(record.type) == 2 ? priorities[record.right] : leftPriority;
+            switch(record.type)
+            {
+                case TypeNode::Minus:
+                    priorities[i] = Priority::Minus;
+                    if(left.front() == '-' || leftPriority <= Priority::Minus)
+                    {
+                        strings[i] = "-(" + left + ")";
+                        break;
+                    }
+                    strings[i] = "-" + left;
+                    break;
+                case TypeNode::Sin:
+                    priorities[i] = Priority::Sin;
+                    strings[i] = "sin(" + left + ")";
+                    break;
+                case TypeNode::Cos:
+                    priorities[i] = Priority::Cos;
+                    strings[i] = "cos(" + left + ")";
+                    break;
+                case TypeNode::Exp:
+                    priorities[i] = Priority::Exp;
+                    strings[i] = "exp(" + left + ")";
+                    break;
+                case TypeNode::Ln:
+                    priorities[i] = Priority::Ln;
+                    strings[i] = "ln(" + left + ")";
+                    break;
+                case TypeNode::Addition:
+                    priorities[i] = Priority::Addition;
+                    if(right.front() == '-')
+                    {
+                        right = "(" + right + ")";
+                    }
+                    strings[i] = std::move(left) + " + " + right;
+                    break;
+                case TypeNode::Subtraction:
+                    priorities[i] = Priority::Subtraction;
+                    if(right.front() == '-' || rightPriority <= Priority::Subtraction)
+                    {
+                        right = "(" + right + ")";
+                    }
+                    strings[i] = std::move(left) + " - " + right;
+                    break;
+                case TypeNode::Multiplication:
+                    priorities[i] = Priority::Multiplication;
+                    if(leftPriority < Priority::Multiplication)
+                    {
+                        left = "(" + left + ")";
+                    }
+                    if(right.front() == '-' || rightPriority < Priority::Multiplication)
+                    {
+                        right = "(" + right + ")";
+                    }
+                    strings[i] = std::move(left) + " * " + right;
+                    break;
+                case TypeNode::Division:
+                    priorities[i] = Priority::Division;
+                    if(leftPriority < Priority::Division)
+                    {
+                        left = "(" + left + ")";
+                    }
+                    if(right.front() == '-' || rightPriority <= Priority::Division)
+                    {
+                        right = "(" + right + ")";
+                    }
+                    strings[i] = std::move(left) + " / " + right;
+                    break;
+                case TypeNode::Power:
+                    priorities[i] = Priority::Power;
+                    if(left.front() == '-' || leftPriority <= Priority::Power)
+                    {
+                        left = "(" + left + ")";
+                    }
+                    if(right.front() == '-' || rightPriority <= Priority::Power)
+                    {
+                        right = "(" + right + ")";
+                    }
+                    strings[i] = left + "^" + right;
+                    break;
+                default: ;
+            }
+        }
+        return std::move(strings.back());
+    }
+
+
+    template<typename Type>
+    Type Tape<Type>::calculate(const std::vector<std::string>& variable, const std::vector<Type>& value) const
+    {
+        std::vector<const Type*> slots(this->variables.size(), nullptr);
+        for(std::size_t slot = 0; slot < this->variables.size(); slot++)
+        {
+            for(std::size_t i = 0; i < variable.size(); i++)
+            {
+                if(variable[i] == this->variables[slot])
+                {
+                    slots[slot] = &value[i];
+                    break;
+                }
+            }
+        }
+
+        std::vector<Type> results(this->records.size());
+        for(std::size_t i = 0; i < this->records.size(); i++)
+        {
+            // The operand of a leaf is a constant or a variable slot, not a record
+            const Record& record = this->records[i];
+            const std::size_t operands = arity(record.type);
+            const Type& left = operands >= 1 ? results[record.left] : results[i];
+            const Type& right = operands == 2 ? results[record.right] : results[i];
+            switch(record.type)
+            {
+                case TypeNode::Number:
+                    results[i] = this->constants[record.left];
+                    break;
+                case TypeNode::Variable:
+                    if(slots[record.left] == nullptr)
+                    {
+                        throw std::invalid_argument("The variable \"" + this->variables[record.left] + "\" has no value");
+                    }
+                    results[i] = *slots[record.left];
+                    break;
+                case TypeNode::Minus:
+                    results[i] = -left;
+                    break;
+                case TypeNode::Addition:
+                    results[i] = left + right;
+                    break;
+                case TypeNode::Subtraction:
+                    results[i] = left - right;
+                    break;
+                case TypeNode::Multiplication:
+                    results[i] = left * right;
+                    break;
+                case TypeNode::Division:
+                    if(right == Type{})
+                    {
+                        throw std::invalid_argument("Division by zero");
+                    }
+                    results[i] = left / right;
+                    break;
+                case TypeNode::Power:
+                    try
+                    {
+                        results[i] = std::pow(left, right);
+                    }
+                    catch(...)
+                    {
+                        throw std::invalid_argument("Error calculating power");
+                    }
+                    break;
+                case TypeNode::Sin:
+                    results[i] = std::sin(left);
+                    break;
+                case TypeNode::Cos:
+                    results[i] = std::cos(left);
+                    break;
+                case TypeNode::Exp:
+                    results[i] = std::exp(left);
+                    break;
+                case TypeNode::Ln:
+                    if(left == Type{})
+                    {
+                        throw std::invalid_argument("Logarithm from zero");
+                    }
+                    results[i] = std::log(left);
+                    break;
+            }
+        }
+        return results.back();
+    }
+
+
+    template<typename Type>
+    Tape<Type> Tape<Type>::differentiate(const std::string& variable) const
+    {
+        Tape derivative(*this);
+
+        std::uint32_t slot = 0;
+        while(slot < this->variables.size() && this->variables[slot] != variable)
+        {
+            slot++;
+        }
+
+        // The records of the expression stay in front, the derivatives are appended
+        const auto size = static_cast<std::uint32_t>(this->records.size());
+        std::vector<bool> dependent(size, false);
+        std::vector<std::uint32_t> derivatives(size);
+        const std::uint32_t zero = derivative.number(Type{});
+        for(std::uint32_t i = 0; i < size; i++)
+        {
+            const Record record = this->records[i];
+            switch(arity(record.type))
+            {
+                case 0:
+                    dependent[i] = record.type == TypeNode::Variable && record.left == slot;
+                    break;
+                case 1:
+                    dependent[i] = dependent[record.left];
+                    break;
+                default:
+                    dependent[i] = dependent[record.left] || dependent[record.right];
+            }
+
+            // c' = 0
+            if(!dependent[i])
+            {
+                derivatives[i] = zero;
+                continue;
+            }
+
+            const std::uint32_t left = arity(record.type) >= 1 ? derivatives[record.left] : zero;
+            const std::uint32_t right = arity(record.type) == 2 ? derivatives[record.right] : zero;
+            switch(record.type)
+            {
+                case TypeNode::Variable:
+                    derivatives[i] = derivative.number(getNumber<Type>(1.0));
+                    break;
+                case TypeNode::Minus:
+                    derivatives[i] = derivative.unary(TypeNode::Minus, left);
+                    break;
+                case TypeNode::Addition:
+                case TypeNode::Subtraction:
+                    derivatives[i] = derivative.binary(record.type, left, right);
+                    break;
+                // (u * v)' = u' * v + u * v'
+                case TypeNode::Multiplication:
+                    derivatives[i] = derivative.binary(TypeNode::Addition,
+                        derivative.binary(TypeNode::Multiplication, left, record.right),
+                        derivative.binary(TypeNode::Multiplication, record.left, right)
+                    );
+                    break;
+                // (u / v)' = (u' * v - u * v') / v^2
+                case TypeNode::Division:
+                    derivatives[i] = derivative.binary(TypeNode::Division,
+                        derivative.binary(TypeNode::Subtraction,
+                            derivative.binary(TypeNode::Multiplication, left, record.right),
+                            derivative.binary(TypeNode::Multiplication, record.left, right)
+                        ),
+                        derivative.binary(TypeNode::Power, record.right, derivative.number(getNumber<Type>(2.0)))
+                    );
+                    break;
+                // (u^v)' = v * u' * u^(v - 1) when v' = 0, which stays defined at u = 0
+                // (u^v)' = (v * u' / u + v' * ln(u)) * u^v otherwise
+                case TypeNode::Power:
+                    if(!dependent[record.right])
+                    {
+                        const Record& exponent = this->records[record.right];
+                        const std::uint32_t lowered = exponent.type == TypeNode::Number
+                            ? derivative.number(this->constants[exponent.left] - getNumber<Type>(1.0))
+                            : derivative.binary(TypeNode::Subtraction, record.right, derivative.number(getNumber<Type>(1.0)));
+                        derivatives[i] = derivative.binary(TypeNode::Multiplication,
+                            derivative.binary(TypeNode::Multiplication, record.right, left),
+                            derivative.binary(TypeNode::Power, record.left, lowered)
+                        );
+                        break;
+                    }
+                    derivatives[i] = derivative.binary(TypeNode::Multiplication,
+                        derivative.binary(TypeNode::Addition,
+                            derivative.binary(TypeNode::Division,
+                                derivative.binary(TypeNode::Multiplication, record.right, left),
+                                record.left
+                            ),
+                            derivative.binary(TypeNode::Multiplication, right, derivative.unary(TypeNode::Ln, record.left))
+                        ),
+                        i
+                    );
+                    break;
+                // sin(u)' = cos(u) * u'
+                case TypeNode::Sin:
+                    derivatives[i] = derivative.binary(TypeNode::Multiplication,
+                        derivative.unary(TypeNode::Cos, record.left),
+                        left
+                    );
+                    break;
+                // cos(u)' = -sin(u) * u'
+                case TypeNode::Cos:
+                    derivatives[i] = derivative.binary(TypeNode::Multiplication,
+                        derivative.unary(TypeNode::Minus, derivative.unary(TypeNode::Sin, record.left)),
+                        left
+                    );
+                    break;
+                // exp(u)' = exp(u) * u'
+                case TypeNode::Exp:
+                    derivatives[i] = derivative.binary(TypeNode::Multiplication, i, left);
+                    break;
+                // ln(u)' = 1 / u * u'
+                case TypeNode::Ln:
+                    derivatives[i] = derivative.binary(TypeNode::Multiplication,
+                        derivative.binary(TypeNode::Division, derivative.number(getNumber<Type>(1.0)), record.left),
+                        left
+                    );
+                    break;
+                default: ;
+            }
+        }
+
+        // The root must be the last record
+        if(size == 0 || derivatives.back() != derivative.records.size() - 1)
+        {
+            const std::uint32_t root = size == 0 ? zero : derivatives.back();
+            derivative.push(derivative.records[root]);
+        }
+        derivative.compact();
+        return derivative;
+    }
+
+
+    template<typename Type>
+    std::string Tape<Type>::serialize() const
+    {
+        static_assert(std::is_trivially_copyable_v<Type>);
+
+        std::string bytes = "TAPE";
+        auto put = [&bytes](const void* data, std::size_t size) {
+            bytes.append(static_cast<const char*>(data), size);
+        };
+        auto putCount = [&put](std::size_t count) {
+            const auto value = static_cast<std::uint32_t>(count);
+            put(&value, sizeof(value));
+        };
+
+        bytes.push_back(static_cast<char>(sizeof(Type)));
+        putCount(this->records.size());
+        putCount(this->constants.size());
+        putCount(this->variables.size());
+        for(const Record& record : this->records)
+        {
+            bytes.push_back(static_cast<char>(record.type));
+            put(&record.left, sizeof(record.left));
+            put(&record.right, sizeof(record.right));
+        }
+        put(this->constants.data(), this->constants.size() * sizeof(Type));
+        for(const std::string& name : this->variables)
+        {
+            putCount(name.size());
+            bytes += name;
+        }
+        return bytes;
+    }
+
+
+    template<typename Type>
+    Tape<Type> Tape<Type>::deserialize(const std::string& bytes)
+    {
+        std::size_t position = 0;
+        auto get = [&](void* data, std::size_t size) {
+            if(bytes.size() - position < size)
+            {
+                throw std::invalid_argument("Truncated tape");
+            }
+            std::memcpy(data, bytes.data() + position, size);
+            position += size;
+        };
+        auto getCount = [&get]() {
+            std::uint32_t value;
+            get(&value, sizeof(value));
+            return value;
+        };
+
+        char header[5];
+        get(header, sizeof(header));
+        if(std::string(header, 4) != "TAPE" || header[4] != static_cast<char>(sizeof(Type)))
+        {
+            throw std::invalid_argument("Not a tape of this type");
+        }
+
+        const std::uint64_t records = getCount();
+        const std::uint64_t constants = getCount();
+        const std::uint64_t variables = getCount();
+        // Corrupted counts must not allocate more than the input could hold
+        if(records * 9 + constants * sizeof(Type) + variables * 4 > bytes.size() - position)
+        {
+            throw std::invalid_argument("Truncated tape");
+        }
+
+        std::vector<Record> recordList(records);
+        for(Record& record : recordList)
+        {
+            std::uint8_t type;
+            get(&type, sizeof(type));
+            get(&record.left, sizeof(record.left));
+            get(&record.right, sizeof(record.right));
+            if(type > static_cast<std::uint8_t>(TypeNode::Ln))
+            {
+                throw std::invalid_argument("Unknown record type");
+            }
+            record.type = static_cast<TypeNode>(type);
+        }
+        std::vector<Type> constantList(constants);
+        get(constantList.data(), constantList.size() * sizeof(Type));
+        std::vector<std::string> variableList(variables);
+        for(std::string& name : variableList)
+        {
+            const std::uint32_t length = getCount();
+            if(length > bytes.size() - position)
+            {
+                throw std::invalid_argument("Truncated tape");
+            }
+            name.assign(bytes, position, length);
+            position += length;
+        }
+        if(position != bytes.size())
+        {
+            throw std::invalid_argument("Trailing bytes after the tape");
+        }
+        return Tape(std::move(recordList), std::move(constantList), std::move(variableList));
+    }
+
+
+    template<typename Type>
+    std::size_t Tape<Type>::size() const
+    {
+        return this->records.size();
+    }
+
+
+    template<typename Type>
+    const std::vector<typename Tape<Type>::Record>& Tape<Type>::getRecords() const
+    {
+        return this->records;
+    }
+
+
+    template<typename Type>
+    const std::vector<Type>& Tape<Type>::getConstants() const
+    {
+        return this->constants;
+    }
+
+
+    template<typename Type>
+    const std::vector<std::string>& Tape<Type>::getVariables() const
+    {
+        return this->variables;
+    }
+
+
+    template<typename Type>
+    std::size_t Tape<Type>::arity(TypeNode type)
+    {
+        switch(type)
+        {
+            case TypeNode::Number:
+            case TypeNode::Variable:
+                return 0;
+            case TypeNode::Minus:
+            case TypeNode::Sin:
+            case TypeNode::Cos:
+            case TypeNode::Exp:
+            case TypeNode::Ln:
+                return 1;
+            default:
+                return 2;
+        }
+    }
+
+
+    template<typename Type>
+    std::uint32_t Tape<Type>::push(const Record& record)
+    {
+        this->records.push_back(record);
+        return static_cast<std::uint32_t>(this->records.size() - 1);
+    }
+
+
+    template<typename Type>
+    std::uint32_t Tape<Type>::number(Type value)
+    {
+        this->constants.push_back(value);
+        return this->push({TypeNode::Number, static_cast<std::uint32_t>(this->constants.size() - 1), 0});
+    }
+
+
+    template<typename Type>
+    std::uint32_t Tape<Type>::unary(TypeNode type, std::uint32_t argument)
+    {
+        // -(-x) = x
+        if(type == TypeNode::Minus && this->records[argument].type == TypeNode::Minus)
+        {
+            return this->records[argument].left;
+        }
+        return this->push({type, argument, 0});
+    }
+
+
+    template<typename Type>
+    std::uint32_t Tape<Type>::binary(TypeNode type, std::uint32_t left, std::uint32_t right)
+    {
+        switch(type)
+        {
+            case TypeNode::Addition:
+                // 0 + x = x
+                if(this->isNumber(left, 0.0))
+                {
+                    return right;
+                }
+                // x + 0 = x
+                if(this->isNumber(right, 0.0))
+                {
+                    return left;
+                }
+                break;
+            case TypeNode::Subtraction:
+                // x - 0 = x
+                if(this->isNumber(right, 0.0))
+                {
+                    return left;
+                }
+                // 0 - x = -x
+                if(this->isNumber(left, 0.0))
+                {
+                    return this->unary(TypeNode::Minus, right);
+                }
+                break;
+            case TypeNode::Multiplication:
+                // 0 * x = x * 0 = 0
+                if(this->isNumber(left, 0.0))
+                {
+                    return left;
+                }
+                if(this->isNumber(right, 0.0))
+                {
+                    return right;
+                }
+                // 1 * x = x
+                if(this->isNumber(left, 1.0))
+                {
+                    return right;
+                }
+                // x * 1 = x
+                if(this->isNumber(right, 1.0))
+                {
+                    return left;
+                }
+                break;
+            case TypeNode::Division:
+                // 0 / x = 0
+                if(this->isNumber(left, 0.0))
+                {
+                    return left;
+                }
+                // x / 1 = x
+                if(this->isNumber(right, 1.0))
+                {
+                    return left;
+                }
+                break;
+            default: ;
+        }
+        return this->push({type, left, right});
+    }
+
+
+    template<typename Type>
+    bool Tape<Type>::isNumber(std::uint32_t index, double value) const
+    {
+        const Record& record = this->records[index];
+        return record.type == TypeNode::Number && this->constants[record.left] == getNumber<Type>(value);
+    }
+
+
+    template<typename Type>
+    std::vector<std::uint32_t> Tape<Type>::countUses() const
+    {
+        std::vector<std::uint32_t> uses(this->records.size(), 0);
+        for(const Record& record : this->records)
+        {
+            const std::uint32_t operands[] {record.left, record.right};
+            for(std::size_t k = 0; k < arity(record.type); k++)
+            {
+                uses[operands[k]]++;
+            }
+        }
+        return uses;
+    }
+
+
+    template<typename Type>
+    void Tape<Type>::compact()
+    {
+        // Liveness runs backwards from the root, an operand always comes earlier
+        std::vector<bool> live(this->records.size(), false);
+        live.back() = true;
+        for(std::size_t i = this->records.size(); i-- > 0;)
+        {
+            const Record& record = this->records[i];
+            if(!live[i])
+            {
+                continue;
+            }
+            const std::uint32_t operands[] {record.left, record.right};
+            for(std::size_t k = 0; k < arity(record.type); k++)
+            {
+                live[operands[k]] = true;
+            }
+        }
+
+        constexpr auto none = static_cast<std::uint32_t>(-1);
+        std::vector<std::uint32_t> index(this->records.size(), none);
+        std::vector<std::uint32_t> slots(this->variables.size(), none);
+        std::vector<Record> records;
+        std::vector<Type> constants;
+        std::vector<std::string> variables;
+        for(std::size_t i = 0; i < this->records.size(); i++)
+        {
+            if(!live[i])
+            {
+                continue;
+            }
+            Record record = this->records[i];
+            switch(arity(record.type))
+            {
+                case 0:
+                    if(record.type == TypeNode::Number)
+                    {
+                        constants.push_back(this->constants[record.left]);
+                        record.left = static_cast<std::uint32_t>(constants.size() - 1);
+                    }
+                    else
+                    {
+                        if(slots[record.left] == none)
+                        {
+                            slots[record.left] = static_cast<std::uint32_t>(variables.size());
+                            variables.push_back(this->variables[record.left]);
+                        }
+                        record.left = slots[record.left];
+                    }
+                    break;
+                case 1:
+                    record.left = index[record.left];
+                    break;
+                default:
+                    record.left = index[record.left];
+                    record.right = index[record.right];
+            }
+            index[i] = static_cast<std::uint32_t>(records.size());
+            records.push_back(record);
+        }
+
+        this->records = std::move(records);
+        this->constants = std::move(constants);
+        this->variables = std::move(variables);
+    }
+} // Math
+
+
+#endif // TAPE_HPP
@@ -0,0 +1,239 @@
+#ifndef TASK_POOL_HPP
+#define TASK_POOL_HPP
+
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace Math
+{
+    // Worker threads for batches of independent tasks. A batch is spread over the queues
+    // of all workers, a worker takes from the back of its own queue and steals from the
+    // front of the others when it runs out. The thread that calls run takes tasks as well
+    // until its batch is done, so a task may call run itself.
+    class TaskPool
+    {
+    public:
+        explicit TaskPool(std::size_t workers = std::thread::hardware_concurrency());
+        ~TaskPool();
+
+        TaskPool(const TaskPool&) = delete;
+        TaskPool& operator=(const TaskPool&) = delete;
+
+        static TaskPool& global();
+
+        [[nodiscard]] std::size_t size() const;
+
+        // Returns when every task has finished, rethrows the first exception of a task
+        void run(const std::vector<std::function<void()>>& tasks);
+
+    private:
+        struct Batch
+        {
+            std::mutex mutex;
+            std::condition_variable done;
+            std::atomic<std::size_t> pending;
+            std::exception_ptr error;
+        };
+
+        struct Task
+        {
+            const std::function<void()>* work;
+            Batch* batch;
+        };
+
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        void work(std::size_t own);
+
+        bool take(std::size_t own, Task& task);
+        static void execute(const Task& task);
+
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::vector<std::thread> threads;
+        std::atomic<std::size_t> next = 0;
+
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::size_t queued = 0;
+        bool stop = false;
+    };
+} // Math
+
+
+
+// Implementation
+namespace Math
+{
+    inline TaskPool::TaskPool(std::size_t workers)
+    {
+        workers = std::max<std::size_t>(workers, 1);
+        for(std::size_t i = 0; i < workers; i++)
+        {
+            this->queues.push_back(std::make_unique<Queue>());
+        }
+        for(std::size_t i = 0; i < workers; i++)
+        {
+            this->threads.emplace_back([this, i]() { this->work(i); });
+        }
+    }
+
+
+    inline TaskPool::~TaskPool()
+    {
+        {
+            std::lock_guard lock(this->mutex);
+            this->stop = true;
+        }
+        this->wake.notify_all();
+        for(std::thread& thread : this->threads)
+        {
+            thread.join();
+        }
+    }
+
+
+    inline TaskPool& TaskPool::global()
+    {
+        static TaskPool pool;
+        return pool;
+    }
+
+
+    inline std::size_t TaskPool::size() const
+    {
+        return this->threads.size();
+    }
+
+
+    inline void TaskPool::run(const std::vector<std::function<void()>>& tasks)
+    {
+        if(tasks.empty())
+        {
+            return;
+        }
+
+        Batch batch;
+        batch.pending = tasks.size();
+        const std::size_t start = this->next.fetch_add(1, std::memory_order_relaxed);
+        for(std::size_t k = 0; k < tasks.size(); k++)
+        {
+            Queue& queue = *this->queues[(start + k) % this->queues.size()];
+            std::lock_guard lock(queue.mutex);
+            queue.tasks.push_back({&tasks[k], &batch});
+        }
+        {
+            std::lock_guard lock(this->mutex);
+            this->queued += tasks.size();
+        }
+        this->wake.notify_all();
+
+        // Help while there is something to take, then wait for the tasks still running
+        Task task {};
+        while(batch.pending > 0 && this->take(start % this->queues.size(), task))
+        {
+            execute(task);
+        }
+        {
+            std::unique_lock lock(batch.mutex);
+            batch.done.wait(lock, [&batch]() { return batch.pending == 0; });
+        }
+        if(batch.error)
+        {
+            std::rethrow_exception(batch.error);
+        }
+    }
+
+
+    inline void TaskPool::work(std::size_t own)
+    {
+        Task task {};
+        while(true)
+        {
+            if(this->take(own, task))
+            {
+                execute(task);
+                continue;
+            }
+            std::unique_lock lock(this->mutex);
+            this->wake.wait(lock, [this]() { return this->stop || this->queued > 0; });
+            if(this->stop)
+            {
+                return;
+            }
+        }
+    }
+
+
+    inline bool TaskPool::take(std::size_t own, Task& task)
+    {
+        for(std::size_t k = 0; k < this->queues.size(); k++)
+        {
+            Queue& queue = *this->queues[(own + k) % this->queues.size()];
+            {
+                std::lock_guard lock(queue.mutex);
+                if(queue.tasks.empty())
+                {
+                    continue;
+                }
+                if(k == 0)
+                {
+                    task = queue.tasks.back();
+                    queue.tasks.pop_back();
+                }
+                else
+                {
+                    task = queue.tasks.front();
+                    queue.tasks.pop_front();
+                }
+            }
+            std::lock_guard lock(this->mutex);
+            this->queued--;
+            return true;
+        }
+        return false;
+    }
+
+
+    inline void TaskPool::execute(const Task& task)
+    {
+        std::exception_ptr error;
+        try
+        {
+            (*task.work)();
+        }
+        catch(...)
+        {
+            error = std::current_exception();
+        }
+
+        // The batch lives on the stack of run, which returns only after taking this lock
+        Batch& batch = *task.batch;
+        std::lock_guard lock(batch.mutex);
+        if(error && !batch.error)
+        {
+            batch.error = error;
+        }
+        if(--batch.pending == 0)
+        {
+            batch.done.notify_all();
+        }
+    }
+} // Math
+
+
+#endif // TASK_POOL_HPP
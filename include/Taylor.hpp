@@ -0,0 +1,346 @@
+#ifndef TAYLOR_HPP
+#define TAYLOR_HPP
+
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Dag.hpp"
+#include "Evaluator.hpp"
+
+
+namespace Math
+{
+    // Forward mode with truncated Taylor series. Every instruction carries the
+    // coefficients u_0..u_n of its expansion in one variable, so all derivatives
+    // up to order n cost one sweep of O(n^2) work per instruction.
+    template<typename Type>
+    class Taylor
+    {
+    public:
+        Taylor(const Dag<Type>& dag, std::uint32_t output);
+
+        [[nodiscard]] const std::vector<std::string>& getVariables() const;
+
+        // f, f', ..., f^(order) by the variable "by"
+        std::vector<Type> calculate(const std::string& by, int order, const std::vector<std::string>& variable, const std::vector<Type>& value) const;
+
+        // Coefficients f^(k)(x) / k! by the variable in the given slot, nothing is seeded if the slot is out of range
+        std::vector<Type> coefficients(std::size_t slot, int order, const std::vector<Type>& value) const;
+
+    private:
+        Evaluator<Type> evaluator;
+
+        static void multiply(const Type* u, const Type* v, Type* w, std::size_t n);
+        static void divide(const Type* u, const Type* v, Type* w, std::size_t n);
+        static void exp(const Type* u, Type* w, std::size_t n);
+        static void log(const Type* u, Type* w, std::size_t n);
+        static void sincos(const Type* u, Type* s, Type* c, std::size_t n);
+        static void power(const Type* u, const Type& r, Type* w, std::size_t n);
+        static void power(const Type* u, std::uint64_t r, Type* w, std::size_t n);
+
+        static bool isNatural(const Type& value);
+    };
+} // Math
+
+
+
+// Implementation
+namespace Math
+{
+    template<typename Type>
+    Taylor<Type>::Taylor(const Dag<Type>& dag, std::uint32_t output)
+        : evaluator(dag, {output})
+    {
+    }
+
+
+    template<typename Type>
+    const std::vector<std::string>& Taylor<Type>::getVariables() const
+    {
+        return this->evaluator.getVariables();
+    }
+
+
+    template<typename Type>
+    std::vector<Type> Taylor<Type>::calculate(const std::string& by, int order, const std::vector<std::string>& variable, const std::vector<Type>& value) const
+    {
+        const auto& variables = this->evaluator.getVariables();
+        std::size_t slot = std::find(variables.begin(), variables.end(), by) - variables.begin();
+
+        std::vector<Type> result = this->coefficients(slot, order, this->evaluator.getSlots(variable, value));
+        Type factorial(1);
+        for(std::size_t k = 1; k < result.size(); k++)
+        {
+            factorial *= Type(k);
+            result[k] *= factorial;
+        }
+        return result;
+    }
+
+
+    template<typename Type>
+    std::vector<Type> Taylor<Type>::coefficients(std::size_t slot, int order, const std::vector<Type>& value) const
+    {
+        if(order < 0)
+        {
+            throw std::invalid_argument("Negative order of the derivative");
+        }
+
+        const auto& program = this->evaluator.getProgram();
+        const auto& constants = this->evaluator.getConstants();
+        const std::size_t n = order + 1;
+        std::vector<Type> series(program.size() * n);
+        std::vector<Type> buffer(2 * n);
+
+        for(std::size_t i = 0; i < program.size(); i++)
+        {
+            const auto& instruction = program[i];
+            const Type* u = series.data() + instruction.left * n;
+            const Type* v = series.data() + instruction.right * n;
+            Type* w = series.data() + i * n;
+            switch(instruction.type)
+            {
+                case TypeNode::Number:
+                    w[0] = constants[instruction.left];
+                    break;
+                case TypeNode::Variable:
+                    w[0] = value[instruction.left];
+                    if(instruction.left == slot && n > 1)
+                    {
+                        w[1] = Type(1);
+                    }
+                    break;
+                case TypeNode::Minus:
+                    for(std::size_t k = 0; k < n; k++)
+                    {
+                        w[k] = -u[k];
+                    }
+                    break;
+                case TypeNode::Addition:
+                    for(std::size_t k = 0; k < n; k++)
+                    {
+                        w[k] = u[k] + v[k];
+                    }
+                    break;
+                case TypeNode::Subtraction:
+                    for(std::size_t k = 0; k < n; k++)
+                    {
+                        w[k] = u[k] - v[k];
+                    }
+                    break;
+                case TypeNode::Multiplication:
+                    multiply(u, v, w, n);
+                    break;
+                case TypeNode::Division:
+                    if(v[0] == Type{})
+                    {
+                        throw std::invalid_argument("Division by zero");
+                    }
+                    divide(u, v, w, n);
+                    break;
+                case TypeNode::Power:
+                    // A constant exponent needs only the recurrence u w' = r u' w
+                    if(std::all_of(v + 1, v + n, [](const Type& x) { return x == Type{}; }))
+                    {
+                        if(u[0] != Type{})
+                        {
+                            power(u, v[0], w, n);
+                        }
+                        else if(isNatural(v[0]))
+                        {
+                            power(u, static_cast<std::uint64_t>(std::real(v[0])), w, n);
+                        }
+                        else
+                        {
+                            // u = u_m t^m + ..., so u^r starts at order m r: zero below it, not a
+                            // power series from it on
+                            std::size_t m = 0;
+                            while(m < n && u[m] == Type{})
+                            {
+                                m++;
+                            }
+                            if(std::imag(v[0]) != 0 || !(static_cast<double>(n - 1) < static_cast<double>(m) * std::real(v[0])))
+                            {
+                                throw std::invalid_argument("Error calculating power");
+                            }
+                            std::fill(w, w + n, Type{});
+                        }
+                        break;
+                    }
+                    // u^v = exp(v ln(u))
+                    if(u[0] == Type{})
+                    {
+                        throw std::invalid_argument("Error calculating power");
+                    }
+                    log(u, buffer.data(), n);
+                    multiply(v, buffer.data(), buffer.data() + n, n);
+                    exp(buffer.data() + n, w, n);
+                    break;
+                case TypeNode::Sin:
+                    sincos(u, w, buffer.data(), n);
+                    break;
+                case TypeNode::Cos:
+                    sincos(u, buffer.data(), w, n);
+                    break;
+                case TypeNode::Exp:
+                    exp(u, w, n);
+                    break;
+                case TypeNode::Ln:
+                    if(u[0] == Type{})
+                    {
+                        throw std::invalid_argument("Logarithm from zero");
+                    }
+                    log(u, w, n);
+                    break;
+            }
+        }
+
+        auto output = series.begin() + this->evaluator.getOutputs().front() * n;
+        return std::vector<Type>(output, output + n);
+    }
+
+
+    // w_k = sum u_j v_(k-j)
+    template<typename Type>
+    void Taylor<Type>::multiply(const Type* u, const Type* v, Type* w, std::size_t n)
+    {
+        for(std::size_t k = n; k-- > 0;)
+        {
+            Type sum {};
+            for(std::size_t j = 0; j <= k; j++)
+            {
+                sum += u[j] * v[k - j];
+            }
+            w[k] = sum;
+        }
+    }
+
+
+    // w_k = (u_k - sum v_j w_(k-j)) / v_0
+    template<typename Type>
+    void Taylor<Type>::divide(const Type* u, const Type* v, Type* w, std::size_t n)
+    {
+        for(std::size_t k = 0; k < n; k++)
+        {
+            Type sum = u[k];
+            for(std::size_t j = 1; j <= k; j++)
+            {
+                sum -= v[j] * w[k - j];
+            }
+            w[k] = sum / v[0];
+        }
+    }
+
+
+    // w' = u' w
+    template<typename Type>
+    void Taylor<Type>::exp(const Type* u, Type* w, std::size_t n)
+    {
+        w[0] = std::exp(u[0]);
+        for(std::size_t k = 1; k < n; k++)
+        {
+            Type sum {};
+            for(std::size_t j = 1; j <= k; j++)
+            {
+                sum += Type(j) * u[j] * w[k - j];
+            }
+            w[k] = sum / Type(k);
+        }
+    }
+
+
+    // u w' = u'
+    template<typename Type>
+    void Taylor<Type>::log(const Type* u, Type* w, std::size_t n)
+    {
+        w[0] = std::log(u[0]);
+        for(std::size_t k = 1; k < n; k++)
+        {
+            Type sum {};
+            for(std::size_t j = 1; j < k; j++)
+            {
+                sum += Type(j) * w[j] * u[k - j];
+            }
+            w[k] = (u[k] - sum / Type(k)) / u[0];
+        }
+    }
+
+
+    // s' = u' c, c' = -u' s
+    template<typename Type>
+    void Taylor<Type>::sincos(const Type* u, Type* s, Type* c, std::size_t n)
+    {
+        s[0] = std::sin(u[0]);
+        c[0] = std::cos(u[0]);
+        for(std::size_t k = 1; k < n; k++)
+        {
+            Type sine {};
+            Type cosine {};
+            for(std::size_t j = 1; j <= k; j++)
+            {
+                sine += Type(j) * u[j] * c[k - j];
+                cosine -= Type(j) * u[j] * s[k - j];
+            }
+            s[k] = sine / Type(k);
+            c[k] = cosine / Type(k);
+        }
+    }
+
+
+    // u w' = r u' w, requires u_0 != 0
+    template<typename Type>
+    void Taylor<Type>::power(const Type* u, const Type& r, Type* w, std::size_t n)
+    {
+        w[0] = std::pow(u[0], r);
+        for(std::size_t k = 1; k < n; k++)
+        {
+            Type sum {};
+            for(std::size_t j = 1; j <= k; j++)
+            {
+                sum += (r * Type(j) - Type(k - j)) * u[j] * w[k - j];
+            }
+            w[k] = sum / (Type(k) * u[0]);
+        }
+    }
+
+
+    // Binary powering, valid for u_0 = 0
+    template<typename Type>
+    void Taylor<Type>::power(const Type* u, std::uint64_t r, Type* w, std::size_t n)
+    {
+        std::vector<Type> base(u, u + n);
+        std::vector<Type> buffer(n);
+        std::fill(w, w + n, Type{});
+        w[0] = Type(1);
+        while(r > 0)
+        {
+            if(r & 1)
+            {
+                multiply(w, base.data(), buffer.data(), n);
+                std::copy(buffer.begin(), buffer.end(), w);
+            }
+            r >>= 1;
+            if(r > 0)
+            {
+                multiply(base.data(), base.data(), buffer.data(), n);
+                base.swap(buffer);
+            }
+        }
+    }
+
+
+    template<typename Type>
+    bool Taylor<Type>::isNatural(const Type& value)
+    {
+        return std::imag(value) == 0 && std::real(value) >= 0 && std::floor(std::real(value)) == std::real(value);
+    }
+} // Math
+
+
+#endif // TAYLOR_HPP
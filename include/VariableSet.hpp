@@ -0,0 +1,66 @@
+#ifndef VARIABLE_SET_HPP
+#define VARIABLE_SET_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace Math
+{
+    // Process-wide interning of variable names into dense ids
+    std::size_t internVariable(const std::string& name);
+    std::size_t findVariable(const std::string& name);
+    const std::string& variableName(std::size_t id);
+
+    inline constexpr std::size_t noVariable = static_cast<std::size_t>(-1);
+
+
+    // Sorted ids of a set of variables. Most sets are small, so they are stored inline,
+    // and a bit per id modulo 64 answers most misses without a search. The nodes keep
+    // only that summary, a full set per node would grow with the square of the variables.
+    class VariableSet
+    {
+    public:
+        VariableSet() = default;
+        VariableSet(const VariableSet& other);
+        VariableSet(VariableSet&& other) noexcept;
+
+        VariableSet& operator=(const VariableSet& other);
+        VariableSet& operator=(VariableSet&& other) noexcept;
+
+        void insert(std::size_t id);
+
+        [[nodiscard]] bool contains(std::size_t id) const;
+        [[nodiscard]] bool intersects(const VariableSet& other) const;
+        [[nodiscard]] bool isSubsetOf(const VariableSet& other) const;
+        [[nodiscard]] bool empty() const;
+
+        [[nodiscard]] std::vector<std::size_t> getIds() const;
+
+        // Bit id % 64 of every id, a clear bit rules the id out
+        [[nodiscard]] std::uint64_t getSummary() const;
+        static std::uint64_t bit(std::size_t id);
+
+        VariableSet& operator|=(const VariableSet& other);
+        bool operator==(const VariableSet& other) const;
+
+    private:
+        static constexpr std::size_t inlineCapacity = 3;
+
+        [[nodiscard]] const std::uint32_t* begin() const;
+        [[nodiscard]] const std::uint32_t* end() const;
+
+        void assign(std::vector<std::uint32_t>&& ids);
+
+        std::uint64_t summary = 0;
+        std::uint32_t count = 0;
+        std::uint32_t inlineIds[inlineCapacity] {};
+        std::vector<std::uint32_t> heapIds;
+    };
+} // Math
+
+
+#endif // VARIABLE_SET_HPP
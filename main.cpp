@@ -201,14 +201,20 @@ void differentiate(const std::string& string, const std::string& variable, int n
 
     auto start{ std::chrono::high_resolution_clock::now() };
 
+    // The orders share one graph, only the printed result is expanded and simplified
+    const auto derivative = expression.derivative(variable, number);
+    auto differentiated{ std::chrono::high_resolution_clock::now() };
     expression = expression.differentiate(variable, number);
 
     auto end{ std::chrono::high_resolution_clock::now() };
     auto duration { std::chrono::duration_cast<std::chrono::milliseconds>(end - start) };
+    auto differentiation { std::chrono::duration_cast<std::chrono::microseconds>(differentiated - start) };
 
     std::cout << "-----------------------------------------------\n";
     std::cout << "After differentiation and simplification:\n"
                  "\t" << expression << "\n";
+    std::cout << "Shared subexpressions: " << derivative.size() << '\n';
+    std::cout << "Differentiation time: " << differentiation << '\n';
     std::cout << "Calculation time: " << duration << '\n';
 }
 
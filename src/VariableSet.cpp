@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "../include/VariableSet.hpp"
+
+
+namespace Math
+{
+    namespace
+    {
+        struct VariableTable
+        {
+            std::shared_mutex mutex;
+            std::unordered_map<std::string, std::size_t> ids;
+            std::deque<std::string> names;
+        };
+
+        VariableTable& getTable()
+        {
+            static VariableTable table;
+            return table;
+        }
+    }
+
+
+    std::size_t internVariable(const std::string& name)
+    {
+        VariableTable& table = getTable();
+        {
+            std::shared_lock lock(table.mutex);
+            auto iter = table.ids.find(name);
+            if(iter != table.ids.end())
+            {
+                return iter->second;
+            }
+        }
+        std::unique_lock lock(table.mutex);
+        auto [iter, inserted] = table.ids.emplace(name, table.names.size());
+        if(inserted)
+        {
+            table.names.push_back(name);
+        }
+        return iter->second;
+    }
+
+
+    std::size_t findVariable(const std::string& name)
+    {
+        VariableTable& table = getTable();
+        std::shared_lock lock(table.mutex);
+        auto iter = table.ids.find(name);
+        if(iter == table.ids.end())
+        {
+            return noVariable;
+        }
+        return iter->second;
+    }
+
+
+    const std::string& variableName(std::size_t id)
+    {
+        VariableTable& table = getTable();
+        std::shared_lock lock(table.mutex);
+        return table.names.at(id);
+    }
+
+
+    VariableSet::VariableSet(const VariableSet& other)
+        : summary(other.summary), count(other.count), heapIds(other.heapIds)
+    {
+        std::copy(other.inlineIds, other.inlineIds + inlineCapacity, this->inlineIds);
+    }
+
+
+    VariableSet::VariableSet(VariableSet&& other) noexcept
+        : summary(other.summary), count(other.count), heapIds(std::move(other.heapIds))
+    {
+        std::copy(other.inlineIds, other.inlineIds + inlineCapacity, this->inlineIds);
+        other.summary = 0;
+        other.count = 0;
+    }
+
+
+    VariableSet& VariableSet::operator=(const VariableSet& other)
+    {
+        this->summary = other.summary;
+        this->count = other.count;
+        std::copy(other.inlineIds, other.inlineIds + inlineCapacity, this->inlineIds);
+        if(other.count > inlineCapacity)
+        {
+            this->heapIds = other.heapIds;
+        }
+        else
+        {
+            this->heapIds = {};
+        }
+        return *this;
+    }
+
+
+    VariableSet& VariableSet::operator=(VariableSet&& other) noexcept
+    {
+        this->summary = other.summary;
+        this->count = other.count;
+        std::copy(other.inlineIds, other.inlineIds + inlineCapacity, this->inlineIds);
+        this->heapIds = std::move(other.heapIds);
+        other.summary = 0;
+        other.count = 0;
+        return *this;
+    }
+
+
+    void VariableSet::insert(std::size_t id)
+    {
+        if(this->contains(id))
+        {
+            return;
+        }
+        std::vector<std::uint32_t> ids(this->begin(), this->end());
+        ids.insert(std::lower_bound(ids.begin(), ids.end(), id), static_cast<std::uint32_t>(id));
+        this->assign(std::move(ids));
+    }
+
+
+    bool VariableSet::contains(std::size_t id) const
+    {
+        return (this->summary & bit(id)) && std::binary_search(this->begin(), this->end(), id);
+    }
+
+
+    bool VariableSet::intersects(const VariableSet& other) const
+    {
+        if(!(this->summary & other.summary))
+        {
+            return false;
+        }
+        const std::uint32_t* first = this->begin();
+        const std::uint32_t* second = other.begin();
+        while(first != this->end() && second != other.end())
+        {
+            if(*first == *second)
+            {
+                return true;
+            }
+            *first < *second ? ++first : ++second;
+        }
+        return false;
+    }
+
+
+    bool VariableSet::isSubsetOf(const VariableSet& other) const
+    {
+        if(this->summary & ~other.summary)
+        {
+            return false;
+        }
+        return std::includes(other.begin(), other.end(), this->begin(), this->end());
+    }
+
+
+    bool VariableSet::empty() const
+    {
+        return this->count == 0;
+    }
+
+
+    std::vector<std::size_t> VariableSet::getIds() const
+    {
+        return std::vector<std::size_t>(this->begin(), this->end());
+    }
+
+
+    std::uint64_t VariableSet::getSummary() const
+    {
+        return this->summary;
+    }
+
+
+    VariableSet& VariableSet::operator|=(const VariableSet& other)
+    {
+        // The operands of a node often depend on the same variables
+        if(other.isSubsetOf(*this))
+        {
+            return *this;
+        }
+        if(this->isSubsetOf(other))
+        {
+            return *this = other;
+        }
+        std::vector<std::uint32_t> ids;
+        ids.reserve(this->count + other.count);
+        std::set_union(this->begin(), this->end(), other.begin(), other.end(), std::back_inserter(ids));
+        this->assign(std::move(ids));
+        return *this;
+    }
+
+
+    bool VariableSet::operator==(const VariableSet& other) const
+    {
+        return this->summary == other.summary && std::equal(this->begin(), this->end(), other.begin(), other.end());
+    }
+
+
+    const std::uint32_t* VariableSet::begin() const
+    {
+        return this->count > inlineCapacity ? this->heapIds.data() : this->inlineIds;
+    }
+
+
+    const std::uint32_t* VariableSet::end() const
+    {
+        return this->begin() + this->count;
+    }
+
+
+    void VariableSet::assign(std::vector<std::uint32_t>&& ids)
+    {
+        this->summary = 0;
+        for(const std::uint32_t id : ids)
+        {
+            this->summary |= bit(id);
+        }
+        this->count = static_cast<std::uint32_t>(ids.size());
+        if(ids.size() > inlineCapacity)
+        {
+            this->heapIds = std::move(ids);
+            return;
+        }
+        std::copy(ids.begin(), ids.end(), this->inlineIds);
+        this->heapIds = {};
+    }
+
+
+    std::uint64_t VariableSet::bit(std::size_t id)
+    {
+        return std::uint64_t{1} << (id % 64);
+    }
+} // Math
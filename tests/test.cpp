@@ -1,7 +1,42 @@
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <map>
+#include <new>
+#include <thread>
 
 #include "../include/Expression.hpp"
+#include "../include/System.hpp"
+#include "../include/DiskCache.hpp"
+#include "../include/ConcurrentDag.hpp"
+
+
+// Bytes requested from operator new so far, for the tests of memory growth
+std::atomic<std::size_t> allocated = 0;
+
+void* operator new(std::size_t size)
+{
+    allocated.fetch_add(size, std::memory_order_relaxed);
+    if(void* pointer = std::malloc(size == 0 ? 1 : size))
+    {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
 
 
 void check(bool result)
@@ -472,6 +507,1184 @@ void testDifferentiate()
 }
 
 
+void testDag()
+{
+    std::cout << std::left << std::setw(40) <<  "Derivative Graph: ";
+
+    using namespace Math;
+
+    Dag<double> dag;
+    auto node = Parser<double>("sin(x) * sin(x) + exp(sin(x))").parseExpression();
+    auto index = dag.add(node);
+    auto size = dag.size();
+    auto derivative = dag.differentiate(index, "x");
+
+    Dag<double> graph;
+    auto root = graph.add(Parser<double>("exp(sin(x)) / (1 + x^2)").parseExpression());
+    auto third = graph.differentiate(root, "x", 3);
+    graph.differentiate(root, "x", 10);
+
+    bool result = (size == 5)
+        && (dag.toNode(index)->toString() == node->toString())
+        && (dag.differentiate(index, "x") == derivative)
+        && (dag.toNode(derivative)->toString() == "cos(x) * sin(x) + sin(x) * cos(x) + exp(sin(x)) * cos(x)")
+        && (dag.toNode(dag.differentiate(index, "y"))->toString() == "0")
+        && (graph.size() < 10000)
+        && (std::abs(graph.toNode(third)->calculate({"x"}, {0.5})
+            - Expression<double>("exp(sin(x)) / (1 + x^2)").differentiate("x", 3).calculate({"x"}, {0.5})) < 1e-9);
+
+    // The orders share one graph, the tape of the 8th derivative of x^x stays small
+    const Expression<double> power("x^x");
+    auto tape = power.derivative("x", 8);
+    result = result && (tape.size() < 1000)
+        && (std::abs(tape.calculate({"x"}, {1.5}) - power.differentiate("x", 8).calculate({"x"}, {1.5})) < 1e-9 * std::abs(tape.calculate({"x"}, {1.5})))
+        && (tape.simplify()->toString() == tape.toNode()->simplify()->toString())
+        && (power.derivative("x", 1).toString() == "(x / x + ln(x)) * x^x");
+
+    check(result);
+}
+
+
+void testFreeVariables()
+{
+    std::cout << std::left << std::setw(40) <<  "Free Variables: ";
+
+    using namespace Math;
+    using exd = Expression<double>;
+
+    exd var1("sin(x * y) + exp(z) - 2");
+    exd var2 = var1.substitute("z", exd("w + 1"));
+    exd var3("cos(a) * ln(b)");
+
+    Dag<double> dag;
+    auto index = dag.add(Parser<double>("sin(x) * y + cos(z)").parseExpression());
+
+    bool result = (var1.freeVariables() == std::set<std::string>{"x", "y", "z"})
+        && (var2.freeVariables() == std::set<std::string>{"w", "x", "y"})
+        && (exd(5).freeVariables().empty())
+        && (var1.substitute("q", exd(1)).toString() == "sin(x * y) + exp(z) - 2")
+        && (var3.differentiate("x").toString() == "0")
+        && (var3.differentiate("a").toString() == "-sin(a) * ln(b)")
+        && (dag.getVariables(index).contains(findVariable("z")))
+        && (!dag.getVariables(index).contains(findVariable("w")))
+        && (dag.toNode(dag.differentiate(index, "w"))->toString() == "0");
+
+    // c0 and c64 share a bit of the summary, the exact answers still tell them apart
+    for(int i = 0; i <= 64; i++)
+    {
+        internVariable("c" + std::to_string(i));
+    }
+    const bool collide = (findVariable("c64") - findVariable("c0")) % 64 == 0;
+    exd collision("sin(c0) * 2");
+    auto collisionIndex = dag.add(Parser<double>("sin(c0) * 2").parseExpression());
+    result = result && collide && (collision.freeVariables() == std::set<std::string>{"c0"})
+        && (collision.differentiate("c64").toString() == "0")
+        && (collision.substitute("c64", exd(1)).toString() == "sin(c0) * 2")
+        && (dag.toNode(dag.differentiate(collisionIndex, "c64"))->toString() == "0")
+        && (dag.toNode(dag.specialize(collisionIndex, {{"c64", 1.0}}))->toString() == "sin(c0) * 2");
+
+    // A sum over distinct variables takes memory linear in its terms
+    auto build = [](int terms) {
+        const std::size_t before = allocated;
+        exd sum("0");
+        for(int i = 0; i < terms; i++)
+        {
+            sum += exd("v" + std::to_string(i));
+        }
+        return allocated - before;
+    };
+    build(8000);
+    const std::size_t small = build(2000);
+    const std::size_t large = build(8000);
+    result = result && (large < 6 * small);
+
+    check(result);
+}
+
+
+void testSimultaneousSubstitute()
+{
+    std::cout << std::left << std::setw(40) <<  "Simultaneous Substitute: ";
+
+    using namespace Math;
+    using exd = Expression<double>;
+
+    exd var1("x - 2y + sin(z)");
+    std::map<std::string, exd> swap;
+    swap["x"] = exd("y");
+    swap["y"] = exd("x");
+    std::map<std::string, exd> values;
+    values["x"] = exd(1);
+    values["y"] = exd(2);
+    values["z"] = exd(0);
+    values["w"] = exd(7);
+
+    exd var2("exp(x * y)");
+    std::map<std::string, exd> chain;
+    chain["x"] = exd("x * ln(y)");
+    chain["y"] = exd(1);
+
+    bool result = (var1.substitute(swap).toString() == "y - 2 * x + sin(z)")
+        && (var1.substitute(values).toString() == "-3")
+        && (var1.substitute(std::map<std::string, exd>{}).toString() == "x - 2 * y + sin(z)")
+        && (var2.substitute(chain).toString() == "y^x");
+
+    check(result);
+}
+
+
+void testGradient()
+{
+    std::cout << std::left << std::setw(40) <<  "Gradient: ";
+
+    using namespace Math;
+    using exd = Expression<double>;
+
+    exd var1("x^2 * y + sin(y * z) - exp(x * z)");
+    auto gradient = var1.gradient({"x", "y", "z", "w"});
+    auto evaluator = var1.compileGradient({"x", "y", "z", "w"});
+
+    double x = 0.3, y = -1.2, z = 2.5;
+    auto values = evaluator.calculate({"z", "y", "x", "w"}, {z, y, x, 10});
+
+    bool result = (gradient.size() == 4)
+        && (gradient[0].toString() == var1.differentiate("x").toString())
+        && (gradient[1].toString() == var1.differentiate("y").toString())
+        && (gradient[2].toString() == var1.differentiate("z").toString())
+        && (gradient[3].toString() == "0")
+        && (values.size() == 5)
+        && (std::abs(values[0] - var1.calculate({"x", "y", "z"}, {x, y, z})) < 1e-12)
+        && (std::abs(values[1] - (2 * x * y - z * std::exp(x * z))) < 1e-12)
+        && (std::abs(values[2] - (x * x + z * std::cos(y * z))) < 1e-12)
+        && (std::abs(values[3] - (y * std::cos(y * z) - x * std::exp(x * z))) < 1e-12)
+        && (values[4] == 0);
+
+    // A constant exponent is differentiated without dividing by the base
+    for(const char* text : {"x^2", "x^3", "(x - y)^2 * y^y"})
+    {
+        auto atZero = exd(text).compileGradient({"x"}).calculate({"x", "y"}, {0, 0});
+        result = result && (atZero.size() == 2) && (atZero[1] == 0);
+    }
+
+    check(result);
+}
+
+
+void testAdjoint()
+{
+    std::cout << std::left << std::setw(40) <<  "Reverse Mode: ";
+
+    using namespace Math;
+    using namespace std::complex_literals;
+    using exd = Expression<double>;
+    using exc = Expression<std::complex<double>>;
+
+    exd var1("sin(x * y) / (1 + z^2) - ln(x) * exp(y) + x^y + (x - z) * cos(z)");
+    exc var2("exp(i * w) * ln(v) - v^2 / sin(w)");
+    auto adjoint1 = var1.adjoint();
+    auto adjoint2 = var2.adjoint();
+    auto gradient1 = var1.compileGradient({"x", "y", "z"});
+    auto gradient2 = var2.compileGradient({"v", "w"});
+
+    bool result = true;
+    for(int i = 1; i < 6; i++)
+    {
+        double x = 0.3 * i, y = 1.1 - 0.2 * i, z = 0.7 * i - 2;
+        auto reverse = adjoint1.calculate({"x", "y", "z", "t"}, {x, y, z, 1});
+        auto symbolic = gradient1.calculate({"x", "y", "z"}, {x, y, z});
+        result = result && (reverse.size() == 5) && (reverse[4] == 0);
+        for(int j = 0; j < 4; j++)
+        {
+            result = result && (std::abs(reverse[j] - symbolic[j]) < 1e-12);
+        }
+
+        std::complex<double> v = 0.5 * i + 1i, w = 0.25 - 0.1i * double(i);
+        auto complexReverse = adjoint2.calculate({"v", "w"}, {v, w});
+        auto complexSymbolic = gradient2.calculate({"v", "w"}, {v, w});
+        for(int j = 0; j < 3; j++)
+        {
+            result = result && (std::abs(complexReverse[j] - complexSymbolic[j]) < 1e-12);
+        }
+    }
+
+    check(result);
+}
+
+
+void testTaylor()
+{
+    std::cout << std::left << std::setw(40) <<  "Taylor Mode: ";
+
+    using namespace Math;
+    using exd = Expression<double>;
+
+    exd var1("exp(sin(x)) / (1 + x^2) + x^3 * ln(x) + (x * y)^y - cos(x * y)");
+    exd var2("x^3 - 2 * x^2");
+    auto taylor1 = var1.taylor();
+    auto taylor2 = var2.taylor();
+    auto compiled = var1.compileGradient({"x", "y"});
+
+    bool result = true;
+    for(int i = 1; i < 6; i++)
+    {
+        double x = 0.3 * i, y = 1.5 - 0.1 * i;
+        auto series = taylor1.calculate("x", 3, {"x", "y"}, {x, y});
+        result = result && (series.size() == 4);
+        for(int k = 0; k < 4; k++)
+        {
+            double expected = k == 0 ? var1.calculate({"x", "y"}, {x, y}) : var1.differentiate("x", k).calculate({"x", "y"}, {x, y});
+            result = result && (std::abs(series[k] - expected) < 1e-9 * (1 + std::abs(expected)));
+        }
+
+        auto dual = compiled.forward<Dual<double>>({Dual<double>(x), Dual<double>(y, 1)});
+        auto partial = compiled.calculate({"x", "y"}, {x, y});
+        result = result && (std::abs(dual[compiled.getOutputs()[0]].value - partial[0]) < 1e-12);
+        result = result && (std::abs(dual[compiled.getOutputs()[0]].derivative - partial[2]) < 1e-12);
+    }
+
+    result = result && (taylor2.calculate("x", 4, {"x"}, {0}) == std::vector<double>{0, 0, -4, 6, 0});
+    result = result && (taylor2.calculate("y", 2, {"x"}, {2}) == std::vector<double>{0, 0, 0});
+
+    // x^2.5 at 0 has two zero derivatives, the third is infinite
+    exd var3("x^2.5 + (x^2)^0.75");
+    auto taylor3 = var3.taylor();
+    result = result && (taylor3.calculate("x", 0, {"x"}, {0}) == std::vector<double>{var3.calculate({"x"}, {0})});
+    result = result && (taylor3.calculate("x", 1, {"x"}, {0}) == std::vector<double>{0, 0});
+    try
+    {
+        taylor3.calculate("x", 2, {"x"}, {0});
+        result = false;
+    }
+    catch(const std::invalid_argument&) {}
+    result = result && (exd("x^2.5").taylor().calculate("x", 2, {"x"}, {0}) == std::vector<double>{0, 0, 0});
+
+    check(result);
+}
+
+
+void testSystem()
+{
+    std::cout << std::left << std::setw(40) <<  "Sparse System: ";
+
+    using namespace Math;
+    using exd = Expression<double>;
+    using System = Math::System<double>;
+
+    // Tridiagonal: f_i = x_(i-1) * x_i - sin(x_(i+1)) + x_i^2 / (1 + x_(i+1))
+    const int n = 12;
+    std::vector<std::string> variables;
+    for(int i = 0; i < n; i++)
+    {
+        variables.push_back("x" + std::to_string(i));
+    }
+    std::vector<exd> expressions(n);
+    for(int i = 0; i < n; i++)
+    {
+        std::string previous = i > 0 ? variables[i - 1] : "1";
+        std::string next = i + 1 < n ? variables[i + 1] : "2";
+        expressions[i] = exd(previous + " * " + variables[i] + " - sin(" + next + ") + " + variables[i] + "^2 / (1 + " + next + ")");
+    }
+    System system(expressions, variables);
+
+    std::vector<double> value;
+    for(int i = 0; i < n; i++)
+    {
+        value.push_back(0.1 * i + 0.3);
+    }
+    std::vector<double> weight(n, 1.0);
+    weight[3] = -2.5;
+
+    auto forward = system.jacobian(value, System::Mode::Forward);
+    auto reverse = system.jacobian(value, System::Mode::Reverse);
+    auto hessian = system.hessian(value, weight);
+
+    bool result = (system.getColors(System::Mode::Forward) == 3) && (system.getColors(System::Mode::Reverse) == 3);
+    result = result && (forward.row.size() == 3 * n - 2) && (forward.row == reverse.row) && (forward.column == reverse.column);
+    for(std::size_t e = 0; e < forward.row.size(); e++)
+    {
+        double expected = expressions[forward.row[e]].differentiate(variables[forward.column[e]]).calculate(variables, value);
+        result = result && (std::abs(forward.value[e] - expected) < 1e-12) && (std::abs(reverse.value[e] - expected) < 1e-12);
+    }
+
+    exd lagrangian(0.0);
+    for(int i = 0; i < n; i++)
+    {
+        lagrangian = lagrangian + exd(weight[i]) * expressions[i];
+    }
+    result = result && (system.getHessianColors() <= 3) && (hessian.row.size() == 2 * n - 1);
+    for(std::size_t e = 0; e < hessian.row.size(); e++)
+    {
+        double expected = lagrangian.differentiate(variables[hessian.row[e]]).differentiate(variables[hessian.column[e]]).calculate(variables, value);
+        result = result && (hessian.row[e] >= hessian.column[e]) && (std::abs(hessian.value[e] - expected) < 1e-10);
+    }
+
+    std::vector<exd> dependent(1);
+    dependent[0] = exd("x * p");
+    try
+    {
+        System failing(dependent, {"x"});
+        result = false;
+    }
+    catch(const std::invalid_argument&) {}
+    try
+    {
+        system.hessian(value, std::vector<double>(n - 1, 1.0));
+        result = false;
+    }
+    catch(const std::invalid_argument&) {}
+
+    check(result);
+}
+
+
+void testCompile()
+{
+    std::cout << std::left << std::setw(40) <<  "Common Subexpressions: ";
+
+    using namespace Math;
+    using exd = Expression<double>;
+
+    std::vector<exd> expressions(4);
+    expressions[0] = exd("sin(x * y) + exp(2 * y)");
+    expressions[1] = exd("y * x - exp(2 * y) * sin(y * x)");
+    expressions[2] = exd("sin(y * x)^2 / (1 + exp(2 * y))");
+    expressions[3] = exd("x");
+    auto evaluator = exd::compile(expressions);
+
+    // x, y, x * y, sin, 2, 2 * y, exp, +, *, -, ^, 1, +, /
+    bool result = (evaluator.size() == 14) && (evaluator.getOutputs().size() == 4);
+
+    std::vector<std::vector<double>> batch(2);
+    for(int i = 0; i < 150; i++)
+    {
+        batch[0].push_back(0.01 * i - 0.5);
+        batch[1].push_back(0.3 - 0.02 * i);
+    }
+    auto values = evaluator.calculateBatch({batch[evaluator.getVariables()[0] == "y"], batch[evaluator.getVariables()[0] == "x"]});
+    for(int i = 0; i < 150; i++)
+    {
+        auto scalar = evaluator.calculate({"x", "y"}, {batch[0][i], batch[1][i]});
+        for(int j = 0; j < 4; j++)
+        {
+            double expected = expressions[j].calculate({"x", "y"}, {batch[0][i], batch[1][i]});
+            result = result && (std::abs(scalar[j] - expected) < 1e-12) && (values[j][i] == scalar[j]);
+        }
+    }
+
+    check(result);
+}
+
+
+void testIncremental()
+{
+    std::cout << std::left << std::setw(40) <<  "Incremental: ";
+
+    using namespace Math;
+    using exd = Expression<double>;
+
+    // x, y, z, 2, x * y, sin, z^2, exp, +
+    exd var("sin(x * y) + exp(z^2)");
+    auto incremental = var.incremental();
+
+    bool result = true;
+    try
+    {
+        incremental.calculate();
+        result = false;
+    }
+    catch(const std::invalid_argument&) {}
+
+    incremental.set({"x", "y", "z"}, {0.5, 1.5, -0.25});
+    result = result && (incremental.calculate() == var.calculate({"x", "y", "z"}, {0.5, 1.5, -0.25}));
+    result = result && (incremental.getRecomputed() == 9);
+
+    incremental.set("z", 0.75);
+    result = result && (incremental.calculate() == var.calculate({"x", "y", "z"}, {0.5, 1.5, 0.75}));
+    result = result && (incremental.getRecomputed() == 4);
+
+    incremental.set("x", 0.5);
+    incremental.calculate();
+    result = result && (incremental.getRecomputed() == 0);
+
+    incremental.set("x", -1);
+    incremental.set("y", 2);
+    result = result && (incremental.calculate() == var.calculate({"x", "y", "z"}, {-1, 2, 0.75}));
+    result = result && (incremental.getRecomputed() == 5) && (incremental.getTotalRecomputed() == 18);
+
+    check(result);
+}
+
+
+void testSpecialize()
+{
+    std::cout << std::left << std::setw(40) <<  "Specialize: ";
+
+    using namespace Math;
+    using exd = Expression<double>;
+
+    exd var("a * x^2 + exp(b * a) * y - ln(c) / (b - 2) + x * y");
+    std::map<std::string, double> bindings {{"a", 1.0}, {"b", 0.0}, {"c", 1.0}};
+
+    bool result = (var.specialize(bindings).toString() == "x^2 + y + x * y");
+    result = result && (var.specialize({{"x", 1.0}, {"y", 0.0}}).toString() == "a - ln(c) / (b - 2)");
+    result = result && (var.specialize({{"b", 2.0}, {"c", 1.0}}).toString() == "a * x^2 + exp(2 * a) * y - 0 / 0 + x * y");
+
+    auto evaluator = var.compileSpecialized({{"a", 1.5}, {"b", 3.0}});
+    result = result && (evaluator.getVariables().size() == 3);
+    for(int i = 1; i < 6; i++)
+    {
+        double x = 0.4 * i, y = 1 - 0.3 * i, c = 0.5 * i;
+        double expected = var.calculate({"x", "y", "c", "a", "b"}, {x, y, c, 1.5, 3.0});
+        result = result && (std::abs(evaluator.calculate({"x", "y", "c"}, {x, y, c})[0] - expected) < 1e-12);
+    }
+
+    check(result);
+}
+
+
+void testHorner()
+{
+    std::cout << std::left << std::setw(40) <<  "Horner Form: ";
+
+    using namespace Math;
+    using exd = Expression<double>;
+
+    std::vector<exd> expressions(3);
+    expressions[0] = exd("3 * x^4 - 2 * x^2 + x - 7");
+    expressions[1] = exd("sin(y) * (x^3 + 2 * x) - (x^10 + 1)");
+    expressions[2] = exd("(y - 1) * 4 + 2 * (-y)^3");
+    auto evaluator = exd::compile(expressions);
+
+    bool result = true;
+    for(const auto& instruction : evaluator.getProgram())
+    {
+        result = result && (instruction.type != TypeNode::Power);
+    }
+
+    std::vector<std::vector<double>> batch(2);
+    for(int i = 0; i < 100; i++)
+    {
+        batch[evaluator.getVariables()[0] == "y"].push_back(0.03 * i - 1.5);
+        batch[evaluator.getVariables()[0] == "x"].push_back(1 - 0.025 * i);
+    }
+    auto values = evaluator.calculateBatch(batch);
+    for(int i = 0; i < 100; i++)
+    {
+        double x = 0.03 * i - 1.5, y = 1 - 0.025 * i;
+        auto scalar = evaluator.calculate({"x", "y"}, {x, y});
+        for(int j = 0; j < 3; j++)
+        {
+            double expected = expressions[j].calculate({"x", "y"}, {x, y});
+            result = result && (std::abs(scalar[j] - expected) < 1e-12 * (1 + std::abs(expected))) && (values[j][i] == scalar[j]);
+        }
+    }
+
+    check(result);
+}
+
+
+void testStrengthReduction()
+{
+    std::cout << std::left << std::setw(40) <<  "Strength Reduction: ";
+
+    using namespace Math;
+    using exd = Expression<double>;
+    using exc = Expression<std::complex<double>>;
+
+    std::vector<exd> expressions(2);
+    expressions[0] = exd("sin(x)^2 + y^5 + x / 4 + exp(x) * exp(y) - (3 * sin(x) + sin(x) * y)");
+    expressions[1] = exd("x^0.5 / y");
+    auto evaluator = exd::compile(expressions);
+
+    std::vector<exc> complexExpressions(1);
+    complexExpressions[0] = exc("z^3 / 2 + z^(1 / 2)");
+    auto complexEvaluator = exc::compile(complexExpressions);
+
+    int powers = 0, divisions = 0, exponents = 0, sines = 0;
+    for(const auto& instruction : evaluator.getProgram())
+    {
+        powers += instruction.type == TypeNode::Power;
+        divisions += instruction.type == TypeNode::Division;
+        exponents += instruction.type == TypeNode::Exp;
+        sines += instruction.type == TypeNode::Sin;
+    }
+    bool result = (powers == 1) && (divisions == 1) && (exponents == 1) && (sines == 1);
+
+    for(int i = 1; i < 6; i++)
+    {
+        double x = 0.4 * i, y = 1.2 - 0.1 * i;
+        auto values = evaluator.calculate({"x", "y"}, {x, y});
+        for(int j = 0; j < 2; j++)
+        {
+            double expected = expressions[j].calculate({"x", "y"}, {x, y});
+            result = result && (std::abs(values[j] - expected) < 1e-12 * (1 + std::abs(expected)));
+        }
+
+        std::complex<double> z(0.3 * i, 1 - 0.2 * i);
+        auto expected = complexExpressions[0].calculate({"z"}, {z});
+        result = result && (std::abs(complexEvaluator.calculate({"z"}, {z})[0] - expected) < 1e-12 * (1 + std::abs(expected)));
+    }
+
+    // exp(x) has another user, merging it would add an exponential instead of removing one
+    std::vector<exd> shared {exd("exp(x) * exp(y) + exp(x)"), exd("x^(-2)")};
+    auto sharedEvaluator = exd::compile(shared);
+    int additions = 0;
+    for(const auto& instruction : sharedEvaluator.getProgram())
+    {
+        additions += instruction.type == TypeNode::Addition;
+    }
+    result = result && (additions == 1);
+
+    // 0^-2 is infinite as in calculate, not a division by zero
+    auto atZero = sharedEvaluator.calculate({"x", "y"}, {0.0, 1.0});
+    result = result && std::isinf(atZero[1]) && std::isinf(shared[1].calculate({"x"}, {0.0}));
+
+    check(result);
+}
+
+
+void testSinCos()
+{
+    std::cout << std::left << std::setw(40) <<  "Fused Sin and Cos: ";
+
+    using namespace Math;
+    using exd = Expression<double>;
+    using exc = Expression<std::complex<double>>;
+
+    // Both results within an ulp of the exact value, also next to multiples of pi/2 where the reduction cancels
+    auto close = [](double value, double expected) {
+        return std::abs(value - expected) <= 2 * (std::nextafter(std::abs(expected), INFINITY) - std::abs(expected));
+    };
+    std::vector<double> arguments {0.0, -0.0, 1e-300, 0.5, -0.785398, 1.5707963267948966, 3.14159, -100.25, 12345.678,
+        99999.0, 1e7, -3e12, 46066.743875913933, 51471.85403457865, -98960.169085698947};
+    for(int k = 1; k < 2000; k++)
+    {
+        arguments.push_back(k * 50.265482457436690 - 0.0137 * k);
+        arguments.push_back(static_cast<double>(k * 31) * 1.5707963267948966);
+    }
+    std::vector<double> sines(arguments.size()), cosines(arguments.size());
+    sincos(arguments.data(), sines.data(), cosines.data(), arguments.size());
+    bool result = true;
+    for(std::size_t k = 0; k < arguments.size(); k++)
+    {
+        double s, c;
+        sincos(arguments[k], s, c);
+        result = result && close(s, std::sin(arguments[k])) && close(c, std::cos(arguments[k]));
+        result = result && (s == sines[k]) && (c == cosines[k]);
+    }
+
+    std::vector<exd> expressions(2);
+    expressions[0] = exd("sin(x * y) * cos(x * y) + cos(x)");
+    expressions[1] = exd("sin(x) - sin(y) / cos(y)");
+    auto evaluator = exd::compile(expressions);
+    int fused = 0;
+    for(const auto& instruction : evaluator.getProgram())
+    {
+        fused += (instruction.type == TypeNode::Sin || instruction.type == TypeNode::Cos) && instruction.right != 0;
+    }
+    result = result && (fused == 6);
+
+    std::vector<std::vector<double>> batch(2);
+    for(int i = 0; i < 100; i++)
+    {
+        batch[0].push_back(0.37 * i - 20);
+        batch[1].push_back(1.5 - 0.011 * i);
+    }
+    auto values = evaluator.calculateBatch(batch);
+    for(int i = 0; i < 100; i++)
+    {
+        std::vector<double> point {batch[0][i], batch[1][i]};
+        auto scalar = evaluator.calculate(evaluator.getVariables(), point);
+        for(int j = 0; j < 2; j++)
+        {
+            double expected = expressions[j].calculate(evaluator.getVariables(), point);
+            result = result && (std::abs(scalar[j] - expected) < 1e-12 * (1 + std::abs(expected))) && (values[j][i] == scalar[j]);
+        }
+    }
+
+    std::vector<exc> complexExpressions(1);
+    complexExpressions[0] = exc("sin(z)^2 + cos(z)^2 + sin(z) * cos(z)");
+    auto complexEvaluator = exc::compile(complexExpressions);
+    for(int i = 0; i < 5; i++)
+    {
+        std::complex<double> z(0.8 * i - 1, 0.3 * i);
+        auto expected = complexExpressions[0].calculate({"z"}, {z});
+        result = result && (std::abs(complexEvaluator.calculate({"z"}, {z})[0] - expected) < 1e-12 * (1 + std::abs(expected)));
+    }
+
+    check(result);
+}
+
+
+void testRealPath()
+{
+    std::cout << std::left << std::setw(40) <<  "Real Fast Path: ";
+
+    using namespace Math;
+    using namespace std::complex_literals;
+    using exc = Expression<std::complex<double>>;
+
+    std::vector<exc> expressions(2);
+    expressions[0] = exc("x^3 * exp(y) + sin(x * y) * cos(x * y) / (1 + y^2) + z * ln(x) - x^0.5");
+    expressions[1] = exc("(x - y) * (x + y) * i + cos(y)");
+    auto evaluator = exc::compile(expressions);
+    evaluator.setReal({"x", "y"});
+
+    // Everything but z, ln(x), z * ln(x), x^0.5, i, the product with i and the sums containing them
+    bool result = (evaluator.countReal() > 0) && (evaluator.countReal() + 9 == evaluator.size());
+    for(int k = 0; k < 10; k++)
+    {
+        std::vector<std::complex<double>> point {-1.5 + 0.4 * k, 0.7 - 0.1 * k, 2.0 - 1i * double(k)};
+        if(k >= 8)
+        {
+            point[0] += 0.5i;
+        }
+        auto values = evaluator.calculate({"x", "y", "z"}, point);
+        for(int j = 0; j < 2; j++)
+        {
+            auto expected = expressions[j].calculate({"x", "y", "z"}, point);
+            result = result && (std::abs(values[j] - expected) < 1e-12 * (1 + std::abs(expected)));
+        }
+    }
+
+    check(result);
+}
+
+
+void testSplitBatch()
+{
+    std::cout << std::left << std::setw(40) <<  "Split Complex Batch: ";
+
+    using namespace Math;
+    using namespace std::complex_literals;
+    using exc = Expression<std::complex<double>>;
+
+    std::vector<exc> expressions(2);
+    expressions[0] = exc("x * y / (x - y) + exp(x) * sin(y) - cos(x * y)");
+    expressions[1] = exc("ln(x) + sin(x) * cos(x) - x^y");
+    auto evaluator = exc::compile(expressions);
+
+    std::vector<std::vector<std::complex<double>>> batch(2, std::vector<std::complex<double>>(150));
+    for(int k = 0; k < 150; k++)
+    {
+        batch[0][k] = (0.3 + 0.02 * k) + 1i * (0.5 - 0.01 * k);
+        batch[1][k] = (-1.1 + 0.015 * k) - 1i * (0.2 + 0.003 * k);
+    }
+    std::vector<SplitComplex<double>> split {toSplit(batch[0]), toSplit(batch[1])};
+    if(evaluator.getVariables()[0] != "x")
+    {
+        std::swap(split[0], split[1]);
+    }
+
+    auto values = evaluator.calculateSplit(split);
+    bool result = (values.size() == 2);
+    for(int j = 0; j < 2; j++)
+    {
+        auto points = fromSplit(values[j]);
+        for(int k = 0; k < 150; k++)
+        {
+            auto expected = expressions[j].calculate({"x", "y"}, {batch[0][k], batch[1][k]});
+            result = result && (std::abs(points[k] - expected) < 1e-12 * (1 + std::abs(expected)));
+        }
+    }
+
+    check(result);
+}
+
+
+void testMoveBuild()
+{
+    std::cout << std::left << std::setw(40) <<  "Move Build: ";
+
+    using namespace Math;
+    using exd = Expression<double>;
+
+    const exd x("x");
+    exd copy(x);
+    exd sum(0.0);
+    exd product(1.0);
+    for(int k = 1; k <= 10000; k++)
+    {
+        sum += exd(double(k)) * x;
+        product = std::move(product) * (exd(1.0) + x / exd(double(k)));
+    }
+    exd composed = sin(std::move(copy)) + exp(x) - ln(exd("y"));
+
+    bool result = (x.toString() == "x");
+    result = result && (std::abs(sum.calculate({"x"}, {2.0}) - 2.0 * 50005000.0) < 1e-6);
+    result = result && (std::abs(product.calculate({"x"}, {0.0}) - 1.0) < 1e-12);
+    result = result && (std::abs(composed.calculate({"x", "y"}, {0.5, 2.0}) - (std::sin(0.5) + std::exp(0.5) - std::log(2.0))) < 1e-12);
+
+    // The parser moves the left operand too, parsing a long sum allocates linearly
+    auto parse = [](int terms) {
+        std::string text = "x";
+        for(int i = 1; i < terms; i++)
+        {
+            text += " + x * x";
+        }
+        const std::size_t before = allocated;
+        auto node = Parser<double>(text).parseExpression();
+        return allocated - before;
+    };
+    const std::size_t small = parse(2000);
+    const std::size_t large = parse(8000);
+    result = result && (large < 6 * small);
+
+    check(result);
+}
+
+
+void testBalancedBuild()
+{
+    std::cout << std::left << std::setw(40) <<  "Balanced Sum and Product: ";
+
+    using namespace Math;
+    using exd = Expression<double>;
+
+    const exd x("x");
+    std::vector<exd> terms;
+    std::vector<exd> factors;
+    for(int k = 1; k <= 100000; k++)
+    {
+        terms.push_back(exd(double(k)) * x);
+        factors.push_back(exd(1.0) + x / exd(double(k)));
+    }
+
+    exd total = sum(terms.begin(), terms.end());
+    exd moved = sum(std::make_move_iterator(terms.begin()), std::make_move_iterator(terms.end()));
+    exd all = product(std::move(factors));
+    std::vector<exd> three(3);
+    three[0] = exd("a");
+    three[1] = exd("b");
+    three[2] = exd("c");
+
+    bool result = (std::abs(total.calculate({"x"}, {2.0}) - 2.0 * 5000050000.0) < 1e-3);
+    result = result && (std::abs(moved.calculate({"x"}, {1.0}) - 5000050000.0) < 1e-3);
+    result = result && (std::abs(all.calculate({"x"}, {0.0}) - 1.0) < 1e-12);
+    result = result && (sum(three).toString() == "a + b + c");
+    result = result && (product(three.begin(), three.end()).toString() == "a * b * c");
+    result = result && (sum(std::vector<exd>()).toString() == "0") && (product(std::vector<exd>()).toString() == "1");
+
+    check(result);
+}
+
+
+void testDeepTree()
+{
+    std::cout << std::left << std::setw(40) <<  "Deep Tree: ";
+
+    using namespace Math;
+    using exd = Expression<double>;
+
+    const int depth = 1000000;
+    const exd x("x");
+    exd chain(0.0);
+    double slope = 0;
+    for(int k = 1; k <= depth; k++)
+    {
+        chain += exd(double(k % 7)) * x;
+        slope += k % 7;
+    }
+
+    exd copy(chain);
+    exd substituted = chain.substitute("x", exd("y"));
+    exd simplified = chain.simplify();
+    exd derivative = chain.differentiate("x");
+
+    bool result = (chain.toString().size() > std::size_t(depth));
+    result = result && (std::abs(copy.calculate({"x"}, {2.0}) - 2.0 * slope) < 1e-6);
+    result = result && (std::abs(substituted.calculate({"y"}, {3.0}) - 3.0 * slope) < 1e-6);
+    result = result && (std::abs(simplified.calculate({"x"}, {0.5}) - 0.5 * slope) < 1e-6);
+    result = result && (std::abs(derivative.calculate({"x"}, {5.0}) - slope) < 1e-6);
+
+    // The parser keeps its nesting on the heap as well
+    std::string calls;
+    std::string powers = "x";
+    double sine = 0.5;
+    for(int k = 0; k < depth; k++)
+    {
+        calls += "sin((";
+        powers += "^x";
+        sine = std::sin(sine);
+    }
+    calls += "x" + std::string(2 * depth, ')');
+    exd nested(calls);
+    exd tower(powers);
+    result = result && (std::abs(nested.calculate({"x"}, {0.5}) - sine) < 1e-12);
+    result = result && (tower.calculate({"x"}, {1.0}) == 1.0);
+
+    check(result);
+}
+
+
+void testTape()
+{
+    std::cout << std::left << std::setw(40) <<  "Tape: ";
+
+    using namespace Math;
+    using exd = Expression<double>;
+    using exc = Expression<std::complex<double>>;
+
+    exd var("-(x - y) * sin(x)^2 / (y + ln(x)) - exp(-x) + 3");
+    auto tape = var.tape();
+
+    bool result = (sizeof(Tape<double>::Record) <= 16);
+    result = result && (tape.size() == 20) && (tape.getConstants().size() == 2);
+    result = result && (tape.getVariables() == std::vector<std::string>{"x", "y"});
+    result = result && (tape.toString() == var.toString());
+    result = result && (exd(tape).toString() == var.toString());
+    result = result && (tape.calculate({"y", "x"}, {0.5, 2.0}) == var.calculate({"y", "x"}, {0.5, 2.0}));
+
+    auto derivative = tape.differentiate("x");
+    result = result && (std::abs(derivative.calculate({"x", "y"}, {2.0, 0.5})
+        - var.differentiate("x").calculate({"x", "y"}, {2.0, 0.5})) < 1e-12);
+    result = result && (exd(derivative).toString() == derivative.toString());
+    result = result && (tape.differentiate("z").toString() == "0");
+    result = result && (exd("x * y").tape().differentiate("x").toString() == "y");
+
+    // A constant exponent keeps the derivative defined at a zero base
+    auto square = exd("x^2").tape().differentiate("x");
+    result = result && (square.toString() == "2 * x^1") && (square.calculate({"x"}, {0.0}) == 0.0);
+    result = result && (exd("x^y").tape().differentiate("x").calculate({"x", "y"}, {0.0, 3.0}) == 0.0);
+
+    try
+    {
+        tape.calculate({"x"}, {1.0});
+        result = false;
+    }
+    catch(const std::invalid_argument&) {}
+
+    exc complex("(1 + 2i) * x - i");
+    result = result && (complex.tape().toString() == complex.toString());
+
+    // The operand of a leaf indexes the constants or the variables, which may outnumber the records
+    Tape<double> leaves({{TypeNode::Variable, 5, 0}, {TypeNode::Number, 7, 0}, {TypeNode::Multiplication, 0, 1}},
+        {0, 1, 2, 3, 4, 5, 6, 7, 8, 9}, {"a", "b", "c", "d", "e", "z"});
+    result = result && (leaves.calculate({"z"}, {5.0}) == 35.0) && (leaves.toString() == "z * 7");
+    result = result && (leaves.differentiate("z").calculate({"z"}, {5.0}) == 7.0);
+
+    try
+    {
+        Tape<double>({{TypeNode::Variable, 0, 0}}, {}, {""});
+        result = false;
+    }
+    catch(const std::invalid_argument&) {}
+
+    check(result);
+}
+
+
+void testNodeDispatch()
+{
+    std::cout << std::left << std::setw(40) <<  "Node Dispatch: ";
+
+    using namespace Math;
+
+    std::unique_ptr<Node<double>> sum = std::make_unique<Addition<double>>(
+        std::make_unique<Variable<double>>("x"),
+        std::make_unique<Minus<double>>(std::make_unique<Number<double>>(2.0))
+    );
+    std::unique_ptr<Node<double>> copy = sum->makeCopy();
+
+    bool result = (sum->getType() == TypeNode::Addition) && (sum->getPriority() == Priority::Addition);
+    result = result && (nodeCast<Addition<double>>(sum.get()) != nullptr);
+    result = result && (nodeCast<Multiplication<double>>(sum.get()) == nullptr);
+    result = result && (sum->countChildren() == 2) && (sum->getChild(1)->countChildren() == 1);
+    result = result && (nodeCast<Minus<double>>(sum->getChild(1).get())->argument->getType() == TypeNode::Number);
+    result = result && sum->equal(copy) && !sum->equal(sum->getChild(0));
+    result = result && (sum->toString() == "x + (-2)");
+
+    try
+    {
+        sum->getChild(0)->getChild(0);
+        result = false;
+    }
+    catch(const std::invalid_argument&) {}
+
+    check(result);
+}
+
+
+void testConcurrentReads()
+{
+    std::cout << std::left << std::setw(40) <<  "Concurrent Reads: ";
+
+    using namespace Math;
+    using exd = Expression<double>;
+
+    const exd var("sin(x * y) + x^2 / (1 + y) - ln(x + 0)");
+    const std::string text = var.toString();
+    const double value = var.calculate({"x", "y"}, {1.5, 0.5});
+    const std::string derivative = var.differentiate("x").toString();
+    const std::string simplified = var.simplify().toString();
+
+    std::vector<std::thread> threads;
+    std::vector<int> passed(64, 0);
+    for(std::size_t t = 0; t < passed.size(); t++)
+    {
+        threads.emplace_back([&, t]() {
+            bool result = true;
+            for(int k = 0; k < 20; k++)
+            {
+                result = result && (var.toString() == text);
+                result = result && (var.calculate({"x", "y"}, {1.5, 0.5}) == value);
+                result = result && (var.differentiate("x").toString() == derivative);
+                result = result && (var.simplify().toString() == simplified);
+            }
+            passed[t] = result;
+        });
+    }
+    for(std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    bool result = (var.toString() == text) && (simplified != text);
+    for(const int ok : passed)
+    {
+        result = result && ok;
+    }
+
+    check(result);
+}
+
+
+void testSimplifyCache()
+{
+    std::cout << std::left << std::setw(40) <<  "Simplify Cache: ";
+
+    using namespace Math;
+    using exd = Expression<double>;
+
+    const exd var("sin(x * 1 + 0) * cos(y^1) + sin(x * 1 + 0) * cos(y^1) / (1 * exp(0 + z))");
+    const std::string expected = var.simplify().toString();
+
+    auto& cache = SimplifyCache<double>::global();
+    cache.clear();
+    cache.enable();
+
+    // The first miss of a subtree is only remembered, the second one stores it
+    bool result = (var.simplify().toString() == expected);
+    result = result && (cache.getStatistics().insertions == 0);
+    result = result && (var.simplify().toString() == expected);
+    auto first = cache.getStatistics();
+    result = result && (first.hits == 0) && (first.insertions > 0) && (first.entries == first.insertions);
+
+    // The whole tree is found at once
+    result = result && (var.simplify().toString() == expected);
+    auto second = cache.getStatistics();
+    result = result && (second.hits == first.hits + 1) && (second.misses == first.misses);
+    result = result && (second.hitRate() > first.hitRate());
+
+    // A common subtree of different expressions is simplified once
+    for(int k = 2; k < 22; k++)
+    {
+        exd term = exd("sin(x * 1 + 0) * cos(y^1) * exp(0 + z * 1)") + exd(double(k)) * exd("z");
+        result = result && (term.simplify().toString() == "sin(x) * cos(y) * exp(z) + " + std::to_string(k) + " * z");
+    }
+    auto third = cache.getStatistics();
+    result = result && (third.hits >= second.hits + 18);
+
+    cache.setCapacity(64);
+    auto fourth = cache.getStatistics();
+    result = result && (fourth.evictions > 0) && (fourth.nodes <= 64);
+
+    cache.disable();
+    cache.setCapacity(1 << 20);
+    cache.clear();
+    result = result && (cache.getStatistics().entries == 0) && (var.simplify().toString() == expected);
+
+    check(result);
+}
+
+
+void testDiskCache()
+{
+    std::cout << std::left << std::setw(40) <<  "Disk Cache: ";
+
+    using namespace Math;
+    using exd = Expression<double>;
+
+    const auto directory = std::filesystem::temp_directory_path() / "expression-disk-cache-test";
+    std::filesystem::remove_all(directory);
+
+    const exd var("x^3 * sin(y * x) + ln(x + 0) / y");
+    const std::string derivative = var.differentiate("x", 2).toString();
+    const std::string simplified = var.simplify().toString();
+
+    auto tape = var.tape();
+    bool result = (Tape<double>::deserialize(tape.serialize()).toString() == tape.toString());
+    try
+    {
+        Tape<double>::deserialize(tape.serialize().substr(0, 20));
+        result = false;
+    }
+    catch(const std::invalid_argument&) {}
+
+    // A corrupted name length is rejected before anything is allocated for it, the last name is one letter
+    std::string damaged = tape.serialize();
+    const std::uint32_t huge = 0xFFFFFFF0u;
+    std::memcpy(damaged.data() + damaged.size() - 1 - sizeof(huge), &huge, sizeof(huge));
+    try
+    {
+        Tape<double>::deserialize(damaged);
+        result = false;
+    }
+    catch(const std::invalid_argument&) {}
+
+    {
+        DiskCache<double> cache(directory);
+        result = result && (cache.differentiate(var, "x", 2).toString() == derivative);
+        result = result && (cache.simplify(var).toString() == simplified);
+        result = result && (cache.getHits() == 0) && (cache.getMisses() == 2);
+    }
+
+    // A new cache over the same directory, as after a restart
+    DiskCache<double> cache(directory);
+    result = result && (cache.differentiate(var, "x", 2).toString() == derivative);
+    result = result && (cache.simplify(var).toString() == simplified);
+    result = result && (cache.differentiate(var, "x", 1).toString() == var.differentiate("x").toString());
+    result = result && (cache.getHits() == 2) && (cache.getMisses() == 1);
+
+    // A damaged entry is recomputed and replaced
+    for(const auto& file : std::filesystem::directory_iterator(directory))
+    {
+        std::filesystem::resize_file(file.path(), std::filesystem::file_size(file.path()) - 3);
+    }
+    result = result && (cache.simplify(var).toString() == simplified) && (cache.getMisses() == 2);
+    result = result && (cache.simplify(var).toString() == simplified) && (cache.getHits() == 3);
+
+    // The same for the name length inside a cached tape
+    for(const auto& file : std::filesystem::directory_iterator(directory))
+    {
+        std::fstream stream(file.path(), std::ios::binary | std::ios::in | std::ios::out);
+        stream.seekp(static_cast<std::streamoff>(std::filesystem::file_size(file.path()) - 1 - sizeof(huge)));
+        stream.write(reinterpret_cast<const char*>(&huge), sizeof(huge));
+    }
+    result = result && (cache.simplify(var).toString() == simplified) && (cache.getMisses() == 3);
+
+    std::filesystem::remove_all(directory);
+
+    check(result);
+}
+
+
+void testConcurrentDag()
+{
+    std::cout << std::left << std::setw(40) <<  "Concurrent Dag: ";
+
+    using namespace Math;
+
+    const std::vector<std::string> sources {
+        "sin(x) * sin(x) + exp(sin(x))",
+        "x^2 / (1 + y) - ln(x * y)",
+        "exp(sin(x)) * (x^2 / (1 + y))",
+        "cos(x + 1) - 2.5 * sin(x)",
+    };
+
+    ConcurrentDag<double> dag(1 << 12);
+    std::vector<std::thread> threads;
+    std::vector<std::vector<std::uint32_t>> indices(16, std::vector<std::uint32_t>(sources.size()));
+    for(std::size_t t = 0; t < indices.size(); t++)
+    {
+        threads.emplace_back([&, t]() {
+            // Every thread adds all expressions, starting from a different one
+            for(std::size_t k = 0; k < sources.size(); k++)
+            {
+                const std::size_t i = (t + k) % sources.size();
+                indices[t][i] = dag.add(Parser<double>(sources[i]).parseExpression());
+            }
+        });
+    }
+    for(std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    bool result = true;
+    for(const auto& list : indices)
+    {
+        result = result && (list == indices[0]);
+    }
+    for(std::size_t k = 0; k < sources.size(); k++)
+    {
+        auto node = Parser<double>(sources[k]).parseExpression();
+        result = result && (dag.add(node) == indices[0][k]);
+        result = result && (dag.toNode(indices[0][k])->toString() == node->toString());
+    }
+
+    // Shared subtrees stay shared in the tape
+    result = result && (dag.toTape(indices[0][0]).size() == 5);
+    result = result && (dag.add(Parser<double>("y * x").parseExpression(), true) == dag.add(Parser<double>("x * y").parseExpression(), true));
+
+    try
+    {
+        ConcurrentDag<double> small(4);
+        small.add(Parser<double>("sin(x) + cos(x) * exp(x)").parseExpression());
+        result = false;
+    }
+    catch(const std::length_error&) {}
+
+    check(result);
+}
+
+
+void testParallelSimplify()
+{
+    std::cout << std::left << std::setw(40) <<  "Parallel Simplify: ";
+
+    using namespace Math;
+    using exd = Expression<double>;
+
+    // A balanced sum of terms the rules change, over a long chain
+    std::vector<exd> terms;
+    for(int k = 0; k < 256; k++)
+    {
+        const std::string n = std::to_string(k % 7);
+        terms.emplace_back("sin(x * 1 + " + n + ") * (y^1 + 0) - ln(1 * x) / (" + n + " + 2 * 3)");
+    }
+    exd var = sum(terms);
+    for(int k = 0; k < 200; k++)
+    {
+        var = var * exd("x^1") + exd(0);
+    }
+    const std::string expected = var.simplify().toString();
+
+    TaskPool pool(4);
+    bool result = (var.simplify(pool).toString() == expected);
+    auto node = Parser<double>(var.toString()).parseExpression();
+    for(const std::size_t threshold : {1, 8, 64, 100000})
+    {
+        result = result && (node->simplify(pool, threshold)->toString() == node->simplify()->toString());
+    }
+
+    // Several callers share the pool
+    std::vector<std::thread> threads;
+    std::vector<int> passed(4, 0);
+    for(std::size_t t = 0; t < passed.size(); t++)
+    {
+        threads.emplace_back([&, t]() { passed[t] = (var.simplify(pool).toString() == expected); });
+    }
+    for(std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    for(const int ok : passed)
+    {
+        result = result && ok;
+    }
+
+    try
+    {
+        pool.run({[]() {}, []() { throw std::invalid_argument("task"); }});
+        result = false;
+    }
+    catch(const std::invalid_argument&) {}
+
+    check(result);
+}
+
+
 int main()
 {
     testNumberConstructor();
@@ -488,4 +1701,29 @@ int main()
     testCalculate();
     testSimplify();
     testDifferentiate();
+    testDag();
+    testFreeVariables();
+    testSimultaneousSubstitute();
+    testGradient();
+    testAdjoint();
+    testTaylor();
+    testSystem();
+    testCompile();
+    testIncremental();
+    testSpecialize();
+    testHorner();
+    testStrengthReduction();
+    testSinCos();
+    testRealPath();
+    testSplitBatch();
+    testMoveBuild();
+    testBalancedBuild();
+    testDeepTree();
+    testTape();
+    testNodeDispatch();
+    testConcurrentReads();
+    testSimplifyCache();
+    testDiskCache();
+    testConcurrentDag();
+    testParallelSimplify();
 }